@@ -18,10 +18,12 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/AIState.cpp \
     src/AIStateMachine.cpp \
     src/Animation.cpp \
+    src/AnimationBlendTree.cpp \
     src/AnimationClip.cpp \
     src/AnimationController.cpp \
     src/AnimationTarget.cpp \
     src/AnimationValue.cpp \
+    src/AssetLoader.cpp \
     src/AudioBuffer.cpp \
     src/AudioController.cpp \
     src/AudioListener.cpp \
@@ -54,6 +56,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Image.cpp \
     src/Image.inl \
     src/ImageControl.cpp \
+    src/JobScheduler.cpp \
     src/Joint.cpp \
     src/JoystickControl.cpp \
     src/Label.cpp \
@@ -65,6 +68,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/MathUtil.cpp \
     src/MathUtil.inl \
     src/MathUtilNeon.inl \
+    src/MathUtilSSE.inl \
     src/Matrix.cpp \
     src/Matrix.inl \
     src/Mesh.cpp \
@@ -74,6 +78,8 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/MeshSkin.cpp \
     src/Model.cpp \
     src/Node.cpp \
+    src/NullGL.cpp \
+    src/OcclusionCuller.cpp \
     src/ParticleEmitter.cpp \
     src/Pass.cpp \
     src/PhysicsCharacter.cpp \
@@ -106,6 +112,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Ray.inl \
     src/Rectangle.cpp \
     src/Ref.cpp \
+    src/RenderQueue.cpp \
     src/RenderState.cpp \
     src/RenderTarget.cpp \
     src/Scene.cpp \
@@ -116,6 +123,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/ScriptController.inl \
     src/ScriptTarget.cpp \
     src/Slider.cpp \
+    src/SpatialIndex.cpp \
     src/Sprite.cpp \
     src/SpriteBatch.cpp \
     src/Technique.cpp \
@@ -124,6 +132,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Text.cpp \
     src/TextBox.cpp \
     src/Texture.cpp \
+    src/TextureAtlas.cpp \
     src/Theme.cpp \
     src/ThemeStyle.cpp \
     src/TileSet.cpp \
@@ -279,10 +288,12 @@ HEADERS += src/AbsoluteLayout.h \
     src/AIState.h \
     src/AIStateMachine.h \
     src/Animation.h \
+    src/AnimationBlendTree.h \
     src/AnimationClip.h \
     src/AnimationController.h \
     src/AnimationTarget.h \
     src/AnimationValue.h \
+    src/AssetLoader.h \
     src/AudioBuffer.h \
     src/AudioController.h \
     src/AudioListener.h \
@@ -314,6 +325,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/HeightField.h \
     src/Image.h \
     src/ImageControl.h \
+    src/JobScheduler.h \
     src/Joint.h \
     src/JoystickControl.h \
     src/Keyboard.h \
@@ -332,6 +344,8 @@ HEADERS += src/AbsoluteLayout.h \
     src/Model.h \
     src/Mouse.h \
     src/Node.h \
+    src/NullGL.h \
+    src/OcclusionCuller.h \
     src/ParticleEmitter.h \
     src/Pass.h \
     src/PhysicsCharacter.h \
@@ -356,6 +370,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/Ray.h \
     src/Rectangle.h \
     src/Ref.h \
+    src/RenderQueue.h \
     src/RenderState.h \
     src/RenderTarget.h \
     src/Scene.h \
@@ -365,6 +380,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/ScriptController.h \
     src/ScriptTarget.h \
     src/Slider.h \
+    src/SpatialIndex.h \
     src/Sprite.h \
     src/SpriteBatch.h \
     src/Stream.h \
@@ -374,6 +390,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/Text.h \
     src/TextBox.h \
     src/Texture.h \
+    src/TextureAtlas.h \
     src/Theme.h \
     src/ThemeStyle.h \
     src/TileSet.h \
@@ -528,6 +545,7 @@ INCLUDEPATH += $$PWD/../external-deps/include
 DEFINES += GP_USE_GAMEPAD
 
 linux: SOURCES += src/PlatformLinux.cpp
+linux: SOURCES += src/PlatformNull.cpp
 linux: SOURCES += src/gameplay-main-linux.cpp
 linux: QMAKE_CXXFLAGS += -lstdc++ -pthread -w
 linux: DEFINES += __linux__
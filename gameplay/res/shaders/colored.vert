@@ -20,6 +20,10 @@ attribute vec4 a_blendWeights;
 attribute vec4 a_blendIndices;
 #endif
 
+#if defined(INSTANCED)
+attribute mat4 a_instanceMatrix;
+#endif
+
 #if defined(LIGHTMAP)
 attribute vec2 a_texCoord1;
 #endif
@@ -1,24 +1,48 @@
+#if defined(INSTANCED)
+// Instances are transformed into the local space of the node by their instance matrix.
+vec3 getInstanceVector(vec3 v)
+{
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * v;
+}
+#endif
+
 vec4 getPosition()
 {
+    #if defined(INSTANCED)
+    return a_instanceMatrix * a_position;
+    #else
     return a_position;    
+    #endif
 }
 
 #if defined(LIGHTING)
 
 vec3 getNormal()
 {
+    #if defined(INSTANCED)
+    return getInstanceVector(a_normal);
+    #else
     return a_normal;
+    #endif
 }
 
 #if defined(BUMPED)
 vec3 getTangent()
 {
+    #if defined(INSTANCED)
+    return getInstanceVector(a_tangent);
+    #else
     return a_tangent;
+    #endif
 }
 
 vec3 getBinormal()
 {
+    #if defined(INSTANCED)
+    return getInstanceVector(a_binormal);
+    #else
     return a_binormal;
+    #endif
 }
 #endif
 
@@ -0,0 +1,391 @@
+#include "Base.h"
+#include "AnimationBlendTree.h"
+#include "AnimationClip.h"
+#include "Animation.h"
+#include "MeshSkin.h"
+#include "Joint.h"
+#include "MathUtil.h"
+
+namespace gameplay
+{
+
+AnimationBlendTree::AnimationBlendTree(const std::vector<Node*>& bones)
+    : _bones(bones), _root(0), _frame(0)
+{
+    size_t count = _bones.size();
+    _restPose.scales.resize(count);
+    _restPose.rotations.resize(count);
+    _restPose.translations.resize(count);
+    _identityRotations.resize(count, Quaternion::identity());
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node* bone = _bones[i];
+        GP_ASSERT(bone);
+        bone->addRef();
+        _restPose.scales[i] = bone->getScale();
+        _restPose.rotations[i] = bone->getRotation();
+        _restPose.translations[i] = bone->getTranslation();
+    }
+}
+
+AnimationBlendTree::~AnimationBlendTree()
+{
+    for (size_t i = 0, count = _nodes.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_nodes[i]->clip);
+        SAFE_DELETE(_nodes[i]);
+    }
+    for (size_t i = 0, count = _bones.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_bones[i]);
+    }
+}
+
+AnimationBlendTree* AnimationBlendTree::create(MeshSkin* skin)
+{
+    GP_ASSERT(skin);
+
+    std::vector<Node*> bones;
+    for (unsigned int i = 0, count = skin->getJointCount(); i < count; ++i)
+    {
+        bones.push_back(skin->getJoint(i));
+    }
+    return new AnimationBlendTree(bones);
+}
+
+AnimationBlendTree* AnimationBlendTree::create(Node* root)
+{
+    GP_ASSERT(root);
+
+    // Collect the root and its descendants, with parents before their children.
+    std::vector<Node*> bones;
+    bones.push_back(root);
+    for (size_t i = 0; i < bones.size(); ++i)
+    {
+        for (Node* child = bones[i]->getFirstChild(); child != NULL; child = child->getNextSibling())
+        {
+            bones.push_back(child);
+        }
+    }
+    return new AnimationBlendTree(bones);
+}
+
+unsigned int AnimationBlendTree::getBoneCount() const
+{
+    return (unsigned int)_bones.size();
+}
+
+Node* AnimationBlendTree::getBone(unsigned int index) const
+{
+    GP_ASSERT(index < _bones.size());
+    return _bones[index];
+}
+
+int AnimationBlendTree::getBoneIndex(Node* bone) const
+{
+    for (size_t i = 0, count = _bones.size(); i < count; ++i)
+    {
+        if (_bones[i] == bone)
+            return (int)i;
+    }
+    return -1;
+}
+
+unsigned int AnimationBlendTree::addClip(AnimationClip* clip, bool loop)
+{
+    BlendNode* node = createNode(CLIP, clip);
+    node->loop = loop;
+    return _root;
+}
+
+unsigned int AnimationBlendTree::addBlend(unsigned int from, unsigned int to, float weight)
+{
+    GP_ASSERT(from < _nodes.size() && to < _nodes.size());
+
+    BlendNode* node = createNode(BLEND, NULL);
+    node->inputs[0] = from;
+    node->inputs[1] = to;
+    node->weight = weight;
+    return _root;
+}
+
+unsigned int AnimationBlendTree::addAdditive(unsigned int base, AnimationClip* clip, float weight, bool loop)
+{
+    GP_ASSERT(base < _nodes.size());
+
+    BlendNode* node = createNode(ADDITIVE, clip);
+    node->inputs[0] = base;
+    node->weight = weight;
+    node->loop = loop;
+
+    // The first frame of the clip is the pose its difference is measured from.
+    node->reference = _restPose;
+    sampleClip(node, 0.0f, &node->reference);
+    return _root;
+}
+
+unsigned int AnimationBlendTree::getNodeCount() const
+{
+    return (unsigned int)_nodes.size();
+}
+
+AnimationBlendTree::NodeType AnimationBlendTree::getNodeType(unsigned int node) const
+{
+    GP_ASSERT(node < _nodes.size());
+    return _nodes[node]->type;
+}
+
+void AnimationBlendTree::setRoot(unsigned int node)
+{
+    GP_ASSERT(node < _nodes.size());
+    _root = node;
+}
+
+unsigned int AnimationBlendTree::getRoot() const
+{
+    return _root;
+}
+
+void AnimationBlendTree::setWeight(unsigned int node, float weight)
+{
+    GP_ASSERT(node < _nodes.size() && _nodes[node]->type != CLIP);
+    _nodes[node]->weight = weight;
+}
+
+float AnimationBlendTree::getWeight(unsigned int node) const
+{
+    GP_ASSERT(node < _nodes.size());
+    return _nodes[node]->weight;
+}
+
+void AnimationBlendTree::setTime(unsigned int node, float time)
+{
+    GP_ASSERT(node < _nodes.size() && _nodes[node]->clip);
+    _nodes[node]->time = time;
+}
+
+float AnimationBlendTree::getTime(unsigned int node) const
+{
+    GP_ASSERT(node < _nodes.size());
+    return _nodes[node]->time;
+}
+
+void AnimationBlendTree::setMask(unsigned int node, Node* branch, float weight)
+{
+    GP_ASSERT(branch);
+
+    std::vector<float> weights(_bones.size(), 0.0f);
+    for (size_t i = 0, count = _bones.size(); i < count; ++i)
+    {
+        for (Node* n = _bones[i]; n != NULL; n = n->getParent())
+        {
+            if (n == branch)
+            {
+                weights[i] = weight;
+                break;
+            }
+        }
+    }
+    setMask(node, weights.empty() ? NULL : &weights[0]);
+}
+
+void AnimationBlendTree::setMask(unsigned int node, const float* weights)
+{
+    GP_ASSERT(node < _nodes.size() && _nodes[node]->type != CLIP);
+
+    BlendNode* n = _nodes[node];
+    size_t count = _bones.size();
+    n->boneMask.assign(weights, weights + count);
+
+    // Vectors are blended per component, so they need one weight for each.
+    n->componentMask.resize(count * 3);
+    for (size_t i = 0; i < count; ++i)
+    {
+        n->componentMask[i * 3] = n->componentMask[i * 3 + 1] = n->componentMask[i * 3 + 2] = weights[i];
+    }
+}
+
+void AnimationBlendTree::clearMask(unsigned int node)
+{
+    GP_ASSERT(node < _nodes.size());
+    _nodes[node]->boneMask.clear();
+    _nodes[node]->componentMask.clear();
+}
+
+void AnimationBlendTree::update(float elapsedTime)
+{
+    if (_nodes.empty() || _bones.empty())
+        return;
+
+    for (size_t i = 0, count = _nodes.size(); i < count; ++i)
+    {
+        BlendNode* node = _nodes[i];
+        if (node->clip)
+            node->time += elapsedTime * node->clip->getSpeed();
+    }
+
+    ++_frame;
+    evaluate(_root);
+
+    // Set the final pose on the bones, notifying their listeners once when all of them have moved.
+    const Pose& pose = _nodes[_root]->pose;
+    Transform::suspendTransformChanged();
+    for (size_t i = 0, count = _bones.size(); i < count; ++i)
+    {
+        _bones[i]->set(pose.scales[i], pose.rotations[i], pose.translations[i]);
+    }
+    Transform::resumeTransformChanged();
+}
+
+AnimationBlendTree::BlendNode* AnimationBlendTree::createNode(NodeType type, AnimationClip* clip)
+{
+    BlendNode* node = new BlendNode();
+    node->type = type;
+    node->clip = clip;
+    node->loop = true;
+    node->time = 0.0f;
+    node->inputs[0] = node->inputs[1] = 0;
+    node->weight = 1.0f;
+    node->frame = 0;
+    node->layoutVersion = 0;
+    node->pose = _restPose;
+
+    if (clip)
+    {
+        GP_ASSERT(type != BLEND);
+        clip->addRef();
+        node->clipPose = _restPose;
+        clip->updateLayout();
+        mapChannels(node);
+    }
+
+    _nodes.push_back(node);
+    _root = (unsigned int)_nodes.size() - 1;
+    return node;
+}
+
+void AnimationBlendTree::mapChannels(BlendNode* node)
+{
+    AnimationClip* clip = node->clip;
+    GP_ASSERT(clip);
+
+    // Find the bone of each channel of the clip, in the order the clip evaluates them.
+    node->channelBones.assign(clip->_channelOrder.size(), -1);
+    for (size_t i = 0, count = clip->_channelOrder.size(); i < count; ++i)
+    {
+        AnimationTarget* target = clip->getPoseTarget((unsigned int)i);
+        for (size_t j = 0, boneCount = _bones.size(); j < boneCount; ++j)
+        {
+            if (static_cast<AnimationTarget*>(_bones[j]) == target)
+            {
+                node->channelBones[i] = (int)j;
+                break;
+            }
+        }
+    }
+    node->layoutVersion = clip->_layoutVersion;
+}
+
+void AnimationBlendTree::sampleClip(BlendNode* node, float time, Pose* pose)
+{
+    AnimationClip* clip = node->clip;
+    GP_ASSERT(clip);
+    if (_bones.empty())
+        return;
+
+    // Map the time of the node to the time within the clip, as the clip does when it is played.
+    float duration = (float)clip->getDuration();
+    float currentTime = 0.0f;
+    if (duration > 0.0f)
+    {
+        if (node->loop)
+        {
+            float period = duration + (float)clip->_loopBlendTime;
+            currentTime = fmodf(time, period);
+            if (currentTime < 0.0f)
+                currentTime += period;
+        }
+        else
+        {
+            currentTime = MATH_CLAMP(time, 0.0f, duration);
+        }
+    }
+    clip->evaluate(currentTime);
+
+    // The clip lays out its pose again when its channels change, so the bones of the channels are found again too.
+    if (node->layoutVersion != clip->_layoutVersion)
+        mapChannels(node);
+
+    // Bones without channels keep their rest pose.
+    std::copy(_restPose.scales.begin(), _restPose.scales.end(), pose->scales.begin());
+    std::copy(_restPose.rotations.begin(), _restPose.rotations.end(), pose->rotations.begin());
+    std::copy(_restPose.translations.begin(), _restPose.translations.end(), pose->translations.begin());
+    for (size_t i = 0, count = node->channelBones.size(); i < count; ++i)
+    {
+        int bone = node->channelBones[i];
+        if (bone >= 0)
+        {
+            Transform::applyAnimationValue(clip->_propertyIds[i], clip->_poseValues[i], 1.0f,
+                &pose->scales[bone], &pose->rotations[bone], &pose->translations[bone]);
+        }
+    }
+}
+
+void AnimationBlendTree::evaluate(unsigned int index)
+{
+    BlendNode* node = _nodes[index];
+    if (node->frame == _frame)
+        return;
+    node->frame = _frame;
+
+    unsigned int boneCount = (unsigned int)_bones.size();
+    const float* boneMask = node->boneMask.empty() ? NULL : &node->boneMask[0];
+    const float* componentMask = node->componentMask.empty() ? NULL : &node->componentMask[0];
+    Pose& pose = node->pose;
+    switch (node->type)
+    {
+    case CLIP:
+        sampleClip(node, node->time, &pose);
+        break;
+
+    case BLEND:
+        {
+            evaluate(node->inputs[0]);
+            evaluate(node->inputs[1]);
+            const Pose& from = _nodes[node->inputs[0]]->pose;
+            const Pose& to = _nodes[node->inputs[1]]->pose;
+            MathUtil::blendArrays(&from.scales[0].x, &to.scales[0].x, node->weight, componentMask, boneCount * 3, &pose.scales[0].x);
+            MathUtil::blendQuaternions(&from.rotations[0].x, &to.rotations[0].x, node->weight, boneMask, boneCount, &pose.rotations[0].x);
+            MathUtil::blendArrays(&from.translations[0].x, &to.translations[0].x, node->weight, componentMask, boneCount * 3, &pose.translations[0].x);
+        }
+        break;
+
+    case ADDITIVE:
+        {
+            evaluate(node->inputs[0]);
+            const Pose& base = _nodes[node->inputs[0]]->pose;
+            const Pose& reference = node->reference;
+            Pose& additive = node->clipPose;
+            sampleClip(node, node->time, &additive);
+
+            MathUtil::addArrayDifference(&base.scales[0].x, &reference.scales[0].x, &additive.scales[0].x, node->weight, componentMask, boneCount * 3, &pose.scales[0].x);
+            MathUtil::addArrayDifference(&base.translations[0].x, &reference.translations[0].x, &additive.translations[0].x, node->weight, componentMask, boneCount * 3, &pose.translations[0].x);
+
+            // Rotate the base by the weighted rotation of the clip away from its reference.
+            for (unsigned int i = 0; i < boneCount; ++i)
+            {
+                Quaternion inverse;
+                reference.rotations[i].conjugate(&inverse);
+                Quaternion::multiply(inverse, additive.rotations[i], &additive.rotations[i]);
+            }
+            MathUtil::blendQuaternions(&_identityRotations[0].x, &additive.rotations[0].x, node->weight, boneMask, boneCount, &additive.rotations[0].x);
+            for (unsigned int i = 0; i < boneCount; ++i)
+            {
+                Quaternion::multiply(base.rotations[i], additive.rotations[i], &pose.rotations[i]);
+            }
+        }
+        break;
+    }
+}
+
+}
@@ -0,0 +1,317 @@
+#ifndef ANIMATIONBLENDTREE_H_
+#define ANIMATIONBLENDTREE_H_
+
+#include "Ref.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+
+namespace gameplay
+{
+
+class AnimationClip;
+class MeshSkin;
+class Node;
+
+/**
+ * Defines a tree of blend nodes that combines several animation clips into one pose of a skeleton.
+ *
+ * The leaves of the tree sample animation clips into local space poses, which hold the scale,
+ * rotation and translation of every bone. Blend nodes interpolate two poses, with rotations
+ * blended along the shortest path and normalized, and additive nodes add the difference between
+ * a clip and its first frame to a pose. Blend and additive nodes may be limited to some bones with
+ * a bone mask, such as an upper body layer that only affects the bones of the spine and arms.
+ *
+ * The whole tree is evaluated once per update with SIMD blending where available, and the final
+ * pose is then set on each bone with a single call, instead of every clip blending into the bones
+ * in turn. Channels of the clips that do not target a bone of the tree are ignored.
+ *
+ * The clips of a tree are sampled by the tree at its own time and should not be played.
+ *
+ * @code
+ * AnimationBlendTree* tree = AnimationBlendTree::create(skin);
+ * unsigned int walk = tree->addClip(animation->getClip("walk"));
+ * unsigned int run = tree->addClip(animation->getClip("run"));
+ * unsigned int locomotion = tree->addBlend(walk, run, 0.5f);
+ * unsigned int wave = tree->addBlend(locomotion, tree->addClip(animation->getClip("wave")), 1.0f);
+ * tree->setMask(wave, shoulderJoint);
+ * tree->addAdditive(wave, animation->getClip("breathe"));
+ *
+ * // In Game::update
+ * tree->setWeight(locomotion, speed / runSpeed);
+ * tree->update(elapsedTime);
+ * @endcode
+ *
+ * @script{ignore}
+ */
+class AnimationBlendTree : public Ref
+{
+public:
+
+    /**
+     * The type of a node of the tree.
+     */
+    enum NodeType
+    {
+        CLIP,
+        BLEND,
+        ADDITIVE
+    };
+
+    /**
+     * Creates a blend tree for the joints of a mesh skin.
+     *
+     * @param skin The mesh skin whose joints are the bones of the tree.
+     *
+     * @return The new blend tree.
+     */
+    static AnimationBlendTree* create(MeshSkin* skin);
+
+    /**
+     * Creates a blend tree for a node and all of its descendants.
+     *
+     * @param root The root node of the bones of the tree.
+     *
+     * @return The new blend tree.
+     */
+    static AnimationBlendTree* create(Node* root);
+
+    /**
+     * Gets the number of bones in the tree.
+     *
+     * @return The bone count.
+     */
+    unsigned int getBoneCount() const;
+
+    /**
+     * Gets a bone of the tree.
+     *
+     * @param index The index of the bone.
+     *
+     * @return The bone.
+     */
+    Node* getBone(unsigned int index) const;
+
+    /**
+     * Gets the index of a bone in the tree.
+     *
+     * @param bone The bone to find.
+     *
+     * @return The index of the bone, or -1 if it is not in the tree.
+     */
+    int getBoneIndex(Node* bone) const;
+
+    /**
+     * Adds a node that samples an animation clip. The clip is played at its speed and between
+     * its start and end times, with its loop blend time when looping.
+     *
+     * @param clip The clip to sample.
+     * @param loop Whether the clip loops or holds its last frame.
+     *
+     * @return The index of the new node.
+     */
+    unsigned int addClip(AnimationClip* clip, bool loop = true);
+
+    /**
+     * Adds a node that blends the poses of two nodes.
+     *
+     * @param from The node whose pose is used at a weight of zero.
+     * @param to The node whose pose is used at a weight of one.
+     * @param weight The weight of the second pose.
+     *
+     * @return The index of the new node.
+     */
+    unsigned int addBlend(unsigned int from, unsigned int to, float weight = 0.5f);
+
+    /**
+     * Adds a node that adds an animation clip to the pose of a node. The difference between
+     * the clip and its first frame is added, so the first frame is its reference pose.
+     *
+     * @param base The node whose pose the clip is added to.
+     * @param clip The additive clip.
+     * @param weight The weight of the clip.
+     * @param loop Whether the clip loops or holds its last frame.
+     *
+     * @return The index of the new node.
+     */
+    unsigned int addAdditive(unsigned int base, AnimationClip* clip, float weight = 1.0f, bool loop = true);
+
+    /**
+     * Gets the number of nodes in the tree.
+     *
+     * @return The node count.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Gets the type of a node.
+     *
+     * @param node The index of the node.
+     *
+     * @return The type of the node.
+     */
+    NodeType getNodeType(unsigned int node) const;
+
+    /**
+     * Sets the node whose pose is set on the bones. By default this is the node added last.
+     *
+     * @param node The index of the node.
+     */
+    void setRoot(unsigned int node);
+
+    /**
+     * Gets the node whose pose is set on the bones.
+     *
+     * @return The index of the root node.
+     */
+    unsigned int getRoot() const;
+
+    /**
+     * Sets the weight of a blend or additive node.
+     *
+     * @param node The index of the node.
+     * @param weight The weight.
+     */
+    void setWeight(unsigned int node, float weight);
+
+    /**
+     * Gets the weight of a blend or additive node.
+     *
+     * @param node The index of the node.
+     *
+     * @return The weight.
+     */
+    float getWeight(unsigned int node) const;
+
+    /**
+     * Sets the time of the clip of a clip or additive node.
+     *
+     * @param node The index of the node.
+     * @param time The time in milliseconds from the start of the clip.
+     */
+    void setTime(unsigned int node, float time);
+
+    /**
+     * Gets the time of the clip of a clip or additive node.
+     *
+     * @param node The index of the node.
+     *
+     * @return The time in milliseconds from the start of the clip.
+     */
+    float getTime(unsigned int node) const;
+
+    /**
+     * Limits a blend or additive node to a branch of the skeleton. The weight of the node is
+     * scaled by the mask weight for the branch and by zero for the other bones.
+     *
+     * @param node The index of the node.
+     * @param branch The bone at the root of the branch.
+     * @param weight The mask weight of the bones of the branch.
+     */
+    void setMask(unsigned int node, Node* branch, float weight = 1.0f);
+
+    /**
+     * Sets the mask weight of every bone for a blend or additive node.
+     *
+     * @param node The index of the node.
+     * @param weights The mask weights, one per bone.
+     */
+    void setMask(unsigned int node, const float* weights);
+
+    /**
+     * Removes the mask of a blend or additive node.
+     *
+     * @param node The index of the node.
+     */
+    void clearMask(unsigned int node);
+
+    /**
+     * Advances the clips of the tree, evaluates the tree and sets the pose of the root node on the bones.
+     *
+     * @param elapsedTime The elapsed time in milliseconds.
+     */
+    void update(float elapsedTime);
+
+private:
+
+    /**
+     * The local space scale, rotation and translation of every bone.
+     */
+    struct Pose
+    {
+        std::vector<Vector3> scales;
+        std::vector<Quaternion> rotations;
+        std::vector<Vector3> translations;
+    };
+
+    /**
+     * A node of the tree and the pose it evaluates to.
+     */
+    struct BlendNode
+    {
+        NodeType type;
+        AnimationClip* clip;
+        std::vector<int> channelBones;
+        unsigned int layoutVersion;
+        bool loop;
+        float time;
+        unsigned int inputs[2];
+        float weight;
+        std::vector<float> boneMask;
+        std::vector<float> componentMask;
+        unsigned int frame;
+        Pose pose;
+        Pose clipPose;
+        Pose reference;
+    };
+
+    /**
+     * Constructor.
+     */
+    AnimationBlendTree(const std::vector<Node*>& bones);
+
+    /**
+     * Destructor.
+     */
+    ~AnimationBlendTree();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AnimationBlendTree(const AnimationBlendTree& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AnimationBlendTree& operator=(const AnimationBlendTree&);
+
+    /**
+     * Creates a node, which gets the rest pose of the bones.
+     */
+    BlendNode* createNode(NodeType type, AnimationClip* clip);
+
+    /**
+     * Finds the bone of each channel of the clip of a node, for the current layout of the clip.
+     */
+    void mapChannels(BlendNode* node);
+
+    /**
+     * Samples the clip of a node at its time into a pose, starting from the rest pose.
+     */
+    void sampleClip(BlendNode* node, float time, Pose* pose);
+
+    /**
+     * Evaluates the pose of a node and the nodes it depends on, once per update.
+     */
+    void evaluate(unsigned int index);
+
+    std::vector<Node*> _bones;
+    Pose _restPose;
+    std::vector<Quaternion> _identityRotations;
+    std::vector<BlendNode*> _nodes;
+    unsigned int _root;
+    unsigned int _frame;
+};
+
+}
+
+#endif
@@ -3,18 +3,47 @@
 #include "Animation.h"
 #include "AnimationTarget.h"
 #include "Game.h"
+#include "Node.h"
+#include "MathUtil.h"
 #include "Quaternion.h"
 #include "ScriptController.h"
 
 namespace gameplay
 {
 
+// The update count since the last evaluation, for clips that must be evaluated on their next update.
+#define LOD_FRAME_STALE 0xFFFFFFFF
+
+// The LOD phase of the next clip that is created.
+static unsigned int __lodPhase = 0;
+
 extern void splitURL(const std::string& url, std::string* file, std::string* id);
 
+/**
+ * Gets the offset of the rotation quaternion in the values of a transform property, or -1 if it has none.
+ */
+static int getRotationOffset(int propertyId)
+{
+    switch (propertyId)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        return 0;
+    case Transform::ANIMATE_SCALE_ROTATE:
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
 AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long startTime, unsigned long endTime)
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _loopBlendTime(0), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f),
+      _pose(NULL), _layoutVersion(0), _poseSize(0), _lodNode(NULL), _lodTargetNode(NULL), _lodClip(NULL), _lodClipLevel(1), _lodLevel(0), _lodInterval(1),
+      _lodInterpolate(false), _lodVisible(true), _lodFrame(LOD_FRAME_STALE), _lodPhase(__lodPhase++),
+      _lodPoseClip(NULL), _lodPoseVersion(0), _lodPoses(NULL),
       _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL)
 {
     GP_REGISTER_SCRIPT_EVENTS();
@@ -22,12 +51,7 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
     GP_ASSERT(_animation);
     GP_ASSERT(0 <= startTime && startTime <= _animation->_duration && 0 <= endTime && endTime <= _animation->_duration);
 
-    for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
-    {
-        GP_ASSERT(_animation->_channels[i]);
-        GP_ASSERT(_animation->_channels[i]->getCurve());
-        _values.push_back(new AnimationValue(_animation->_channels[i]->getCurve()->getComponentCount()));
-    }
+    createLayout();
 }
 
 AnimationClip::~AnimationClip()
@@ -39,7 +63,10 @@ AnimationClip::~AnimationClip()
         valueIter++;
     }
     _values.clear();
+    SAFE_DELETE_ARRAY(_pose);
+    SAFE_DELETE_ARRAY(_lodPoses);
 
+    SAFE_RELEASE(_lodClip);
     SAFE_RELEASE(_crossFadeToClip);
     SAFE_DELETE(_beginListeners);
     SAFE_DELETE(_endListeners);
@@ -353,6 +380,46 @@ void AnimationClip::removeListener(AnimationClip::Listener* listener, unsigned l
     }
 }
 
+void AnimationClip::setLodNode(Node* node)
+{
+    _lodNode = node;
+}
+
+Node* AnimationClip::getLodNode() const
+{
+    return _lodNode ? _lodNode : _lodTargetNode;
+}
+
+void AnimationClip::setLodClip(AnimationClip* clip, unsigned int level)
+{
+    GP_ASSERT(clip != this);
+    GP_ASSERT(level > 0);
+
+    if (clip != _lodClip)
+    {
+        SAFE_RELEASE(_lodClip);
+        _lodClip = clip;
+        if (_lodClip)
+            _lodClip->addRef();
+    }
+    _lodClipLevel = level;
+}
+
+AnimationClip* AnimationClip::getLodClip() const
+{
+    return _lodClip;
+}
+
+unsigned int AnimationClip::getLodLevel() const
+{
+    return _lodLevel;
+}
+
+bool AnimationClip::isLodVisible() const
+{
+    return _lodVisible;
+}
+
 void AnimationClip::addBeginListener(AnimationClip::Listener* listener)
 {
     if (!_beginListeners)
@@ -492,17 +559,6 @@ bool AnimationClip::update(float elapsedTime)
     // Fire script update event
     fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(AnimationClip, clipUpdate), this, _elapsedTime);
 
-    // Add back in start time, and divide by the total animation's duration to get the actual percentage complete
-    GP_ASSERT(_animation);
-
-    // Compute percentage complete for the current loop (prevent a divide by zero if _duration==0).
-    // Note that we don't use (currentTime/(_duration+_loopBlendTime)). That's because we want a
-    // % value that is outside the 0-1 range for loop smoothing/blending purposes.
-    float percentComplete = _duration == 0 ? 1 : currentTime / (float)_duration;
-
-    if (_loopBlendTime == 0.0f)
-        percentComplete = MATH_CLAMP(percentComplete, 0.0f, 1.0f);
-
     // If we're cross fading, compute blend weights
     if (isClipStateBitSet(CLIP_IS_FADING_OUT_BIT))
     {
@@ -551,39 +607,227 @@ bool AnimationClip::update(float elapsedTime)
         }
     }
     
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
+    // Evaluate this clip at its level of detail and set the pose on the targets.
+    updatePose(currentTime);
+
+    // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
+    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
+    {
+        onEnd();
+        return true;
+    }
+
+    return false;
+}
+
+void AnimationClip::evaluate(float currentTime)
+{
+    // Channels may have been added or removed since the clip was laid out, such as when its animation is cloned.
+    updateLayout();
+
+    // Add back in start time, and divide by the total animation's duration to get the actual percentage complete
+    GP_ASSERT(_animation);
+
+    // Compute percentage complete for the current loop (prevent a divide by zero if _duration==0).
+    // Note that we don't use (currentTime/(_duration+_loopBlendTime)). That's because we want a
+    // % value that is outside the 0-1 range for loop smoothing/blending purposes.
+    float percentComplete = _duration == 0 ? 1 : currentTime / (float)_duration;
+
+    if (_loopBlendTime == 0.0f)
+        percentComplete = MATH_CLAMP(percentComplete, 0.0f, 1.0f);
+
     size_t channelCount = _animation->_channels.size();
+    GP_ASSERT(_channelOrder.size() == channelCount);
     float percentageStart = (float)_startTime / (float)_animation->_duration;
     float percentageEnd = (float)_endTime / (float)_animation->_duration;
     float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
     for (size_t i = 0; i < channelCount; i++)
     {
-        channel = _animation->_channels[i];
+        unsigned int index = _channelOrder[i];
+        Animation::Channel* channel = _animation->_channels[index];
         GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
-        value = _values[i];
-        GP_ASSERT(value);
+        GP_ASSERT(channel->getCurve());
+
+        // Evaluate the point on Curve into the pose, resuming the key search where the last update left off.
+        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, _poseValues[i]->_value, &_keyCursors[index]);
+    }
+}
 
-        // Evaluate the point on Curve
+void AnimationClip::createLayout()
+{
+    GP_ASSERT(_animation);
+
+    // Remove the previous layout.
+    for (size_t i = 0, count = _values.size(); i < count; i++)
+    {
+        SAFE_DELETE(_values[i]);
+    }
+    _values.clear();
+    SAFE_DELETE_ARRAY(_pose);
+    _keyCursors.clear();
+    _channelOrder.clear();
+    _propertyIds.clear();
+    _poseValues.clear();
+    _targetOffsets.clear();
+    _poseRotations.clear();
+    _lodTargetNode = NULL;
+
+    // Order the channels by target, in the order the targets first appear, keeping the order of the channels of each target.
+    size_t channelCount = _animation->_channels.size();
+    std::map<AnimationTarget*, unsigned int> targetOrder;
+    std::vector<std::pair<unsigned int, unsigned int> > order;
+    unsigned int poseSize = 0;
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel);
         GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value);
+        targetOrder.insert(std::make_pair(channel->_target, (unsigned int)targetOrder.size()));
+        order.push_back(std::make_pair(targetOrder[channel->_target], (unsigned int)i));
+        poseSize += channel->getCurve()->getComponentCount();
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    // Lay out the values of the channels in one pose buffer in the same order.
+    if (poseSize > 0)
+        _pose = new float[poseSize];
+    _values.resize(channelCount, NULL);
+    _keyCursors.resize(channelCount, 0);
+    unsigned int poseOffset = 0;
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        unsigned int index = order[i].second;
+        Animation::Channel* channel = _animation->_channels[index];
+        unsigned int componentCount = channel->getCurve()->getComponentCount();
+        _values[index] = new AnimationValue(componentCount, _pose + poseOffset);
+
+        if (i == 0 || order[i].first != order[i - 1].first)
+            _targetOffsets.push_back((unsigned int)i);
+        _channelOrder.push_back(index);
+        _propertyIds.push_back(channel->_propertyId);
+        _poseValues.push_back(_values[index]);
 
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+        // Remember where the rotations are, so interpolated poses can blend them as quaternions,
+        // and the first node the clip animates, which is measured for its level of detail by default.
+        AnimationTarget* target = channel->_target;
+        GP_ASSERT(target);
+        if (target->_targetType == AnimationTarget::TRANSFORM)
+        {
+            int rotationOffset = getRotationOffset(channel->_propertyId);
+            if (rotationOffset >= 0)
+                _poseRotations.push_back(poseOffset + rotationOffset);
+            if (_lodTargetNode == NULL)
+                _lodTargetNode = dynamic_cast<Node*>(target);
+        }
+        poseOffset += componentCount;
     }
+    _targetOffsets.push_back((unsigned int)channelCount);
+    _poseSize = poseOffset;
+    _layoutVersion = _animation->_channelVersion;
+}
 
-    // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
-    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
+void AnimationClip::updateLayout()
+{
+    GP_ASSERT(_animation);
+    if (_layoutVersion != _animation->_channelVersion)
+        createLayout();
+}
+
+AnimationTarget* AnimationClip::getPoseTarget(unsigned int index) const
+{
+    GP_ASSERT(index < _channelOrder.size());
+    return _animation->_channels[_channelOrder[index]]->_target;
+}
+
+void AnimationClip::updatePose(float currentTime)
+{
+    // Clips that end or fade are updated at the full rate, so they end on their last frame and blend smoothly.
+    bool fullRate = isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT) ||
+                    isClipStateBitSet(CLIP_IS_FADING_OUT_BIT) || isClipStateBitSet(CLIP_IS_FADING_IN_BIT);
+
+    if (!_lodVisible && !fullRate)
     {
-        onEnd();
-        return true;
+        // The time of a culled clip has advanced, so it is evaluated again as soon as it is visible.
+        _lodFrame = LOD_FRAME_STALE;
+        return;
     }
 
-    return false;
+    // The simplified clip is sampled at the same point of its duration.
+    AnimationClip* clip = this;
+    if (_lodClip && _lodLevel >= _lodClipLevel)
+    {
+        clip = _lodClip;
+        currentTime = _duration == 0 ? 0.0f : currentTime * (float)clip->_duration / (float)_duration;
+    }
+    clip->updateLayout();
+    if (clip != _lodPoseClip || clip->_layoutVersion != _lodPoseVersion)
+    {
+        _lodPoseClip = clip;
+        _lodPoseVersion = clip->_layoutVersion;
+        _lodFrame = LOD_FRAME_STALE;
+        SAFE_DELETE_ARRAY(_lodPoses);
+    }
+
+    if (_lodFrame != LOD_FRAME_STALE)
+        ++_lodFrame;
+    bool interpolate = _lodInterpolate && _lodInterval > 1 && !fullRate && clip->_poseSize > 0;
+    if (fullRate || _lodFrame >= _lodInterval)
+    {
+        clip->evaluate(currentTime);
+        if (interpolate)
+        {
+            // Keep the last two samples. The pose is interpolated between them until the next
+            // evaluation, so it trails the clip by one update interval.
+            size_t size = sizeof(float) * clip->_poseSize;
+            if (_lodPoses == NULL)
+            {
+                _lodPoses = new float[clip->_poseSize * 2];
+                _lodFrame = LOD_FRAME_STALE;
+            }
+            memcpy(_lodPoses, _lodFrame == LOD_FRAME_STALE ? clip->_pose : _lodPoses + clip->_poseSize, size);
+            memcpy(_lodPoses + clip->_poseSize, clip->_pose, size);
+            memcpy(clip->_pose, _lodPoses, size);
+        }
+        else
+        {
+            SAFE_DELETE_ARRAY(_lodPoses);
+        }
+
+        // Clips that start or become visible together are offset by their phase, so that they
+        // are not evaluated on the same updates.
+        _lodFrame = _lodFrame == LOD_FRAME_STALE ? _lodPhase % _lodInterval : 0;
+    }
+    else if (interpolate && _lodPoses)
+    {
+        const float* previous = _lodPoses;
+        const float* latest = _lodPoses + clip->_poseSize;
+        float t = (float)_lodFrame / (float)_lodInterval;
+        MathUtil::blendArrays(previous, latest, t, NULL, clip->_poseSize, clip->_pose);
+        for (size_t i = 0, count = clip->_poseRotations.size(); i < count; i++)
+        {
+            unsigned int offset = clip->_poseRotations[i];
+            MathUtil::blendQuaternions(previous + offset, latest + offset, t, NULL, 1, clip->_pose + offset);
+        }
+    }
+    else
+    {
+        // The targets hold the last evaluated pose until the next evaluation.
+        return;
+    }
+
+    clip->applyPose(_blendWeight);
+}
+
+void AnimationClip::applyPose(float blendWeight)
+{
+    // Set the pose on each target once, with all of its properties.
+    for (size_t i = 0, count = _targetOffsets.size() - 1; i < count; i++)
+    {
+        unsigned int first = _targetOffsets[i];
+        AnimationTarget* target = getPoseTarget(first);
+        GP_ASSERT(target);
+        target->setAnimationPropertyValues(_targetOffsets[i + 1] - first, &_propertyIds[first], &_poseValues[first], blendWeight);
+    }
 }
 
 void AnimationClip::onBegin()
@@ -672,20 +916,6 @@ AnimationClip* AnimationClip::clone(Animation* animation) const
     newClip->setSpeed(getSpeed());
     newClip->setRepeatCount(getRepeatCount());
     newClip->setBlendWeight(getBlendWeight());
-    
-    size_t size = _values.size();
-    newClip->_values.resize(size, NULL);
-    for (size_t i = 0; i < size; ++i)
-    {
-        if (newClip->_values[i] == NULL)
-        {
-            newClip->_values[i] = new AnimationValue(*_values[i]);
-        }
-        else
-        {
-            *newClip->_values[i] = *_values[i];
-        }
-    }
     return newClip;
 }
 
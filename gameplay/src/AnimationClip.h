@@ -11,6 +11,7 @@ namespace gameplay
 
 class Animation;
 class AnimationValue;
+class Node;
 
 /**
  * Defines the runtime session of an Animation to be played.
@@ -19,6 +20,7 @@ class AnimationClip : public Ref, public ScriptTarget
 {
     friend class AnimationController;
     friend class Animation;
+    friend class AnimationBlendTree;
 
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(clipBegin, "<AnimationClip>");
@@ -284,6 +286,71 @@ public:
      */
     void removeListener(AnimationClip::Listener* listener, unsigned long eventTime);
 
+    /**
+     * Sets the node whose distance from the LOD camera of the AnimationController, or size on
+     * the screen, selects the level of detail of the clip, and whose bounds are tested against
+     * the camera when culling. By default this is the first node the clip animates.
+     *
+     * The node is not referenced by the clip, so it must stay alive while the clip plays. For
+     * skeletons, whose joints have no bounds of their own, use the node of the model.
+     *
+     * @param node The node to measure, or NULL for the first node the clip animates.
+     *
+     * @see AnimationController::setLodCamera
+     * @script{ignore}
+     */
+    void setLodNode(Node* node);
+
+    /**
+     * Gets the node that selects the level of detail of the clip.
+     *
+     * @return The node, or NULL if the clip animates no node.
+     *
+     * @script{ignore}
+     */
+    Node* getLodNode() const;
+
+    /**
+     * Sets a simplified clip that is played in place of this clip at a level of detail and the
+     * levels coarser than it, such as a clip with fewer channels. The simplified clip is sampled
+     * at the same point of its duration as this clip, with the blend weight of this clip, and
+     * should not be played itself.
+     *
+     * @param clip The simplified clip, or NULL to always play this clip.
+     * @param level The first level of detail that plays the simplified clip.
+     *
+     * @script{ignore}
+     */
+    void setLodClip(AnimationClip* clip, unsigned int level = 1);
+
+    /**
+     * Gets the simplified clip that is played in place of this clip at coarse levels of detail.
+     *
+     * @return The simplified clip, or NULL if there is none.
+     *
+     * @script{ignore}
+     */
+    AnimationClip* getLodClip() const;
+
+    /**
+     * Gets the level of detail the clip was last updated at, where zero is the full level.
+     *
+     * @return The level of detail.
+     *
+     * @script{ignore}
+     */
+    unsigned int getLodLevel() const;
+
+    /**
+     * Checks whether the LOD node of the clip was visible when the clip was last updated.
+     * The time of a culled clip keeps advancing, but it is not evaluated.
+     *
+     * @return true if the clip was evaluated at its last update; false if it was culled.
+     *
+     * @script{ignore}
+     */
+    bool isLodVisible() const;
+
 private:
     
     static const unsigned char CLIP_IS_PLAYING_BIT = 0x01;             // Bit representing whether AnimationClip is a running clip in AnimationController
@@ -352,6 +419,38 @@ private:
      */
     bool update(float elapsedTime);
 
+    /**
+     * Evaluates the channels of the clip into its pose at a time within the clip, in milliseconds,
+     * without setting them on the targets.
+     */
+    void evaluate(float currentTime);
+
+    /**
+     * Lays out the pose of the clip for the current channels of its animation.
+     */
+    void createLayout();
+
+    /**
+     * Lays out the pose of the clip again if channels were added to or removed from its animation since it was laid out.
+     */
+    void updateLayout();
+
+    /**
+     * Gets the target of a channel, by its index in the order of the pose.
+     */
+    AnimationTarget* getPoseTarget(unsigned int index) const;
+
+    /**
+     * Evaluates the clip, or its simplified clip, at the rate of its level of detail and sets the
+     * pose on the targets. Between evaluations the pose is either held or interpolated.
+     */
+    void updatePose(float currentTime);
+
+    /**
+     * Sets the pose of the clip on its targets.
+     */
+    void applyPose(float blendWeight);
+
     /**
      * Handles when the AnimationClip begins.
      */
@@ -402,7 +501,29 @@ private:
     float _crossFadeOutElapsed;                         // The amount of time that has elapsed for the crossfade.
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
-    std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    std::vector<AnimationValue*> _values;               // AnimationValue holder, in the order of the channels of the animation.
+    float* _pose;                                       // The values of all channels, with the channels of each target together.
+    std::vector<unsigned int> _keyCursors;              // The key cursor of the curve of each channel.
+    std::vector<unsigned int> _channelOrder;            // The indices of the channels in the order of the pose.
+    std::vector<int> _propertyIds;                      // The property of each channel in the order of the pose.
+    std::vector<AnimationValue*> _poseValues;           // The value of each channel in the order of the pose.
+    std::vector<unsigned int> _targetOffsets;           // The offset of the first channel of each target in the pose order, followed by the channel count.
+    unsigned int _layoutVersion;                        // The channel version of the animation when the pose was laid out.
+    std::vector<unsigned int> _poseRotations;           // The offset of each rotation quaternion in the pose.
+    unsigned int _poseSize;                             // The number of values in the pose.
+    Node* _lodNode;                                     // The node set to be measured for the level of detail.
+    Node* _lodTargetNode;                               // The first node the clip animates, measured when no node is set.
+    AnimationClip* _lodClip;                            // The simplified clip played at coarse levels of detail.
+    unsigned int _lodClipLevel;                         // The first level of detail that plays the simplified clip.
+    unsigned int _lodLevel;                             // The level of detail, set by the AnimationController on each update.
+    unsigned int _lodInterval;                          // The number of updates between evaluations at the level of detail.
+    bool _lodInterpolate;                               // Whether updates between evaluations interpolate the last two samples.
+    bool _lodVisible;                                   // Whether the LOD node is visible, set by the AnimationController on each update.
+    unsigned int _lodFrame;                             // The number of updates since the last evaluation.
+    unsigned int _lodPhase;                             // Offsets the first evaluation of the clip from clips created before it.
+    AnimationClip* _lodPoseClip;                        // The clip that was evaluated last, this clip or the simplified clip.
+    unsigned int _lodPoseVersion;                       // The layout version of that clip when it was evaluated last.
+    float* _lodPoses;                                   // The previous and latest samples of the evaluated clip, when interpolating.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
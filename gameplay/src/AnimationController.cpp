@@ -2,17 +2,20 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "Camera.h"
+#include "Node.h"
 
 namespace gameplay
 {
 
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _lodCamera(NULL), _lodMetric(LOD_DISTANCE), _lodCulling(true)
 {
 }
 
 AnimationController::~AnimationController()
 {
+    SAFE_RELEASE(_lodCamera);
 }
 
 void AnimationController::stopAllAnimations() 
@@ -27,6 +30,66 @@ void AnimationController::stopAllAnimations()
     }
 }
 
+void AnimationController::setLodCamera(Camera* camera)
+{
+    if (camera != _lodCamera)
+    {
+        SAFE_RELEASE(_lodCamera);
+        _lodCamera = camera;
+        if (_lodCamera)
+            _lodCamera->addRef();
+    }
+}
+
+Camera* AnimationController::getLodCamera() const
+{
+    return _lodCamera;
+}
+
+void AnimationController::setLodMetric(LodMetric metric)
+{
+    _lodMetric = metric;
+    sortLodLevels();
+}
+
+AnimationController::LodMetric AnimationController::getLodMetric() const
+{
+    return _lodMetric;
+}
+
+void AnimationController::addLodLevel(float threshold, unsigned int updateInterval, bool interpolate)
+{
+    GP_ASSERT(threshold >= 0.0f);
+    GP_ASSERT(updateInterval > 0);
+
+    LodLevel level;
+    level.threshold = threshold;
+    level.updateInterval = updateInterval;
+    level.interpolate = interpolate;
+    _lodLevels.push_back(level);
+    sortLodLevels();
+}
+
+unsigned int AnimationController::getLodLevelCount() const
+{
+    return (unsigned int)_lodLevels.size();
+}
+
+void AnimationController::clearLodLevels()
+{
+    _lodLevels.clear();
+}
+
+void AnimationController::setLodCulling(bool enabled)
+{
+    _lodCulling = enabled;
+}
+
+bool AnimationController::isLodCulling() const
+{
+    return _lodCulling;
+}
+
 AnimationController::State AnimationController::getState() const
 {
     return _state;
@@ -46,6 +109,7 @@ void AnimationController::finalize()
         SAFE_RELEASE(clip);
     }
     _runningClips.clear();
+    SAFE_RELEASE(_lodCamera);
     _state = STOPPED;
 }
 
@@ -107,6 +171,7 @@ void AnimationController::update(float elapsedTime)
         AnimationClip* clip = (*clipIter);
         GP_ASSERT(clip);
         clip->addRef();
+        updateLod(clip);
         if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
         {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
             // move it from where it is in the running clips list to the back.
@@ -133,4 +198,72 @@ void AnimationController::update(float elapsedTime)
         _state = IDLE;
 }
 
+bool AnimationController::compareLodDistance(const LodLevel& a, const LodLevel& b)
+{
+    return a.threshold < b.threshold;
+}
+
+bool AnimationController::compareLodScreenSize(const LodLevel& a, const LodLevel& b)
+{
+    return a.threshold > b.threshold;
+}
+
+void AnimationController::updateLod(AnimationClip* clip)
+{
+    clip->_lodLevel = 0;
+    clip->_lodInterval = 1;
+    clip->_lodInterpolate = false;
+    clip->_lodVisible = true;
+
+    // The default LOD node is the first node the clip animates, which may have changed with its channels.
+    clip->updateLayout();
+    Node* node = clip->getLodNode();
+    Node* cameraNode = _lodCamera ? _lodCamera->getNode() : NULL;
+    if (node == NULL || cameraNode == NULL)
+        return;
+
+    const BoundingSphere& bounds = node->getBoundingSphere();
+    if (_lodCulling && !bounds.intersects(_lodCamera->getFrustum()))
+    {
+        clip->_lodVisible = false;
+        return;
+    }
+    if (_lodLevels.empty())
+        return;
+
+    float distance = bounds.center.distance(cameraNode->getTranslationWorld());
+    float measure = distance;
+    if (_lodMetric == LOD_SCREEN_SIZE)
+    {
+        // The fraction of the viewport height covered by the diameter of the bounds.
+        if (_lodCamera->getCameraType() == Camera::PERSPECTIVE)
+        {
+            float halfHeight = std::max(distance, MATH_EPSILON) * tanf(MATH_DEG_TO_RAD(_lodCamera->getFieldOfView()) * 0.5f);
+            measure = bounds.radius / halfHeight;
+        }
+        else
+        {
+            measure = bounds.radius * 2.0f / _lodCamera->getZoomY();
+        }
+    }
+
+    // The levels are sorted from the finest to the coarsest, so the last one reached is used.
+    for (size_t i = 0, count = _lodLevels.size(); i < count; ++i)
+    {
+        const LodLevel& level = _lodLevels[i];
+        if (_lodMetric == LOD_DISTANCE ? measure < level.threshold : measure > level.threshold)
+            break;
+
+        clip->_lodLevel = (unsigned int)i + 1;
+        clip->_lodInterval = level.updateInterval;
+        clip->_lodInterpolate = level.interpolate;
+    }
+}
+
+void AnimationController::sortLodLevels()
+{
+    // Distances grow and screen sizes shrink with coarser levels.
+    std::stable_sort(_lodLevels.begin(), _lodLevels.end(), _lodMetric == LOD_DISTANCE ? compareLodDistance : compareLodScreenSize);
+}
+
 }
@@ -9,6 +9,8 @@
 namespace gameplay
 {
 
+class Camera;
+
 /**
  * Defines a class for controlling game animation.
  */
@@ -25,9 +27,126 @@ public:
      * Stops all AnimationClips currently playing on the AnimationController.
      */
     void stopAllAnimations();
+
+    /**
+     * The measure of the LOD node of a clip that selects its level of detail.
+     */
+    enum LodMetric
+    {
+        /**
+         * The distance from the LOD camera to the center of the bounds of the node.
+         */
+        LOD_DISTANCE,
+
+        /**
+         * The fraction of the height of the viewport that the bounds of the node cover.
+         */
+        LOD_SCREEN_SIZE
+    };
+
+    /**
+     * Sets the camera that the level of detail of running clips is measured from.
+     *
+     * Each clip is updated at the level of detail of its LOD node. Coarser levels evaluate the
+     * clip less often and may play a simplified clip instead, and clips whose LOD node is outside
+     * the view frustum may be culled, so their time advances but they are not evaluated. Without
+     * a camera every clip is evaluated on every update.
+     *
+     * @param camera The camera, which must be attached to a node, or NULL to update every clip at the full level.
+     *
+     * @see AnimationClip::setLodNode
+     * @script{ignore}
+     */
+    void setLodCamera(Camera* camera);
+
+    /**
+     * Gets the camera that the level of detail of running clips is measured from.
+     *
+     * @return The camera, or NULL if there is none.
+     *
+     * @script{ignore}
+     */
+    Camera* getLodCamera() const;
+
+    /**
+     * Sets how the thresholds of the levels of detail are measured. The default is LOD_DISTANCE.
+     *
+     * @param metric The LOD metric.
+     *
+     * @script{ignore}
+     */
+    void setLodMetric(LodMetric metric);
+
+    /**
+     * Gets how the thresholds of the levels of detail are measured.
+     *
+     * @return The LOD metric.
+     *
+     * @script{ignore}
+     */
+    LodMetric getLodMetric() const;
+
+    /**
+     * Adds a level of detail for clips whose LOD node is at least the threshold distance from
+     * the camera, or covers at most the threshold size of the screen. Level zero is the full level,
+     * and the other levels are numbered from the finest threshold to the coarsest.
+     *
+     * @param threshold The distance, or the fraction of the viewport height, at which the level starts.
+     * @param updateInterval The number of updates between evaluations of the clips at the level.
+     * @param interpolate Whether the updates between evaluations interpolate the last two
+     *      evaluations, which delays the pose by one interval, instead of holding the last one.
+     *
+     * @script{ignore}
+     */
+    void addLodLevel(float threshold, unsigned int updateInterval, bool interpolate = true);
+
+    /**
+     * Gets the number of levels of detail, not counting the full level.
+     *
+     * @return The level count.
+     *
+     * @script{ignore}
+     */
+    unsigned int getLodLevelCount() const;
+
+    /**
+     * Removes all levels of detail, so visible clips are evaluated on every update.
+     *
+     * @script{ignore}
+     */
+    void clearLodLevels();
+
+    /**
+     * Sets whether clips whose LOD node is outside the view frustum of the LOD camera are culled.
+     * Culling is enabled by default.
+     *
+     * @param enabled true to cull clips; false to evaluate them at their level of detail.
+     *
+     * @script{ignore}
+     */
+    void setLodCulling(bool enabled);
+
+    /**
+     * Checks whether clips whose LOD node is outside the view frustum of the LOD camera are culled.
+     *
+     * @return true if clips are culled; false otherwise.
+     *
+     * @script{ignore}
+     */
+    bool isLodCulling() const;
        
 private:
 
+    /**
+     * A level of detail for running clips.
+     */
+    struct LodLevel
+    {
+        float threshold;
+        unsigned int updateInterval;
+        bool interpolate;
+    };
+
     /**
      * The states that the AnimationController may be in.
      */
@@ -95,9 +214,33 @@ private:
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
+
+    /**
+     * Sets the level of detail and visibility of a clip from its LOD node before it is updated.
+     */
+    void updateLod(AnimationClip* clip);
+
+    /**
+     * Sorts the levels of detail from the finest threshold to the coarsest.
+     */
+    void sortLodLevels();
+
+    /**
+     * Orders levels of detail by increasing distance.
+     */
+    static bool compareLodDistance(const LodLevel& a, const LodLevel& b);
+
+    /**
+     * Orders levels of detail by decreasing screen size.
+     */
+    static bool compareLodScreenSize(const LodLevel& a, const LodLevel& b);
     
     State _state;                                 // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    Camera* _lodCamera;                           // The camera the level of detail is measured from.
+    LodMetric _lodMetric;                         // How the thresholds of the levels of detail are measured.
+    std::vector<LodLevel> _lodLevels;             // The levels of detail after the full level.
+    bool _lodCulling;                             // Whether clips outside the view frustum are culled.
 };
 
 }
@@ -402,6 +402,16 @@ int AnimationTarget::getPropertyId(TargetType type, const char* propertyIdStr)
     return -1;
 }
 
+void AnimationTarget::setAnimationPropertyValues(unsigned int count, const int* propertyIds, AnimationValue* const* values, float blendWeight)
+{
+    GP_ASSERT(count == 0 || (propertyIds && values));
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        setAnimationPropertyValue(propertyIds[i], values[i], blendWeight);
+    }
+}
+
 void AnimationTarget::addChannel(Animation::Channel* channel)
 {
     if (_animationChannels == NULL)
@@ -138,6 +138,21 @@ public:
      */
     virtual void setAnimationPropertyValue(int propertyId, AnimationValue* value, float blendWeight = 1.0f) = 0;
 
+    /**
+     * Sets the values of several animation properties on the AnimationTarget at once, such as
+     * all the channels of an animation clip that target it.
+     *
+     * The properties are set in order with the same blend weight. By default each property is
+     * set with setAnimationPropertyValue, and targets may override this to apply them together.
+     *
+     * @param count The number of properties to set.
+     * @param propertyIds The IDs of the properties to set.
+     * @param values The values of the properties.
+     * @param blendWeight The blend weight.
+     * @script{ignore}
+     */
+    virtual void setAnimationPropertyValues(unsigned int count, const int* propertyIds, AnimationValue* const* values, float blendWeight = 1.0f);
+
     /**
      * Gets the animation with the specified ID. If the ID is NULL, this function will return the first animation it finds.
      *
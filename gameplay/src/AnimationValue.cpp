@@ -5,13 +5,21 @@ namespace gameplay
 {
 
 AnimationValue::AnimationValue(unsigned int componentCount)
-  : _componentCount(componentCount), _componentSize(componentCount * sizeof(float))
+  : _componentCount(componentCount), _componentSize(componentCount * sizeof(float)), _ownsValue(true)
 {
     GP_ASSERT(_componentCount > 0);
     _value = new float[_componentCount];
 }
 
+AnimationValue::AnimationValue(unsigned int componentCount, float* value)
+  : _componentCount(componentCount), _componentSize(componentCount * sizeof(float)), _value(value), _ownsValue(false)
+{
+    GP_ASSERT(_componentCount > 0);
+    GP_ASSERT(_value);
+}
+
 AnimationValue::AnimationValue(const AnimationValue& copy)
+    : _ownsValue(true)
 {
     _value = new float[copy._componentCount];
     _componentSize = copy._componentSize;
@@ -21,7 +29,8 @@ AnimationValue::AnimationValue(const AnimationValue& copy)
 
 AnimationValue::~AnimationValue()
 {
-    SAFE_DELETE_ARRAY(_value);
+    if (_ownsValue)
+        SAFE_DELETE_ARRAY(_value);
 }
 
 AnimationValue& AnimationValue::operator=(const AnimationValue& v)
@@ -32,8 +41,10 @@ AnimationValue& AnimationValue::operator=(const AnimationValue& v)
         {
             _componentSize = v._componentSize;
             _componentCount = v._componentCount;
-            SAFE_DELETE_ARRAY(_value);
+            if (_ownsValue)
+                SAFE_DELETE_ARRAY(_value);
             _value = new float[v._componentCount];
+            _ownsValue = true;
         }
         memcpy(_value, v._value, _componentSize);
     }
@@ -62,6 +62,11 @@ private:
      */
     AnimationValue(unsigned int componentCount);
 
+    /**
+     * Constructor that stores the value in memory owned by the caller, such as the pose buffer of a clip.
+     */
+    AnimationValue(unsigned int componentCount, float* value);
+
     /**
      * Constructor.
      */
@@ -80,6 +85,7 @@ private:
     unsigned int _componentCount;   // The number of float values for the property.
     unsigned int _componentSize;    // The number of bytes of memory the property is.
     float* _value;                  // The current value of the property.
+    bool _ownsValue;                // Whether the value memory is deleted with this object.
 
 };
 
@@ -0,0 +1,570 @@
+#include "Base.h"
+#include "AssetLoader.h"
+#include "FileSystem.h"
+#include "Image.h"
+#include "Texture.h"
+#include "Properties.h"
+#include "Bundle.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+
+namespace gameplay
+{
+
+// Default time spent finalizing completed loads on the main thread each frame, in milliseconds.
+#define ASSET_LOADER_DEFAULT_FRAME_BUDGET 2.0f
+
+static bool hasExtension(const char* path, const char* extension)
+{
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    return ext && strcmpnocase(ext, extension) == 0;
+}
+
+/**
+ * Decodes an image on a worker thread.
+ */
+class AssetLoader::ImageRequest : public AssetLoader::Request
+{
+public:
+
+    ImageRequest(const char* path, const std::function<void(Image*)>& callback)
+        : AssetLoader::Request(path), _callback(callback), _image(NULL)
+    {
+    }
+
+    ~ImageRequest()
+    {
+        SAFE_RELEASE(_image);
+    }
+
+protected:
+
+    void load()
+    {
+        _image = Image::create(getPath());
+    }
+
+    void finalize()
+    {
+        Image* image = _image;
+        _image = NULL;
+        if (_callback)
+            _callback(image);
+        else
+            SAFE_RELEASE(image);
+    }
+
+    void discard()
+    {
+        SAFE_RELEASE(_image);
+    }
+
+private:
+
+    std::function<void(Image*)> _callback;
+    Image* _image;
+};
+
+/**
+ * Decodes a PNG texture on a worker thread and uploads it on the main thread.
+ */
+class AssetLoader::TextureRequest : public AssetLoader::Request
+{
+public:
+
+    TextureRequest(const char* path, bool generateMipmaps, const std::function<void(Texture*)>& callback)
+        : AssetLoader::Request(path), _callback(callback), _generateMipmaps(generateMipmaps), _image(NULL)
+    {
+    }
+
+    ~TextureRequest()
+    {
+        SAFE_RELEASE(_image);
+    }
+
+protected:
+
+    void load()
+    {
+        // Compressed textures are read and uploaded together on the main thread.
+        if (hasExtension(getPath(), ".png"))
+            _image = Image::create(getPath());
+    }
+
+    void finalize()
+    {
+        // The texture may have been loaded by someone else in the meantime.
+        Texture* texture = Texture::findCached(getPath(), _generateMipmaps);
+        if (texture == NULL)
+        {
+            if (_image)
+            {
+                texture = Texture::create(_image, _generateMipmaps);
+                if (texture)
+                    Texture::addToCache(texture, getPath());
+            }
+            else if (!hasExtension(getPath(), ".png"))
+            {
+                texture = Texture::create(getPath(), _generateMipmaps);
+            }
+        }
+        SAFE_RELEASE(_image);
+
+        if (_callback)
+            _callback(texture);
+        else
+            SAFE_RELEASE(texture);
+    }
+
+    void discard()
+    {
+        SAFE_RELEASE(_image);
+    }
+
+private:
+
+    std::function<void(Texture*)> _callback;
+    bool _generateMipmaps;
+    Image* _image;
+};
+
+/**
+ * Parses a properties file on a worker thread.
+ */
+class AssetLoader::PropertiesRequest : public AssetLoader::Request
+{
+public:
+
+    PropertiesRequest(const char* url, const std::function<void(Properties*)>& callback)
+        : AssetLoader::Request(url), _callback(callback), _properties(NULL)
+    {
+    }
+
+    ~PropertiesRequest()
+    {
+        SAFE_DELETE(_properties);
+    }
+
+protected:
+
+    void load()
+    {
+        _properties = Properties::create(getPath());
+    }
+
+    void finalize()
+    {
+        Properties* properties = _properties;
+        _properties = NULL;
+        if (_callback)
+            _callback(properties);
+        else
+            SAFE_DELETE(properties);
+    }
+
+    void discard()
+    {
+        SAFE_DELETE(_properties);
+    }
+
+private:
+
+    std::function<void(Properties*)> _callback;
+    Properties* _properties;
+};
+
+/**
+ * Opens a bundle and reads its reference table on a worker thread.
+ */
+class AssetLoader::BundleRequest : public AssetLoader::Request
+{
+public:
+
+    BundleRequest(const char* path, const std::function<void(Bundle*)>& callback)
+        : AssetLoader::Request(path), _callback(callback), _bundle(NULL)
+    {
+    }
+
+    ~BundleRequest()
+    {
+        SAFE_RELEASE(_bundle);
+    }
+
+protected:
+
+    void load()
+    {
+        _bundle = Bundle::open(getPath());
+    }
+
+    void finalize()
+    {
+        Bundle* bundle = _bundle ? Bundle::addToCache(_bundle) : NULL;
+        _bundle = NULL;
+        if (_callback)
+            _callback(bundle);
+        else
+            SAFE_RELEASE(bundle);
+    }
+
+    void discard()
+    {
+        SAFE_RELEASE(_bundle);
+    }
+
+private:
+
+    std::function<void(Bundle*)> _callback;
+    Bundle* _bundle;
+};
+
+/**
+ * Finds the PNG textures of the samplers in a properties object and its namespaces,
+ * with whether any of their samplers generate mipmaps.
+ */
+static void findSamplerTextures(Properties* properties, std::map<std::string, bool>* textures)
+{
+    GP_ASSERT(properties);
+    GP_ASSERT(textures);
+
+    properties->rewind();
+    Properties* ns;
+    while ((ns = properties->getNextNamespace()) != NULL)
+    {
+        if (strcmp(ns->getNamespace(), "sampler") == 0)
+        {
+            std::string path;
+            if (ns->getPath("path", &path) && hasExtension(path.c_str(), ".png"))
+                (*textures)[path] |= ns->getBool("mipmap");
+        }
+        else
+        {
+            findSamplerTextures(ns, textures);
+        }
+    }
+    properties->rewind();
+}
+
+/**
+ * Reads a scene file, the properties files it references and the PNG textures of their materials, and
+ * opens its main bundle, on a worker thread. Builds the scene on the main thread.
+ */
+class AssetLoader::SceneRequest : public AssetLoader::Request
+{
+public:
+
+    SceneRequest(const char* url, const std::function<void(Scene*)>& callback)
+        : AssetLoader::Request(url), _callback(callback), _loader(NULL), _bundle(NULL)
+    {
+    }
+
+    ~SceneRequest()
+    {
+        discard();
+    }
+
+protected:
+
+    void load()
+    {
+        if (hasExtension(getPath(), ".gpb"))
+        {
+            _bundle = Bundle::open(getPath());
+            return;
+        }
+
+        _loader = new SceneLoader();
+        if (!_loader->prepare(getPath()))
+        {
+            SAFE_DELETE(_loader);
+            return;
+        }
+
+        // Open the main bundle of the scene so that the scene loader finds it in the bundle cache.
+        if (!_loader->_gpbPath.empty())
+            _bundle = Bundle::open(_loader->_gpbPath.c_str());
+
+        // Decode the textures of the materials, so that only their upload is left for the main thread.
+        std::map<std::string, bool> textures;
+        for (std::map<std::string, Properties*>::iterator itr = _loader->_properties.begin(); itr != _loader->_properties.end(); ++itr)
+        {
+            if (itr->second)
+                findSamplerTextures(itr->second, &textures);
+        }
+        for (std::map<std::string, bool>::iterator itr = textures.begin(); itr != textures.end(); ++itr)
+        {
+            Image* image = Image::create(itr->first.c_str());
+            if (image)
+                _images.push_back(TextureImage(itr->first, itr->second, image));
+        }
+    }
+
+    void finalize()
+    {
+        if (_bundle)
+            _bundle = Bundle::addToCache(_bundle);
+
+        // Upload the decoded textures into the texture cache, where the materials of the scene find them,
+        // and hold them until the scene has been built.
+        std::vector<Texture*> textures;
+        for (size_t i = 0, count = _images.size(); i < count; ++i)
+        {
+            const TextureImage& textureImage = _images[i];
+            Texture* texture = Texture::findCached(textureImage.path.c_str(), textureImage.generateMipmaps);
+            if (texture == NULL)
+            {
+                texture = Texture::create(textureImage.image, textureImage.generateMipmaps);
+                if (texture)
+                    Texture::addToCache(texture, textureImage.path.c_str());
+            }
+            if (texture)
+                textures.push_back(texture);
+        }
+
+        Scene* scene = NULL;
+        if (_loader)
+        {
+            scene = _loader->build();
+        }
+        else if (_bundle && hasExtension(getPath(), ".gpb"))
+        {
+            scene = _bundle->loadScene();
+        }
+        for (size_t i = 0, count = textures.size(); i < count; ++i)
+        {
+            SAFE_RELEASE(textures[i]);
+        }
+        discard();
+
+        if (_callback)
+            _callback(scene);
+        else
+            SAFE_RELEASE(scene);
+    }
+
+    void discard()
+    {
+        SAFE_DELETE(_loader);
+        SAFE_RELEASE(_bundle);
+        for (size_t i = 0, count = _images.size(); i < count; ++i)
+        {
+            SAFE_RELEASE(_images[i].image);
+        }
+        _images.clear();
+    }
+
+private:
+
+    /**
+     * A decoded texture of the scene.
+     */
+    struct TextureImage
+    {
+        TextureImage(const std::string& path, bool generateMipmaps, Image* image)
+            : path(path), generateMipmaps(generateMipmaps), image(image) {}
+
+        std::string path;
+        bool generateMipmaps;
+        Image* image;
+    };
+
+    std::function<void(Scene*)> _callback;
+    SceneLoader* _loader;
+    Bundle* _bundle;
+    std::vector<TextureImage> _images;
+};
+
+AssetLoader::Request::Request(const char* path)
+    : _path(path ? path : ""), _canceled(false), _complete(false)
+{
+}
+
+AssetLoader::Request::~Request()
+{
+}
+
+const char* AssetLoader::Request::getPath() const
+{
+    return _path.c_str();
+}
+
+bool AssetLoader::Request::isComplete() const
+{
+    return _complete;
+}
+
+void AssetLoader::Request::cancel()
+{
+    _canceled = true;
+}
+
+bool AssetLoader::Request::isCanceled() const
+{
+    return _canceled.load();
+}
+
+AssetLoader::AssetLoader()
+    : _scheduler(NULL), _frameBudget(ASSET_LOADER_DEFAULT_FRAME_BUDGET)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    GP_ASSERT(_requests.empty());
+}
+
+void AssetLoader::initialize(JobScheduler* scheduler)
+{
+    GP_ASSERT(scheduler);
+    _scheduler = scheduler;
+}
+
+void AssetLoader::finalize()
+{
+    while (!_requests.empty())
+    {
+        RequestHandle request = _requests.front();
+        _requests.pop_front();
+        request->cancel();
+        _scheduler->wait(request->_job);
+        complete(request);
+    }
+}
+
+AssetLoader::RequestHandle AssetLoader::loadImage(const char* path, const std::function<void(Image*)>& callback)
+{
+    GP_ASSERT(path);
+    return submit(new ImageRequest(path, callback));
+}
+
+AssetLoader::RequestHandle AssetLoader::loadTexture(const char* path, bool generateMipmaps, const std::function<void(Texture*)>& callback)
+{
+    GP_ASSERT(path);
+    return submit(new TextureRequest(path, generateMipmaps, callback));
+}
+
+AssetLoader::RequestHandle AssetLoader::loadProperties(const char* url, const std::function<void(Properties*)>& callback)
+{
+    GP_ASSERT(url);
+    return submit(new PropertiesRequest(url, callback));
+}
+
+AssetLoader::RequestHandle AssetLoader::loadBundle(const char* path, const std::function<void(Bundle*)>& callback)
+{
+    GP_ASSERT(path);
+    return submit(new BundleRequest(path, callback));
+}
+
+AssetLoader::RequestHandle AssetLoader::loadScene(const char* url, const std::function<void(Scene*)>& callback)
+{
+    GP_ASSERT(url);
+    return submit(new SceneRequest(url, callback));
+}
+
+AssetLoader::RequestHandle AssetLoader::submit(Request* request)
+{
+    GP_ASSERT(request);
+    GP_ASSERT(_scheduler);
+
+    RequestHandle handle(request);
+    request->_job = _scheduler->submit([request]()
+    {
+        if (!request->_canceled)
+            request->load();
+    });
+    _requests.push_back(handle);
+
+    return handle;
+}
+
+void AssetLoader::complete(const RequestHandle& request)
+{
+    GP_ASSERT(request);
+    GP_ASSERT(request->_job->isComplete());
+
+    if (request->_canceled)
+    {
+        request->discard();
+    }
+    else
+    {
+        request->finalize();
+        request->_complete = true;
+    }
+}
+
+void AssetLoader::wait(const RequestHandle& request)
+{
+    GP_ASSERT(request);
+
+    std::deque<RequestHandle>::iterator itr = std::find(_requests.begin(), _requests.end(), request);
+    if (itr == _requests.end())
+        return;
+    _requests.erase(itr);
+
+    _scheduler->wait(request->_job);
+    complete(request);
+}
+
+void AssetLoader::waitAll()
+{
+    while (!_requests.empty())
+    {
+        RequestHandle request = _requests.front();
+        _requests.pop_front();
+        _scheduler->wait(request->_job);
+        complete(request);
+    }
+}
+
+unsigned int AssetLoader::getPendingCount() const
+{
+    return (unsigned int)_requests.size();
+}
+
+float AssetLoader::getFrameBudget() const
+{
+    return _frameBudget;
+}
+
+void AssetLoader::setFrameBudget(float budget)
+{
+    _frameBudget = budget;
+}
+
+void AssetLoader::update()
+{
+    if (_requests.empty())
+        return;
+
+    // Without worker threads jobs only run when they are waited on,
+    // so load the oldest request on the main thread instead.
+    if (_scheduler->getWorkerCount() == 0)
+        _scheduler->wait(_requests.front()->_job);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Requests are finalized in submission order as they complete. Indices are used
+    // since the callbacks may submit new requests.
+    size_t i = 0;
+    while (i < _requests.size())
+    {
+        RequestHandle request = _requests[i];
+        if (!request->_job->isComplete())
+        {
+            ++i;
+            continue;
+        }
+        _requests.erase(_requests.begin() + i);
+        complete(request);
+
+        if (_frameBudget > 0.0f)
+        {
+            std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= _frameBudget)
+                break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,290 @@
+#ifndef ASSETLOADER_H_
+#define ASSETLOADER_H_
+
+#include "JobScheduler.h"
+
+namespace gameplay
+{
+
+class Image;
+class Texture;
+class Properties;
+class Bundle;
+class Scene;
+
+/**
+ * Defines a loader that loads assets in the background without blocking the game loop.
+ *
+ * File I/O, image decoding and bundle parsing run as jobs on the worker threads of the
+ * JobScheduler. Once the background part of a load has completed, the work that requires
+ * the GL context, such as creating textures, runs on the main thread at the start of a
+ * following frame. To avoid hitches when many assets complete at once, this finalization
+ * is spread across frames so that it takes no more than the frame budget on each frame.
+ * The budget is checked between requests, so a single request whose finalization takes
+ * longer, such as building a large scene, still completes within one frame.
+ *
+ * When the load has been finalized, its completion callback is called on the main thread
+ * with the loaded asset, or NULL if it failed to load. The callback takes ownership of the
+ * asset exactly as if it had been returned from the synchronous create method.
+ *
+ * The loader is owned by the Game and its frame budget may be set with 'frameBudget' (in
+ * milliseconds) in the 'assets' config namespace.
+ *
+ * @script{ignore}
+ */
+class AssetLoader
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines a request to load an asset in the background.
+     */
+    class Request
+    {
+        friend class AssetLoader;
+
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Request();
+
+        /**
+         * Gets the path or URL of the asset being loaded.
+         *
+         * @return The path of the asset.
+         */
+        const char* getPath() const;
+
+        /**
+         * Determines if the load has been finalized and its callback called.
+         *
+         * @return true if the request has completed, false otherwise.
+         */
+        bool isComplete() const;
+
+        /**
+         * Cancels the request.
+         *
+         * The callback of a canceled request is never called and its asset is released once
+         * the background part of the load has completed. Must be called on the main thread.
+         */
+        void cancel();
+
+        /**
+         * Determines if the request has been canceled.
+         *
+         * @return true if the request was canceled, false otherwise.
+         */
+        bool isCanceled() const;
+
+    protected:
+
+        /**
+         * Constructor.
+         *
+         * @param path The path or URL of the asset to load.
+         */
+        Request(const char* path);
+
+        /**
+         * Runs the part of the load that is safe to run on a worker thread.
+         */
+        virtual void load() = 0;
+
+        /**
+         * Runs the part of the load that must run on the main thread and calls the callback.
+         */
+        virtual void finalize() = 0;
+
+        /**
+         * Releases the loaded data of a canceled request on the main thread.
+         */
+        virtual void discard() = 0;
+
+    private:
+
+        Request(const Request& copy);
+
+        Request& operator=(const Request&);
+
+        std::string _path;
+        std::atomic<bool> _canceled;
+        bool _complete;
+        JobScheduler::JobHandle _job;
+    };
+
+    /**
+     * Handle to a submitted load request.
+     */
+    typedef std::shared_ptr<Request> RequestHandle;
+
+    /**
+     * Destructor.
+     */
+    ~AssetLoader();
+
+    /**
+     * Loads an image in the background.
+     *
+     * @param path The path of the image to load.
+     * @param callback The function called with the loaded image.
+     *
+     * @return A handle to the request.
+     * @see Image::create(const char*)
+     */
+    RequestHandle loadImage(const char* path, const std::function<void(Image*)>& callback);
+
+    /**
+     * Loads a texture in the background.
+     *
+     * PNG files are decoded on a worker thread and only uploaded on the main thread.
+     * Compressed texture files are loaded entirely on the main thread.
+     *
+     * @param path The path of the texture to load.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     * @param callback The function called with the loaded texture.
+     *
+     * @return A handle to the request.
+     * @see Texture::create(const char*, bool)
+     */
+    RequestHandle loadTexture(const char* path, bool generateMipmaps, const std::function<void(Texture*)>& callback);
+
+    /**
+     * Loads a properties file in the background.
+     *
+     * @param url The URL of the properties to load.
+     * @param callback The function called with the loaded properties.
+     *
+     * @return A handle to the request.
+     * @see Properties::create(const char*)
+     */
+    RequestHandle loadProperties(const char* url, const std::function<void(Properties*)>& callback);
+
+    /**
+     * Opens a bundle and reads its reference table in the background.
+     *
+     * @param path The path of the bundle to load.
+     * @param callback The function called with the loaded bundle.
+     *
+     * @return A handle to the request.
+     * @see Bundle::create(const char*)
+     */
+    RequestHandle loadBundle(const char* path, const std::function<void(Bundle*)>& callback);
+
+    /**
+     * Loads a scene in the background.
+     *
+     * The scene file and the properties files it references, such as materials, are read,
+     * the PNG textures of its materials are decoded and its main bundle is opened on a worker
+     * thread. The scene itself is then built on the main thread in a single step, which reads
+     * its nodes and meshes from the bundle and creates their GPU resources. This step is not
+     * split across frames, so building a large scene may exceed the frame budget.
+     *
+     * @param url The URL of the scene file to load.
+     * @param callback The function called with the loaded scene.
+     *
+     * @return A handle to the request.
+     * @see Scene::load(const char*)
+     */
+    RequestHandle loadScene(const char* url, const std::function<void(Scene*)>& callback);
+
+    /**
+     * Waits for the given request to complete, finalizing it immediately regardless of the
+     * frame budget. Must be called on the main thread.
+     *
+     * @param request The request to wait on.
+     */
+    void wait(const RequestHandle& request);
+
+    /**
+     * Waits for all of the submitted requests to complete. Must be called on the main thread.
+     */
+    void waitAll();
+
+    /**
+     * Gets the number of submitted requests that have not completed yet.
+     *
+     * @return The number of pending requests.
+     */
+    unsigned int getPendingCount() const;
+
+    /**
+     * Gets the time spent finalizing completed loads on the main thread each frame.
+     *
+     * @return The frame budget in milliseconds.
+     */
+    float getFrameBudget() const;
+
+    /**
+     * Sets the time spent finalizing completed loads on the main thread each frame.
+     *
+     * At least one completed load is finalized on every frame regardless of the budget.
+     * A budget of zero finalizes all completed loads on every frame.
+     *
+     * @param budget The frame budget in milliseconds.
+     */
+    void setFrameBudget(float budget);
+
+private:
+
+    class ImageRequest;
+    class TextureRequest;
+    class PropertiesRequest;
+    class BundleRequest;
+    class SceneRequest;
+
+    /**
+     * Constructor.
+     */
+    AssetLoader();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AssetLoader(const AssetLoader& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AssetLoader& operator=(const AssetLoader&);
+
+    /**
+     * Initializes the loader.
+     *
+     * @param scheduler The job scheduler that runs the background part of the loads.
+     */
+    void initialize(JobScheduler* scheduler);
+
+    /**
+     * Waits for all of the pending requests and releases their assets without calling their callbacks.
+     */
+    void finalize();
+
+    /**
+     * Finalizes the requests whose background loads have completed, within the frame budget.
+     * Called by the Game at the start of every frame.
+     */
+    void update();
+
+    /**
+     * Submits the background part of a request to the job scheduler.
+     */
+    RequestHandle submit(Request* request);
+
+    /**
+     * Finalizes or discards a request whose background load has completed.
+     */
+    void complete(const RequestHandle& request);
+
+    JobScheduler* _scheduler;
+    std::deque<RequestHandle> _requests;
+    float _frameBudget;
+};
+
+}
+
+#endif
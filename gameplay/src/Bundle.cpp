@@ -4,6 +4,7 @@
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Joint.h"
+#include "TextureAtlas.h"
 
 // Minimum version numbers supported
 #define BUNDLE_VERSION_MAJOR_REQUIRED   1 
@@ -30,6 +31,16 @@
 #define BUNDLE_VERSION_MAJOR_FONT_FORMAT  1
 #define BUNDLE_VERSION_MINOR_FONT_FORMAT  5
 
+#define BUNDLE_VERSION_MAJOR_ANIMATION_ENCODING  1
+#define BUNDLE_VERSION_MINOR_ANIMATION_ENCODING  6
+
+// Encodings of animation channels
+#define BUNDLE_ANIMATION_ENCODING_KEYS          0
+#define BUNDLE_ANIMATION_ENCODING_COMPRESSED    1
+
+// Rotation offset of a compressed animation channel without a rotation
+#define BUNDLE_ANIMATION_NO_ROTATION            0xFFFFFFFF
+
 namespace gameplay
 {
 
@@ -185,8 +196,42 @@ Bundle* Bundle::create(const char* path)
         }
     }
 
-    // Open the bundle.
-    Stream* stream = FileSystem::open(path);
+    Bundle* bundle = open(path);
+    if (bundle)
+    {
+        __bundleCache.push_back(bundle);
+    }
+    return bundle;
+}
+
+Bundle* Bundle::addToCache(Bundle* bundle)
+{
+    GP_ASSERT(bundle);
+
+    for (size_t i = 0, count = __bundleCache.size(); i < count; ++i)
+    {
+        Bundle* p = __bundleCache[i];
+        GP_ASSERT(p);
+        if (p->_path == bundle->_path)
+        {
+            // Another bundle was loaded from the same path while this one was being opened.
+            p->addRef();
+            SAFE_RELEASE(bundle);
+            return p;
+        }
+    }
+
+    __bundleCache.push_back(bundle);
+    return bundle;
+}
+
+Bundle* Bundle::open(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Open the bundle, mapping it into memory where supported so that
+    // mesh data can be uploaded straight from the mapping.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MEMORY_MAPPED);
     if (!stream)
     {
         GP_WARN("Failed to open file '%s'.", path);
@@ -249,26 +294,44 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->buildReferenceIndex();
 
     return bundle;
 }
 
-Bundle::Reference* Bundle::find(const char* id) const
+void Bundle::buildReferenceIndex()
 {
-    GP_ASSERT(id);
-    GP_ASSERT(_references);
-
-    // Search the ref table for the given id (case-sensitive).
+    _referencesById.clear();
+    _idsByOffset.clear();
+    _animationReferences.clear();
+    _referencesById.reserve(_referenceCount);
+    _idsByOffset.reserve(_referenceCount);
+
+    // Only the first reference is indexed for a duplicated id or offset, which
+    // matches the results of searching the reference table in order.
     for (unsigned int i = 0; i < _referenceCount; ++i)
     {
-        if (_references[i].id == id)
+        Reference* ref = &_references[i];
+        _referencesById.insert(std::make_pair(ref->id, ref));
+        if (ref->offset > 0 && ref->id.length() > 0)
         {
-            // Found a match
-            return &_references[i];
+            _idsByOffset.insert(std::make_pair(ref->offset, ref->id.c_str()));
+        }
+        if (ref->type == BUNDLE_TYPE_ANIMATIONS)
+        {
+            _animationReferences.push_back(ref);
         }
     }
+}
 
-    return NULL;
+Bundle::Reference* Bundle::find(const char* id) const
+{
+    GP_ASSERT(id);
+    GP_ASSERT(_references);
+
+    // Look up the given id in the ref table index (case-sensitive).
+    std::unordered_map<std::string, Reference*>::const_iterator itr = _referencesById.find(id);
+    return itr != _referencesById.end() ? itr->second : NULL;
 }
 
 void Bundle::clearLoadSession()
@@ -288,17 +351,12 @@ const char* Bundle::getIdFromOffset() const
 
 const char* Bundle::getIdFromOffset(unsigned int offset) const
 {
-    // Search the ref table for the given offset.
+    // Look up the given offset in the ref table index.
     if (offset > 0)
     {
-        GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
-        {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
-            {
-                return _references[i].id.c_str();
-            }
-        }
+        std::unordered_map<unsigned int, const char*>::const_iterator itr = _idsByOffset.find(offset);
+        if (itr != _idsByOffset.end())
+            return itr->second;
     }
     return NULL;
 }
@@ -472,19 +530,15 @@ Scene* Bundle::loadScene(const char* id)
     // Parse animations.
     GP_ASSERT(_references);
     GP_ASSERT(_stream);
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    for (size_t i = 0, count = _animationReferences.size(); i < count; ++i)
     {
-        Reference* ref = &_references[i];
-        if (ref->type == BUNDLE_TYPE_ANIMATIONS)
+        Reference* ref = _animationReferences[i];
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
         {
-            // Found a match.
-            if (_stream->seek(ref->offset, SEEK_SET) == false)
-            {
-                GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                return NULL;
-            }
-            readAnimations(scene);
+            GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            return NULL;
         }
+        readAnimations(scene);
     }
 
     resolveJointReferences(scene, NULL);
@@ -512,90 +566,87 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
         resolveJointReferences(sceneContext, node);
 
     // Load all animations targeting any nodes or mesh skins under this node's hierarchy.
-    for (unsigned int i = 0; i < _referenceCount; i++)
+    for (size_t i = 0, count = _animationReferences.size(); i < count; i++)
     {
-        Reference* ref = &_references[i];
-        if (ref->type == BUNDLE_TYPE_ANIMATIONS)
+        Reference* ref = _animationReferences[i];
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
         {
-            if (_stream->seek(ref->offset, SEEK_SET) == false)
-            {
-                GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                SAFE_DELETE(_trackedNodes);
-                return NULL;
-            }
+            GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            SAFE_DELETE(_trackedNodes);
+            return NULL;
+        }
+
+        // Read the number of animations in this object.
+        unsigned int animationCount;
+        if (!read(&animationCount))
+        {
+            GP_ERROR("Failed to read the number of animations for object '%s'.", ref->id.c_str());
+            SAFE_DELETE(_trackedNodes);
+            return NULL;
+        }
+
+        for (unsigned int j = 0; j < animationCount; j++)
+        {
+            const std::string id = readString(_stream);
 
-            // Read the number of animations in this object.
-            unsigned int animationCount;
-            if (!read(&animationCount))
+            // Read the number of animation channels in this animation.
+            unsigned int animationChannelCount;
+            if (!read(&animationChannelCount))
             {
-                GP_ERROR("Failed to read the number of animations for object '%s'.", ref->id.c_str());
+                GP_ERROR("Failed to read the number of animation channels for animation '%s'.", "animationChannelCount", id.c_str());
                 SAFE_DELETE(_trackedNodes);
                 return NULL;
             }
 
-            for (unsigned int j = 0; j < animationCount; j++)
+            Animation* animation = NULL;
+            for (unsigned int k = 0; k < animationChannelCount; k++)
             {
-                const std::string id = readString(_stream);
-
-                // Read the number of animation channels in this animation.
-                unsigned int animationChannelCount;
-                if (!read(&animationChannelCount))
+                // Read target id.
+                std::string targetId = readString(_stream);
+                if (targetId.empty())
                 {
-                    GP_ERROR("Failed to read the number of animation channels for animation '%s'.", "animationChannelCount", id.c_str());
+                    GP_ERROR("Failed to read target id for animation '%s'.", id.c_str());
                     SAFE_DELETE(_trackedNodes);
                     return NULL;
                 }
 
-                Animation* animation = NULL;
-                for (unsigned int k = 0; k < animationChannelCount; k++)
+                // If the target is one of the loaded nodes/joints, then load the animation.
+                std::map<std::string, Node*>::iterator iter = _trackedNodes->find(targetId);
+                if (iter != _trackedNodes->end())
                 {
-                    // Read target id.
-                    std::string targetId = readString(_stream);
-                    if (targetId.empty())
+                    // Read target attribute.
+                    unsigned int targetAttribute;
+                    if (!read(&targetAttribute))
                     {
-                        GP_ERROR("Failed to read target id for animation '%s'.", id.c_str());
+                        GP_ERROR("Failed to read target attribute for animation '%s'.", id.c_str());
                         SAFE_DELETE(_trackedNodes);
                         return NULL;
                     }
 
-                    // If the target is one of the loaded nodes/joints, then load the animation.
-                    std::map<std::string, Node*>::iterator iter = _trackedNodes->find(targetId);
-                    if (iter != _trackedNodes->end())
+                    AnimationTarget* target = iter->second;
+                    if (!target)
                     {
-                        // Read target attribute.
-                        unsigned int targetAttribute;
-                        if (!read(&targetAttribute))
-                        {
-                            GP_ERROR("Failed to read target attribute for animation '%s'.", id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
-
-                        AnimationTarget* target = iter->second;
-                        if (!target)
-                        {
-                            GP_ERROR("Failed to read %s for %s: %s", "animation target", targetId.c_str(), id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
-
-                        animation = readAnimationChannelData(animation, id.c_str(), target, targetAttribute);
+                        GP_ERROR("Failed to read %s for %s: %s", "animation target", targetId.c_str(), id.c_str());
+                        SAFE_DELETE(_trackedNodes);
+                        return NULL;
                     }
-                    else
-                    {
-                        // Skip over the target attribute.
-                        unsigned int data;
-                        if (!read(&data))
-                        {
-                            GP_ERROR("Failed to skip over target attribute for animation '%s'.", id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
 
-                        // Skip the animation channel (passing a target attribute of
-                        // 0 causes the animation to not be created).
-                        readAnimationChannelData(NULL, id.c_str(), NULL, 0);
+                    animation = readAnimationChannelData(animation, id.c_str(), target, targetAttribute);
+                }
+                else
+                {
+                    // Skip over the target attribute.
+                    unsigned int data;
+                    if (!read(&data))
+                    {
+                        GP_ERROR("Failed to skip over target attribute for animation '%s'.", id.c_str());
+                        SAFE_DELETE(_trackedNodes);
+                        return NULL;
                     }
+
+                    // Skip the animation channel (passing a target attribute of
+                    // 0 causes the animation to not be created).
+                    readAnimationChannelData(NULL, id.c_str(), NULL, 0);
                 }
             }
         }
@@ -1291,6 +1342,24 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
+    // In bundle version 1.6 we introduced storing animation channels compressed
+    if (getVersionMajor() >= BUNDLE_VERSION_MAJOR_ANIMATION_ENCODING && getVersionMinor() >= BUNDLE_VERSION_MINOR_ANIMATION_ENCODING)
+    {
+        unsigned int encoding;
+        if (!read(&encoding))
+        {
+            GP_ERROR("Failed to read the encoding for animation '%s'.", id);
+            return NULL;
+        }
+        if (encoding == BUNDLE_ANIMATION_ENCODING_COMPRESSED)
+            return readCompressedAnimationChannelData(animation, id, target, targetAttribute);
+        if (encoding != BUNDLE_ANIMATION_ENCODING_KEYS)
+        {
+            GP_ERROR("Unsupported encoding (%d) for animation '%s'.", encoding, id);
+            return NULL;
+        }
+    }
+
     std::vector<unsigned int> keyTimes;
     std::vector<float> values;
     std::vector<float> tangentsIn;
@@ -1357,6 +1426,72 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     return animation;
 }
 
+Animation* Bundle::readCompressedAnimationChannelData(Animation* animation, const char* id, AnimationTarget* target, unsigned int targetAttribute)
+{
+    GP_ASSERT(id);
+
+    unsigned int keyCount;
+    unsigned int duration;
+    unsigned int componentCount;
+    unsigned int quaternionOffset;
+    if (!read(&keyCount) || !read(&duration) || !read(&componentCount) || !read(&quaternionOffset))
+    {
+        GP_ERROR("Failed to read the compressed curve header for animation '%s'.", id);
+        return NULL;
+    }
+
+    // The times are only stored when the keys are not evenly spaced.
+    std::vector<float> times;
+    std::vector<float> minimums;
+    std::vector<float> extents;
+    std::vector<unsigned short> values;
+    unsigned int timesCount;
+    unsigned int minimumsCount;
+    unsigned int extentsCount;
+    unsigned int valuesCount;
+    if (!readArray(&timesCount, &times) || !readArray(&minimumsCount, &minimums) || !readArray(&extentsCount, &extents) ||
+        !readArray(&valuesCount, &values, sizeof(unsigned short)))
+    {
+        GP_ERROR("Failed to read the compressed curve for animation '%s'.", id);
+        return NULL;
+    }
+
+    if (targetAttribute > 0)
+    {
+        GP_ASSERT(target);
+        if (keyCount < 2 || componentCount == 0 || (timesCount != 0 && timesCount != keyCount) ||
+            minimumsCount != componentCount || extentsCount != componentCount ||
+            (quaternionOffset != BUNDLE_ANIMATION_NO_ROTATION && quaternionOffset + 4 > componentCount))
+        {
+            GP_ERROR("Invalid compressed curve for animation '%s'.", id);
+            return NULL;
+        }
+
+        Curve* curve = Curve::createCompressed(keyCount, componentCount, quaternionOffset == BUNDLE_ANIMATION_NO_ROTATION ? -1 : (int)quaternionOffset,
+            timesCount > 0 ? &times[0] : NULL, &minimums[0], &extents[0], valuesCount > 0 ? &values[0] : NULL, valuesCount);
+        if (curve == NULL)
+        {
+            GP_ERROR("Invalid compressed curve values for animation '%s'.", id);
+            return NULL;
+        }
+
+        if (animation == NULL)
+        {
+            animation = new Animation(id);
+            animation->createChannel(target, targetAttribute, curve, duration);
+            // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
+            animation->release();
+        }
+        else
+        {
+            animation->createChannel(target, targetAttribute, curve, duration);
+        }
+        curve->release();
+    }
+
+    return animation;
+}
+
 Mesh* Bundle::loadMesh(const char* id)
 {
     return loadMesh(id, NULL);
@@ -1383,8 +1518,9 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
-    // Read mesh data.
-    MeshData* meshData = readMeshData();
+    // Read mesh data, borrowing the vertex and index data from the stream
+    // since it is uploaded below while the bundle is still open.
+    MeshData* meshData = readMeshData(true);
     if (meshData == NULL)
     {
         GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
@@ -1396,7 +1532,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     if (mesh == NULL)
     {
         GP_ERROR("Failed to create mesh '%s'.", id);
-        SAFE_DELETE_ARRAY(meshData);
+        SAFE_DELETE(meshData);
         return NULL;
     }
 
@@ -1437,7 +1573,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     return mesh;
 }
 
-Bundle::MeshData* Bundle::readMeshData()
+Bundle::MeshData* Bundle::readMeshData(bool borrowData)
 {
     // Read vertex format/elements.
     unsigned int vertexElementCount;
@@ -1493,12 +1629,21 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    const void* borrowed = borrowData ? _stream->borrow(vertexByteCount) : NULL;
+    if (borrowed)
     {
-        GP_ERROR("Failed to load vertex data.");
-        SAFE_DELETE(meshData);
-        return NULL;
+        meshData->vertexData = (unsigned char*)borrowed;
+        meshData->vertexDataBorrowed = true;
+    }
+    else
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
     }
 
     // Read mesh bounds (bounding box and bounding sphere).
@@ -1572,12 +1717,21 @@ Bundle::MeshData* Bundle::readMeshData()
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        borrowed = borrowData ? _stream->borrow(iByteCount) : NULL;
+        if (borrowed)
         {
-            GP_ERROR("Failed to read index data for mesh part with index %d.", i);
-            SAFE_DELETE(meshData);
-            return NULL;
+            partData->indexData = (unsigned char*)borrowed;
+            partData->indexDataBorrowed = true;
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
         }
     }
 
@@ -1794,8 +1948,26 @@ Font* Bundle::loadFont(const char* id)
             }
         }
 
+        // Bitmap fonts are drawn from the default texture atlas when their glyphs fit in it, so that
+        // text is batched with the themes of forms. Distance field fonts need the font shader.
+        SpriteBatch* batch = NULL;
+        Texture* texture = NULL;
+        TextureAtlas* atlas = (format == Font::BITMAP) ? TextureAtlas::getDefault() : NULL;
+        if (atlas)
+        {
+            char atlasId[16];
+            sprintf(atlasId, "@%u", size);
+            batch = atlas->createSpriteBatch((_path + "#" + id + atlasId).c_str(), Texture::ALPHA, width, height, textureData);
+            if (batch)
+            {
+                texture = batch->getSampler()->getTexture();
+                texture->addRef();
+            }
+        }
+
         // Create the texture for the font.
-        Texture* texture = Texture::create(Texture::ALPHA, width, height, textureData, true);
+        if (texture == NULL)
+            texture = Texture::create(Texture::ALPHA, width, height, textureData, true);
 
         // Free the texture data (no longer needed).
         SAFE_DELETE_ARRAY(textureData);
@@ -1808,7 +1980,7 @@ Font* Bundle::loadFont(const char* id)
         }
 
         // Create the font for this size
-        Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture, (Font::Format)format);
+        Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture, (Font::Format)format, batch);
 
         // Free the glyph array.
         SAFE_DELETE_ARRAY(glyphs);
@@ -1871,23 +2043,29 @@ Bundle::Reference::~Reference()
 }
 
 Bundle::MeshPartData::MeshPartData() :
-		primitiveType(Mesh::TRIANGLES), indexFormat(Mesh::INDEX32), indexCount(0), indexData(NULL)
+		primitiveType(Mesh::TRIANGLES), indexFormat(Mesh::INDEX32), indexCount(0), indexData(NULL), indexDataBorrowed(false)
 {
 }
 
 Bundle::MeshPartData::~MeshPartData()
 {
-    SAFE_DELETE_ARRAY(indexData);
+    if (!indexDataBorrowed)
+    {
+        SAFE_DELETE_ARRAY(indexData);
+    }
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES), vertexDataBorrowed(false)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
-    SAFE_DELETE_ARRAY(vertexData);
+    if (!vertexDataBorrowed)
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+    }
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
@@ -18,6 +18,8 @@ class Bundle : public Ref
 {
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AssetLoader;
+    friend class OcclusionCuller;
 
 public:
 
@@ -150,6 +152,7 @@ private:
         Mesh::IndexFormat indexFormat;
         unsigned int indexCount;
         unsigned char* indexData;
+        bool indexDataBorrowed;
     };
 
     struct MeshData
@@ -164,6 +167,7 @@ private:
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
         std::vector<MeshPartData*> parts;
+        bool vertexDataBorrowed;
     };
 
     Bundle(const char* path);
@@ -178,6 +182,30 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Opens the bundle at the given path and reads its reference table, without
+     * searching or adding to the bundle cache.
+     *
+     * This does not touch any shared state, so it may be called from a worker thread.
+     *
+     * @param path The path of the bundle to open.
+     *
+     * @return The new bundle, or NULL if the bundle could not be opened.
+     */
+    static Bundle* open(const char* path);
+
+    /**
+     * Adds a bundle returned by open() to the bundle cache.
+     *
+     * If a bundle with the same path was cached in the meantime, the given bundle is
+     * released and the cached one is returned with its reference count incremented.
+     *
+     * @param bundle The bundle to add to the cache.
+     *
+     * @return The cached bundle.
+     */
+    static Bundle* addToCache(Bundle* bundle);
+
     /**
      * Finds a reference by ID.
      */
@@ -365,8 +393,12 @@ private:
 
     /**
      * Reads mesh data from the current file position.
+     *
+     * @param borrowData true to point the vertex and index data directly into the bundle's
+     *        stream where it supports borrowing (see Stream::borrow), instead of copying it.
+     *        Borrowed data is only valid while the bundle stays open.
      */
-    MeshData* readMeshData();
+    MeshData* readMeshData(bool borrowData = false);
 
     /**
      * Reads mesh data for the specified URL.
@@ -428,6 +460,18 @@ private:
      */
     Animation* readAnimationChannelData(Animation* animation, const char* id, AnimationTarget* target, unsigned int targetAttribute);
 
+    /**
+     * Reads the data of an animation channel that is stored as a compressed curve.
+     *
+     * @param animation The animation to the load channel into.
+     * @param id The ID of the animation that this channel is loaded into.
+     * @param target The animation target.
+     * @param targetAttribute The target attribute being animated.
+     *
+     * @return The animation that the channel was loaded into.
+     */
+    Animation* readCompressedAnimationChannelData(Animation* animation, const char* id, AnimationTarget* target, unsigned int targetAttribute);
+
     /**
      * Sets the transformation matrix.
      *
@@ -450,11 +494,20 @@ private:
      */
     bool skipNode();
 
+    /**
+     * Builds the hash indices over the reference table, so that references can be looked
+     * up by id or offset in constant time.
+     */
+    void buildReferenceIndex();
+
     unsigned char _version[2];
     std::string _path;
     std::string _materialPath;
     unsigned int _referenceCount;
     Reference* _references;
+    std::unordered_map<std::string, Reference*> _referencesById;
+    std::unordered_map<unsigned int, const char*> _idsByOffset;
+    std::vector<Reference*> _animationReferences;
     Stream* _stream;
 
     std::vector<MeshSkinData*> _meshSkins;
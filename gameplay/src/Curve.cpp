@@ -30,6 +30,18 @@ using std::strcmp;
 #define MATH_PIX2 6.28318530717958647693f
 #endif
 
+// Largest range of a component that is considered constant when compressing a curve
+#define CURVE_CONSTANT_EPSILON 1.0e-6f
+
+// Largest distance from an evenly spaced time that a point may have in a compressed curve without storing its time
+#define CURVE_TIME_EPSILON 1.0e-6f
+
+// Largest quantized value of a component, and of a component of a rotation without its sign bit
+#define CURVE_QUANTIZED_MAX 65535.0f
+#define CURVE_QUATERNION_QUANTIZED_MAX 32767.0f
+
+#define CURVE_SQRT2 1.41421356237309504880f
+
 // Object deletion macro
 #ifndef SAFE_DELETE
 #define SAFE_DELETE(x) \
@@ -75,6 +87,55 @@ static inline float hermiteSmooth(float h00, float h01, float h10, float h11, fl
     return h00 * from + h01 * to + h10 * out + h11 * in;
 }
 
+/**
+ * Stores a unit quaternion as its three smallest components, quantized to 15 bits. The largest component
+ * is recovered from the unit length, made positive by negating the quaternion if needed, and its index
+ * is stored in the top bits of the first two values.
+ */
+static void packQuaternion(const float* q, unsigned short* dst)
+{
+    float length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    float scale = length > 0.0f ? 1.0f / length : 1.0f;
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; i++)
+    {
+        if (fabs(q[i]) > fabs(q[largest]))
+            largest = i;
+    }
+    if (q[largest] < 0.0f)
+        scale = -scale;
+
+    // The smallest components lie within +-1/sqrt(2).
+    for (unsigned int i = 0, j = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+        float v = (q[i] * scale * CURVE_SQRT2 * 0.5f + 0.5f) * CURVE_QUATERNION_QUANTIZED_MAX + 0.5f;
+        dst[j++] = (unsigned short)(v < 0.0f ? 0.0f : (v > CURVE_QUATERNION_QUANTIZED_MAX ? CURVE_QUATERNION_QUANTIZED_MAX : v));
+    }
+    dst[0] |= (unsigned short)((largest & 1) << 15);
+    dst[1] |= (unsigned short)((largest >> 1) << 15);
+}
+
+/**
+ * Restores a quaternion stored by packQuaternion.
+ */
+static void unpackQuaternion(const unsigned short* src, float* q)
+{
+    unsigned int largest = (src[0] >> 15) | ((src[1] >> 15) << 1);
+    float sum = 0.0f;
+    for (unsigned int i = 0, j = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+        float v = ((src[j++] & 0x7FFF) * (1.0f / CURVE_QUATERNION_QUANTIZED_MAX) - 0.5f) * CURVE_SQRT2;
+        q[i] = v;
+        sum += v * v;
+    }
+    q[largest] = sum < 1.0f ? sqrt(1.0f - sum) : 0.0f;
+}
+
 static inline float lerpInl(float s, float from, float to)
 {
     return from + (to - from) * s;
@@ -88,8 +149,14 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
     return new Curve(pointCount, componentCount);
 }
 
+Curve::Curve()
+    : _pointCount(0), _componentCount(0), _componentSize(0), _quaternionOffset(NULL), _points(NULL), _compressed(NULL)
+{
+}
+
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _compressed(NULL)
 {
     _points = new Point[_pointCount];
     for (unsigned int i = 0; i < _pointCount; i++)
@@ -106,9 +173,24 @@ Curve::Curve(unsigned int pointCount, unsigned int componentCount)
 Curve::~Curve()
 {
     SAFE_DELETE_ARRAY(_points);
+    SAFE_DELETE(_compressed);
     SAFE_DELETE_ARRAY(_quaternionOffset);
 }
 
+Curve::CompressedPoints::CompressedPoints()
+    : times(NULL), minimums(NULL), scales(NULL), slots(NULL), stride(0), values(NULL)
+{
+}
+
+Curve::CompressedPoints::~CompressedPoints()
+{
+    SAFE_DELETE_ARRAY(times);
+    SAFE_DELETE_ARRAY(minimums);
+    SAFE_DELETE_ARRAY(scales);
+    SAFE_DELETE_ARRAY(slots);
+    SAFE_DELETE_ARRAY(values);
+}
+
 Curve::Point::Point()
     : time(0.0f), value(NULL), inValue(NULL), outValue(NULL), type(LINEAR)
 {
@@ -133,17 +215,25 @@ unsigned int Curve::getComponentCount() const
 
 float Curve::getStartTime() const
 {
-    return _points[0].time;
+    return getPointTime(0);
 }
 
 float Curve::getEndTime() const
 {
-    return _points[_pointCount-1].time;
+    return getPointTime(_pointCount-1);
 }
 
 float Curve::getPointTime(unsigned int index) const
 {
     assert(index < _pointCount);
+
+    if (_compressed)
+    {
+        if (_compressed->times)
+            return _compressed->times[index];
+        return index == _pointCount - 1 ? 1.0f : (float)index / (float)(_pointCount - 1);
+    }
+
     return _points[index].time;
 }
 
@@ -151,12 +241,24 @@ float Curve::getPointTime(unsigned int index) const
 Curve::InterpolationType Curve::getPointInterpolation(unsigned int index) const
 {
     assert(index < _pointCount);
-    return _points[index].type;;
+    return _compressed ? LINEAR : _points[index].type;
 }
 
 void Curve::getPointValues(unsigned int index, float* value, float* inValue, float* outValue) const
 {
     assert(index < _pointCount);
+
+    if (_compressed)
+    {
+        // Linear points have no tangents, so the value is returned for them too.
+        if (value)
+            interpolateCompressed(0.0f, index, index, value);
+        if (inValue)
+            interpolateCompressed(0.0f, index, index, inValue);
+        if (outValue)
+            interpolateCompressed(0.0f, index, index, outValue);
+        return;
+    }
     
     if (value)
         memcpy(value, _points[index].value, _componentSize);
@@ -176,6 +278,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type, float* inValue, float* outValue)
 {
     assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
+    assert(!_compressed);
 
     _points[index].time = time;
     _points[index].type = type;
@@ -192,7 +295,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
 void Curve::setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount);
+    assert(index < _pointCount && !_compressed);
 
     _points[index].type = type;
 
@@ -211,9 +314,20 @@ void Curve::evaluate(float time, float* dst) const
 }
 
 void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const
+{
+    evaluate(time, startTime, endTime, loopBlendTime, dst, NULL);
+}
+
+void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const
 {
     assert(dst && startTime >= 0.0f && startTime <= endTime && endTime <= 1.0f && loopBlendTime >= 0.0f);
 
+    if (_compressed)
+    {
+        evaluateCompressed(time, startTime, endTime, loopBlendTime, dst, cursor);
+        return;
+    }
+
     // If there's only one point on the curve, return its value.
     if (_pointCount == 1)
     {
@@ -283,8 +397,8 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     }
     else
     {
-        // Locate the points we are interpolating between using a binary search.
-        index = determineIndex(localTime, min, max);
+        // Locate the points we are interpolating between, starting at the cursor.
+        index = determineIndex(localTime, min, max, cursor);
         from = &_points[index];
         to = &_points[index == max ? index : index+1];
 
@@ -835,7 +949,7 @@ float Curve::lerp(float t, float from, float to)
 
 void Curve::setQuaternionOffset(unsigned int offset)
 {
-    assert(offset <= (_componentCount - 4));
+    assert(offset <= (_componentCount - 4) && !_compressed);
 
     if (!_quaternionOffset)
         _quaternionOffset = new unsigned int[1];
@@ -1247,10 +1361,58 @@ void Curve::interpolateQuaternion(float s, float* from, float* to, float* dst) c
         Quaternion::slerp(to[0], to[1], to[2], to[3], from[0], from[1], from[2], from[3], s, dst, dst + 1, dst + 2, dst + 3);
 }
 
+unsigned int Curve::determineIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const
+{
+    if (cursor == NULL)
+        return determineIndex(time, min, max);
+
+    // Playback usually stays between the same points or moves on to the next ones.
+    unsigned int index = *cursor;
+    if (index >= min && index < max && time >= getPointTime(index))
+    {
+        if (time < getPointTime(index + 1))
+            return index;
+        if (index + 1 < max && time < getPointTime(index + 2))
+        {
+            *cursor = index + 1;
+            return index + 1;
+        }
+    }
+
+    index = determineIndex(time, min, max);
+    *cursor = index;
+    return index;
+}
+
 int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
 {
     unsigned int mid;
 
+    if (_compressed)
+    {
+        const float* times = _compressed->times;
+        if (times == NULL)
+        {
+            // The points are evenly spaced, so the index follows from the time.
+            unsigned int index = time > 0.0f ? (unsigned int)(time * (float)(_pointCount - 1)) : 0;
+            return index < min ? min : (index > max ? max : index);
+        }
+
+        do
+        {
+            mid = (min + max) >> 1;
+
+            if (time >= times[mid] && time < times[mid + 1])
+                return mid;
+            else if (time < times[mid])
+                max = mid - 1;
+            else
+                min = mid + 1;
+        } while (min <= max);
+
+        return max;
+    }
+
     // Do a binary search to determine the index.
     do 
     {
@@ -1267,6 +1429,262 @@ int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
     return max;
 }
 
+bool Curve::compress()
+{
+    if (_compressed)
+        return true;
+    if (_pointCount < 2)
+        return false;
+    for (unsigned int i = 0; i < _pointCount; i++)
+    {
+        if (_points[i].type != LINEAR)
+            return false;
+    }
+
+    // Only store the times if the points are not evenly spaced.
+    float* times = NULL;
+    for (unsigned int i = 0; i < _pointCount; i++)
+    {
+        if (fabs(_points[i].time - (float)i / (float)(_pointCount - 1)) > CURVE_TIME_EPSILON)
+        {
+            times = new float[_pointCount];
+            for (unsigned int j = 0; j < _pointCount; j++)
+            {
+                times[j] = _points[j].time;
+            }
+            break;
+        }
+    }
+
+    // Find the range of each component.
+    unsigned int quaternionOffset = _quaternionOffset ? *_quaternionOffset : _componentCount;
+    float* minimums = new float[_componentCount];
+    float* extents = new float[_componentCount];
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        float minimum = _points[0].value[i];
+        float maximum = minimum;
+        for (unsigned int j = 1; j < _pointCount; j++)
+        {
+            float v = _points[j].value[i];
+            minimum = v < minimum ? v : minimum;
+            maximum = v > maximum ? v : maximum;
+        }
+        minimums[i] = minimum;
+        extents[i] = maximum - minimum > CURVE_CONSTANT_EPSILON ? maximum - minimum : 0.0f;
+    }
+    if (_quaternionOffset)
+    {
+        // The rotation is stored whole if it never changes, and packed otherwise.
+        bool animated = false;
+        for (unsigned int i = quaternionOffset; i < quaternionOffset + 4; i++)
+        {
+            animated |= extents[i] != 0.0f;
+            minimums[i] = _points[0].value[i];
+            extents[i] = 0.0f;
+        }
+        extents[quaternionOffset] = animated ? 1.0f : 0.0f;
+    }
+
+    Point* points = _points;
+    _points = NULL;
+    setCompressedPoints(times, minimums, extents);
+
+    // Quantize the points into their rows.
+    CompressedPoints* compressed = _compressed;
+    if (compressed->stride > 0)
+    {
+        compressed->values = new unsigned short[_pointCount * compressed->stride];
+        for (unsigned int i = 0; i < _pointCount; i++)
+        {
+            unsigned short* row = compressed->values + i * compressed->stride;
+            const float* value = points[i].value;
+            for (unsigned int j = 0; j < _componentCount; j++)
+            {
+                int slot = compressed->slots[j];
+                if (slot < 0 || j == quaternionOffset)
+                    continue;
+                float q = (value[j] - minimums[j]) / extents[j] * CURVE_QUANTIZED_MAX + 0.5f;
+                row[slot] = (unsigned short)(q < 0.0f ? 0.0f : (q > CURVE_QUANTIZED_MAX ? CURVE_QUANTIZED_MAX : q));
+            }
+            if (quaternionOffset < _componentCount && compressed->slots[quaternionOffset] >= 0)
+            {
+                packQuaternion(value + quaternionOffset, row + compressed->slots[quaternionOffset]);
+            }
+        }
+    }
+
+    SAFE_DELETE_ARRAY(points);
+    SAFE_DELETE_ARRAY(minimums);
+    SAFE_DELETE_ARRAY(extents);
+
+    return true;
+}
+
+bool Curve::isCompressed() const
+{
+    return _compressed != NULL;
+}
+
+Curve* Curve::createCompressed(unsigned int pointCount, unsigned int componentCount, int quaternionOffset, const float* times,
+                               const float* minimums, const float* extents, const unsigned short* values, unsigned int valueCount)
+{
+    assert(pointCount > 1 && componentCount > 0 && minimums && extents);
+
+    Curve* curve = new Curve();
+    curve->_pointCount = pointCount;
+    curve->_componentCount = componentCount;
+    curve->_componentSize = sizeof(float) * componentCount;
+    if (quaternionOffset >= 0)
+        curve->setQuaternionOffset((unsigned int)quaternionOffset);
+
+    float* timesCopy = NULL;
+    if (times)
+    {
+        timesCopy = new float[pointCount];
+        memcpy(timesCopy, times, sizeof(float) * pointCount);
+    }
+    curve->setCompressedPoints(timesCopy, minimums, extents);
+
+    CompressedPoints* compressed = curve->_compressed;
+    if (compressed->stride * pointCount != valueCount)
+    {
+        curve->release();
+        return NULL;
+    }
+    if (valueCount > 0)
+    {
+        assert(values);
+        compressed->values = new unsigned short[valueCount];
+        memcpy(compressed->values, values, sizeof(unsigned short) * valueCount);
+    }
+
+    return curve;
+}
+
+void Curve::setCompressedPoints(float* times, const float* minimums, const float* extents)
+{
+    CompressedPoints* compressed = new CompressedPoints();
+    compressed->times = times;
+    compressed->minimums = new float[_componentCount];
+    compressed->scales = new float[_componentCount];
+    compressed->slots = new int[_componentCount];
+    memcpy(compressed->minimums, minimums, _componentSize);
+
+    // The packed rotation leads the row if it is animated, followed by the animated scalar components.
+    unsigned int quaternionOffset = _quaternionOffset ? *_quaternionOffset : _componentCount;
+    unsigned int stride = 0;
+    if (_quaternionOffset && extents[quaternionOffset] != 0.0f)
+        stride = 3;
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        compressed->scales[i] = extents[i] / CURVE_QUANTIZED_MAX;
+        if (i >= quaternionOffset && i < quaternionOffset + 4)
+            compressed->slots[i] = (i == quaternionOffset && stride > 0) ? 0 : -1;
+        else
+            compressed->slots[i] = extents[i] != 0.0f ? (int)stride++ : -1;
+    }
+    compressed->stride = stride;
+
+    SAFE_DELETE(_compressed);
+    _compressed = compressed;
+}
+
+void Curve::evaluateCompressed(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const
+{
+    unsigned int min = 0;
+    unsigned int max = _pointCount - 1;
+    float localTime = time;
+    if (startTime > 0.0f || endTime < 1.0f)
+    {
+        // Evaluating a sub section of the curve
+        min = determineIndex(startTime, 0, max);
+        max = determineIndex(endTime, min, max);
+
+        // Convert time to fall within the subregion
+        localTime = getPointTime(min) + (getPointTime(max) - getPointTime(min)) * time;
+    }
+
+    float minTime = getPointTime(min);
+    float maxTime = getPointTime(max);
+    if (loopBlendTime == 0.0f)
+    {
+        // If no loop blend time is specified, clamp time to end points
+        if (localTime < minTime)
+            localTime = minTime;
+        else if (localTime > maxTime)
+            localTime = maxTime;
+    }
+
+    // If an exact endpoint was specified, skip interpolation and return the value directly
+    if (localTime == minTime)
+    {
+        interpolateCompressed(0.0f, min, min, dst);
+        return;
+    }
+    if (localTime == maxTime)
+    {
+        interpolateCompressed(0.0f, max, max, dst);
+        return;
+    }
+
+    unsigned int from;
+    unsigned int to;
+    float t;
+    if (localTime > maxTime)
+    {
+        // Looping forward
+        from = max;
+        to = min;
+        t = (localTime - maxTime) / loopBlendTime;
+    }
+    else if (localTime < minTime)
+    {
+        // Looping in reverse
+        from = min;
+        to = max;
+        t = (minTime - localTime) / loopBlendTime;
+    }
+    else
+    {
+        from = determineIndex(localTime, min, max, cursor);
+        to = from == max ? from : from + 1;
+        float fromTime = getPointTime(from);
+        float toTime = getPointTime(to);
+        t = toTime > fromTime ? (localTime - fromTime) / (toTime - fromTime) : 0.0f;
+    }
+
+    interpolateCompressed(t, from, to, dst);
+}
+
+void Curve::interpolateCompressed(float s, unsigned int from, unsigned int to, float* dst) const
+{
+    const CompressedPoints* compressed = _compressed;
+    const unsigned short* fromRow = compressed->values + from * compressed->stride;
+    const unsigned short* toRow = compressed->values + to * compressed->stride;
+
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        int slot = compressed->slots[i];
+        if (slot < 0)
+            dst[i] = compressed->minimums[i];
+        else if (fromRow[slot] == toRow[slot])
+            dst[i] = compressed->minimums[i] + fromRow[slot] * compressed->scales[i];
+        else
+            dst[i] = compressed->minimums[i] + lerpInl(s, (float)fromRow[slot], (float)toRow[slot]) * compressed->scales[i];
+    }
+
+    // Handle the packed rotation, which the loop above wrote its first slot for.
+    if (_quaternionOffset && compressed->slots[*_quaternionOffset] >= 0)
+    {
+        float fromRotation[4];
+        float toRotation[4];
+        unpackQuaternion(fromRow + compressed->slots[*_quaternionOffset], fromRotation);
+        unpackQuaternion(toRow + compressed->slots[*_quaternionOffset], toRotation);
+        interpolateQuaternion(s, fromRotation, toRotation, dst + *_quaternionOffset);
+    }
+}
+
 int Curve::getInterpolationType(const char* curveId)
 {
     if (strcmp(curveId, "BEZIER") == 0)
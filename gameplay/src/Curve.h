@@ -16,6 +16,7 @@ class Curve : public Ref
     friend class AnimationClip;
     friend class AnimationController;
     friend class MeshSkin;
+    friend class Bundle;
 
 public:
 
@@ -414,11 +415,55 @@ public:
      */
     void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const;
 
+    /**
+     * Evaluates the curve at the given position value over a sub section of the curve,
+     * starting the search for the surrounding points at a key cursor.
+     *
+     * The cursor holds the index of the point found by the previous evaluation and is
+     * updated with the point found by this one. When the curve is evaluated at increasing
+     * times, as it is during playback, the points are found in constant time instead of
+     * with a binary search. A cursor should be initialized to zero and used for one curve.
+     *
+     * @param time The position within the subregion of the curve to evaluate the curve at.
+     * @param startTime Start time for the subregion (between 0.0 - 1.0).
+     * @param endTime End time for the subregion (between 0.0 - 1.0).
+     * @param loopBlendTime Time (in milliseconds) to blend between the end points of the curve
+     *      for looping purposes when time is outside the range 0-1. A value of zero here
+     *      disables curve looping.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param cursor The key cursor of the curve.
+     * @script{ignore}
+     */
+    void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const;
+
     /**
      * Linear interpolation function.
      */
     static float lerp(float t, float from, float to);
 
+    /**
+     * Compresses the points of the curve to reduce its memory use.
+     *
+     * The values of each component are quantized to 16 bits over the range they span, and
+     * rotations are stored as their three smallest components. Components that never change
+     * are stored once, and the times of evenly spaced points are not stored. The curve is then
+     * evaluated from the compressed points, with a small loss of precision.
+     *
+     * Only curves with more than one point, which all use LINEAR interpolation, can be compressed.
+     * The points of a compressed curve can no longer be set.
+     *
+     * @return true if the curve is compressed, false if it cannot be compressed.
+     */
+    bool compress();
+
+    /**
+     * Determines if the points of the curve are compressed.
+     *
+     * @return true if the curve is compressed, false otherwise.
+     * @see compress()
+     */
+    bool isCompressed() const;
+
 private:
 
     /**
@@ -455,6 +500,46 @@ private:
         Point& operator=(const Point&);
     };
 
+    /**
+     * Defines the quantized points of a compressed curve.
+     *
+     * The values of a point are stored as a row of 16-bit values, which starts with the three
+     * smallest components of the rotation if the curve has an animated rotation. A component
+     * is decoded as its minimum plus its quantized value multiplied by its scale.
+     */
+    class CompressedPoints
+    {
+    public:
+
+        /** The times of the points, or NULL if the points are evenly spaced in time. */
+        float* times;
+        /** The minimum of each component, or its value if the component is constant. */
+        float* minimums;
+        /** The size of a quantization step of each component. */
+        float* scales;
+        /** The index of each component in the row of a point, or -1 if it is not stored in the row. */
+        int* slots;
+        /** The number of values in the row of each point. */
+        unsigned int stride;
+        /** The rows of quantized values of the points. */
+        unsigned short* values;
+
+        /**
+         * Constructor.
+         */
+        CompressedPoints();
+
+        /**
+         * Destructor.
+         */
+        ~CompressedPoints();
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        CompressedPoints& operator=(const CompressedPoints&);
+    };
+
     /**
      * Constructor.
      */
@@ -523,6 +608,45 @@ private:
      */
     int determineIndex(float time, unsigned int min, unsigned int max) const;
 
+    /**
+     * Determines the current keyframe to interpolate from, checking the point at the cursor
+     * and the one after it before searching the curve. The cursor may be NULL.
+     */
+    unsigned int determineIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const;
+
+    /**
+     * Creates a compressed curve from quantized points, such as those written by the encoder.
+     *
+     * @param pointCount The number of points.
+     * @param componentCount The number of components of each point.
+     * @param quaternionOffset The offset of the rotation in the components, or -1 if there is none.
+     * @param times The times of the points, or NULL if they are evenly spaced.
+     * @param minimums The minimum of each component, or the rotation if it is constant.
+     * @param extents The range of each component, with zero for constant components. Only the
+     *      first component of the rotation is used, which is non-zero if the rotation is animated.
+     * @param values The rows of quantized values of the points.
+     * @param valueCount The number of quantized values.
+     *
+     * @return The new curve, or NULL if the number of values does not match the layout.
+     */
+    static Curve* createCompressed(unsigned int pointCount, unsigned int componentCount, int quaternionOffset, const float* times,
+                                   const float* minimums, const float* extents, const unsigned short* values, unsigned int valueCount);
+
+    /**
+     * Replaces the points of the curve with compressed points with the given ranges, whose rows are left to be filled.
+     */
+    void setCompressedPoints(float* times, const float* minimums, const float* extents);
+
+    /**
+     * Evaluates a compressed curve.
+     */
+    void evaluateCompressed(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const;
+
+    /**
+     * Linearly interpolates between two compressed points.
+     */
+    void interpolateCompressed(float s, unsigned int from, unsigned int to, float* dst) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -545,7 +669,8 @@ private:
     unsigned int _componentCount;       // Number of components on the curve.
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
-    Point* _points;                     // The points on the curve.
+    Point* _points;                     // The points on the curve, or NULL if they are compressed.
+    CompressedPoints* _compressed;      // The compressed points on the curve.
 };
 
 }
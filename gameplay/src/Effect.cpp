@@ -5,6 +5,10 @@
 
 #define OPENGL_ES_DEFINE  "OPENGL_ES"
 
+// Program cache file extension and version.
+#define EFFECT_CACHE_EXTENSION ".gpsc"
+#define EFFECT_CACHE_VERSION 1
+
 namespace gameplay
 {
 
@@ -12,6 +16,16 @@ namespace gameplay
 static std::map<std::string, Effect*> __effectCache;
 static Effect* __currentEffect = NULL;
 
+// Include-expanded shader sources by path, shared by all of the permutations of a shader.
+static std::map<std::string, std::string> __expandedSourceCache;
+
+// Directory of the program cache, with a trailing '/'. Empty if the cache is disabled.
+static std::string __cachePath;
+
+static const char __cacheSignature[9] = { '\xAB', 'G', 'P', 'S', '\xBB', '\r', '\n', '\x1A', '\n' };
+
+static const std::string* getExpandedSource(const char* path);
+
 Effect::Effect() : _program(0)
 {
 }
@@ -64,25 +78,21 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
         return itr->second;
     }
 
-    // Read source from file.
-    char* vshSource = FileSystem::readAll(vshPath);
+    // Read source from file, with its includes expanded.
+    const std::string* vshSource = getExpandedSource(vshPath);
     if (vshSource == NULL)
     {
         GP_ERROR("Failed to read vertex shader from file '%s'.", vshPath);
         return NULL;
     }
-    char* fshSource = FileSystem::readAll(fshPath);
+    const std::string* fshSource = getExpandedSource(fshPath);
     if (fshSource == NULL)
     {
         GP_ERROR("Failed to read fragment shader from file '%s'.", fshPath);
-        SAFE_DELETE_ARRAY(vshSource);
         return NULL;
     }
 
-    Effect* effect = createFromSource(vshPath, vshSource, fshPath, fshSource, defines);
-    
-    SAFE_DELETE_ARRAY(vshSource);
-    SAFE_DELETE_ARRAY(fshSource);
+    Effect* effect = createFromSource(vshPath, vshSource->c_str(), fshPath, fshSource->c_str(), defines);
 
     if (effect == NULL)
     {
@@ -215,6 +225,177 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
     }
 }
 
+/**
+ * Gets the source of a shader file with its includes expanded, reading and expanding it on first use.
+ */
+static const std::string* getExpandedSource(const char* path)
+{
+    std::map<std::string, std::string>::const_iterator itr = __expandedSourceCache.find(path);
+    if (itr != __expandedSourceCache.end())
+        return &itr->second;
+
+    char* source = FileSystem::readAll(path);
+    if (source == NULL)
+        return NULL;
+
+    // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+    std::string& expanded = __expandedSourceCache[path];
+    replaceIncludes(path, source, expanded);
+    if (strlen(source) != 0)
+        expanded += "\n";
+    SAFE_DELETE_ARRAY(source);
+
+    return &expanded;
+}
+
+/**
+ * Computes the 64-bit FNV-1a hash of the given data, continuing from the given hash.
+ */
+static unsigned long long hashData(const void* data, size_t size, unsigned long long hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool isProgramCacheEnabled()
+{
+#ifdef GP_USE_PROGRAM_BINARY
+    // The entry points are only loaded when the driver supports GL 4.1 or ARB_get_program_binary.
+    return !__cachePath.empty() && glGetProgramBinary != NULL && glProgramBinary != NULL && glProgramParameteri != NULL;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Computes the cache key of a program from its full source and the graphics driver,
+ * since program binaries are only valid for the driver that created them.
+ */
+static unsigned long long getProgramCacheKey(const std::string& defines, const char* vshSource, const char* fshSource)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    const GLenum driverStrings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const char* str = (const char*)glGetString(driverStrings[i]);
+        if (str)
+            hash = hashData(str, strlen(str) + 1, hash);
+    }
+    hash = hashData(defines.c_str(), defines.length() + 1, hash);
+    hash = hashData(vshSource, strlen(vshSource) + 1, hash);
+    hash = hashData(fshSource, strlen(fshSource) + 1, hash);
+    return hash;
+}
+
+static std::string getProgramCachePath(unsigned long long key)
+{
+    char name[17];
+    sprintf(name, "%08x%08x", (unsigned int)(key >> 32), (unsigned int)key);
+    std::string path = __cachePath;
+    path += name;
+    path += EFFECT_CACHE_EXTENSION;
+    return path;
+}
+
+/**
+ * Loads a linked program from the program cache. Returns zero if it is not cached or fails to load.
+ */
+static GLuint loadCachedProgram(unsigned long long key)
+{
+    GLuint program = 0;
+#ifdef GP_USE_PROGRAM_BINARY
+    std::string path = getProgramCachePath(key);
+    if (!FileSystem::fileExists(path.c_str()))
+        return 0;
+    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::READ | FileSystem::MEMORY_MAPPED));
+    if (stream.get() == NULL)
+        return 0;
+
+    char sig[9];
+    unsigned char version;
+    unsigned long long cachedKey;
+    unsigned int header[2];
+    if (stream->read(sig, 1, 9) != 9 || memcmp(sig, __cacheSignature, 9) != 0 ||
+        stream->read(&version, 1, 1) != 1 || version != EFFECT_CACHE_VERSION ||
+        stream->read(&cachedKey, 8, 1) != 1 || cachedKey != key ||
+        stream->read(header, 4, 2) != 2)
+    {
+        GP_WARN("Ignoring invalid program cache file '%s'.", path.c_str());
+        return 0;
+    }
+
+    // The binary is read in place from a memory mapped file where possible.
+    GLenum format = header[0];
+    GLsizei length = (GLsizei)header[1];
+    std::vector<unsigned char> data;
+    const void* binary = stream->borrow(length);
+    if (binary == NULL)
+    {
+        data.resize(length);
+        if (length == 0 || stream->read(&data[0], 1, length) != (size_t)length)
+        {
+            GP_WARN("Ignoring invalid program cache file '%s'.", path.c_str());
+            return 0;
+        }
+        binary = &data[0];
+    }
+
+    GLint success;
+    GL_ASSERT( program = glCreateProgram() );
+    GL_ASSERT( glProgramBinary(program, format, binary, length) );
+    GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+    if (success != GL_TRUE)
+    {
+        // Binaries may be rejected after a driver update, in which case the program is compiled again.
+        GL_ASSERT( glDeleteProgram(program) );
+        program = 0;
+    }
+#endif
+    return program;
+}
+
+/**
+ * Saves a linked program to the program cache.
+ */
+static void saveCachedProgram(GLuint program, unsigned long long key)
+{
+#ifdef GP_USE_PROGRAM_BINARY
+    GLint length = 0;
+    GL_ASSERT( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (length <= 0)
+        return;
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    GL_ASSERT( glGetProgramBinary(program, length, &length, &format, &binary[0]) );
+
+    std::string path = getProgramCachePath(key);
+    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to create program cache file '%s'.", path.c_str());
+        return;
+    }
+
+    unsigned char version = EFFECT_CACHE_VERSION;
+    unsigned int header[2] = { (unsigned int)format, (unsigned int)length };
+    bool result = stream->write(__cacheSignature, 1, 9) == 9 &&
+                  stream->write(&version, 1, 1) == 1 &&
+                  stream->write(&key, 8, 1) == 1 &&
+                  stream->write(header, 4, 2) == 2 &&
+                  stream->write(&binary[0], 1, length) == (size_t)length;
+    stream->close();
+
+    if (!result)
+        GP_WARN("Failed to write program cache file '%s'.", path.c_str());
+#endif
+}
+
 static void writeShaderToErrorFile(const char* filePath, const char* source)
 {
     std::string path = filePath;
@@ -226,11 +407,11 @@ static void writeShaderToErrorFile(const char* filePath, const char* source)
     }
 }
 
-Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+/**
+ * Compiles and links a program from shader sources whose includes have already been expanded.
+ */
+static GLuint compileProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const std::string& definesStr, bool retrievable)
 {
-    GP_ASSERT(vshSource);
-    GP_ASSERT(fshSource);
-
     const unsigned int SHADER_SOURCE_LENGTH = 3;
     const GLchar* shaderSource[SHADER_SOURCE_LENGTH];
     char* infoLog = NULL;
@@ -240,21 +421,9 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GLint length;
     GLint success;
 
-    // Replace all comma separated definitions with #define prefix and \n suffix
-    std::string definesStr = "";
-    replaceDefines(defines, definesStr);
-    
     shaderSource[0] = definesStr.c_str();
     shaderSource[1] = "\n";
-    std::string vshSourceStr = "";
-    if (vshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(vshPath, vshSource, vshSourceStr);
-        if (vshSource && strlen(vshSource) != 0)
-            vshSourceStr += "\n";
-    }
-    shaderSource[2] = vshPath ? vshSourceStr.c_str() :  vshSource;
+    shaderSource[2] = vshSource;
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
@@ -283,19 +452,11 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Compile the fragment shader.
-    std::string fshSourceStr;
-    if (fshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshPath, fshSource, fshSourceStr);
-        if (fshSource && strlen(fshSource) != 0)
-            fshSourceStr += "\n";
-    }
-    shaderSource[2] = fshPath ? fshSourceStr.c_str() : fshSource;
+    shaderSource[2] = fshSource;
     GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
     GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(fragmentShader) );
@@ -325,13 +486,19 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         GL_ASSERT( glDeleteShader(vertexShader) );
         GL_ASSERT( glDeleteShader(fragmentShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Link program.
     GL_ASSERT( program = glCreateProgram() );
     GL_ASSERT( glAttachShader(program, vertexShader) );
     GL_ASSERT( glAttachShader(program, fragmentShader) );
+#ifdef GP_USE_PROGRAM_BINARY
+    if (retrievable)
+    {
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+    }
+#endif
     GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
@@ -359,10 +526,42 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteProgram(program) );
 
-        return NULL;
+        return 0;
+    }
+
+    return program;
+}
+
+Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+{
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    // Replace all comma separated definitions with #define prefix and \n suffix
+    std::string definesStr = "";
+    replaceDefines(defines, definesStr);
+
+    // Load the linked program from the cache, or compile and link it.
+    bool cached = isProgramCacheEnabled();
+    unsigned long long cacheKey = 0;
+    GLuint program = 0;
+    if (cached)
+    {
+        cacheKey = getProgramCacheKey(definesStr, vshSource, fshSource);
+        program = loadCachedProgram(cacheKey);
+    }
+    if (program == 0)
+    {
+        program = compileProgram(vshPath, vshSource, fshPath, fshSource, definesStr, cached);
+        if (program == 0)
+            return NULL;
+
+        if (cached)
+            saveCachedProgram(program, cacheKey);
     }
 
     // Create and return the new Effect.
+    GLint length;
     Effect* effect = new Effect();
     effect->_program = program;
 
@@ -498,6 +697,11 @@ Uniform* Effect::getUniform(const char* name) const
 				uniform->_type = puniform->getType();
 				_uniforms[name] = uniform;
 
+				// The element and its array share storage in the program, so neither can be shadowed.
+				uniform->_shadowed = false;
+				puniform->_shadowed = false;
+				puniform->_value.clear();
+
 				SAFE_DELETE_ARRAY(parentname);
 				return uniform;
 			}
@@ -530,79 +734,115 @@ unsigned int Effect::getUniformCount() const
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(float)))
+    {
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(float) * count))
+    {
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(int)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(int) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->updateValue(value.m, sizeof(float) * 16))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 16 * count))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 2))
+    {
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 2 * count))
+    {
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 3))
+    {
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 3 * count))
+    {
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 4))
+    {
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 4 * count))
+    {
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -618,7 +858,12 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<Texture::Sampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    // The texture unit of a sampler uniform never changes, so it is only uploaded once.
+    GLint unit = uniform->_index;
+    if (uniform->updateValue(&unit, sizeof(GLint)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, unit) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
@@ -642,7 +887,10 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
     }
 
     // Pass texture unit array to GL
-    GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    if (uniform->updateValue(units, sizeof(GLint) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    }
 }
 
 void Effect::bind()
@@ -657,8 +905,30 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+void Effect::setCachePath(const char* path)
+{
+    __cachePath = path ? path : "";
+    if (!__cachePath.empty() && __cachePath[__cachePath.length() - 1] != '/')
+        __cachePath += '/';
+}
+
+const char* Effect::getCachePath()
+{
+    return __cachePath.empty() ? NULL : __cachePath.c_str();
+}
+
+bool Effect::isCacheEnabled()
+{
+    return isProgramCacheEnabled();
+}
+
+void Effect::finalize()
+{
+    __expandedSourceCache.clear();
+}
+
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0), _effect(NULL)
+    _location(-1), _type(0), _index(0), _effect(NULL), _shadowed(true), _parameterVersion(0)
 {
 }
 
@@ -682,4 +952,20 @@ const GLenum Uniform::getType() const
     return _type;
 }
 
+bool Uniform::updateValue(const void* value, size_t size)
+{
+    // The value no longer necessarily comes from the material parameter that last set it.
+    _parameterVersion = 0;
+
+    if (!_shadowed)
+        return true;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(value);
+    if (_value.size() == size && (size == 0 || memcmp(&_value[0], bytes, size) == 0))
+        return false;
+
+    _value.assign(bytes, bytes + size);
+    return true;
+}
+
 }
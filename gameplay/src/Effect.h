@@ -19,12 +19,24 @@ class Uniform;
  * An effect essentially wraps an OpenGL program object, which includes the
  * vertex and fragment shader.
  *
+ * The effect keeps a shadow copy of the value last uploaded to each of its
+ * uniforms, since uniform values are stored per program object. Setting a
+ * uniform to the value the program already holds does not reach the driver.
+ *
+ * Effects created from files share the include-expanded source of each shader
+ * file, so that the permutations of a shader only read and expand it once. When
+ * a cache path is set, linked programs are also cached on disk as driver
+ * program binaries, keyed by a hash of their full source, defines and driver.
+ * This avoids compiling and linking on later runs.
+ *
  * In the future, this class may be extended to support additional logic that
  * typical effect systems support, such as GPU render state management,
  * techniques and passes.
  */
 class Effect: public Ref
 {
+    friend class Game;
+
 public:
 
     /**
@@ -49,6 +61,37 @@ public:
      */
     static Effect* createFromSource(const char* vshSource, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Sets the directory in which linked shader programs are cached.
+     *
+     * The directory must already exist and be writable. Programs are only cached on devices
+     * that support retrieving program binaries; elsewhere this has no effect. A cached
+     * program is recompiled if its sources, defines or the graphics driver have changed.
+     *
+     * The cache path may also be set with 'shaderCachePath' in the 'graphics' config namespace.
+     *
+     * @param path The directory to cache programs in, or NULL to disable the cache.
+     * @script{ignore}
+     */
+    static void setCachePath(const char* path);
+
+    /**
+     * Gets the directory in which linked shader programs are cached.
+     *
+     * @return The cache directory, or NULL if the cache is disabled.
+     * @script{ignore}
+     */
+    static const char* getCachePath();
+
+    /**
+     * Checks whether linked shader programs are cached, which requires a cache path
+     * and a device that supports retrieving program binaries.
+     *
+     * @return true if programs are cached, false otherwise.
+     * @script{ignore}
+     */
+    static bool isCacheEnabled();
+
     /**
      * Returns the unique string identifier for the effect, which is a concatenation of
      * the shader paths it was loaded from.
@@ -239,6 +282,15 @@ private:
      */
     Effect& operator=(const Effect&);
 
+    /**
+     * Static finalizer that is called during game shutdown.
+     */
+    static void finalize();
+
+    /**
+     * Creates an effect from shader sources whose includes have already been expanded.
+     * The paths are only used to report errors.
+     */
     static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
 
     GLuint _program;
@@ -254,6 +306,7 @@ private:
 class Uniform
 {
     friend class Effect;
+    friend class MaterialParameter;
 
 public:
 
@@ -300,11 +353,24 @@ private:
      */
     Uniform& operator=(const Uniform&);
 
+    /**
+     * Updates the shadow copy of the uniform value.
+     *
+     * @param value The value being set.
+     * @param size The size of the value in bytes.
+     *
+     * @return true if the value differs from the one last uploaded and must be uploaded, false otherwise.
+     */
+    bool updateValue(const void* value, size_t size);
+
     std::string _name;
     GLint _location;
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    std::vector<unsigned char> _value;
+    bool _shadowed;
+    unsigned long long _parameterVersion;
 };
 
 }
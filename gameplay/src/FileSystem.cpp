@@ -18,6 +18,9 @@
     #define __EXT_POSIX2
     #include <libgen.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -145,6 +148,50 @@ private:
     bool _canWrite;
 };
 
+#ifndef __ANDROID__
+
+/**
+ * A read-only stream over a file that is mapped into memory.
+ *
+ * @script{ignore}
+ */
+class MappedFileStream : public Stream
+{
+public:
+    friend class FileSystem;
+
+    ~MappedFileStream();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const void* borrow(size_t size);
+
+    static MappedFileStream* create(const char* filePath);
+
+private:
+    MappedFileStream(const unsigned char* data, size_t length);
+
+private:
+    const unsigned char* _data;
+    size_t _length;
+    size_t _position;
+#ifdef WIN32
+    HANDLE _file;
+    HANDLE _mapping;
+#endif
+};
+
+#endif
+
 #ifdef __ANDROID__
 
 /**
@@ -363,6 +410,31 @@ bool FileSystem::fileExists(const char* filePath)
 
 }
 
+bool FileSystem::renameFile(const char* oldPath, const char* newPath)
+{
+    GP_ASSERT(oldPath);
+    GP_ASSERT(newPath);
+
+    std::string oldFullPath;
+    std::string newFullPath;
+    getFullPath(oldPath, oldFullPath);
+    getFullPath(newPath, newFullPath);
+#ifdef WIN32
+    return MoveFileExA(oldFullPath.c_str(), newFullPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(oldFullPath.c_str(), newFullPath.c_str()) == 0;
+#endif
+}
+
+bool FileSystem::removeFile(const char* filePath)
+{
+    GP_ASSERT(filePath);
+
+    std::string fullPath;
+    getFullPath(filePath, fullPath);
+    return remove(fullPath.c_str()) == 0;
+}
+
 Stream* FileSystem::open(const char* path, size_t streamMode)
 {
     char modeStr[] = "rb";
@@ -404,6 +476,13 @@ Stream* FileSystem::open(const char* path, size_t streamMode)
 #else
     std::string fullPath;
     getFullPath(path, fullPath);
+    if ((streamMode & MEMORY_MAPPED) != 0 && (streamMode & WRITE) == 0)
+    {
+        // Fall back to a regular file stream if the file cannot be mapped (i.e. it is empty).
+        Stream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -717,6 +796,199 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+#ifndef __ANDROID__
+
+MappedFileStream::MappedFileStream(const unsigned char* data, size_t length)
+    : _data(data), _length(length), _position(0)
+#ifdef WIN32
+    , _file(INVALID_HANDLE_VALUE), _mapping(NULL)
+#endif
+{
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    close();
+}
+
+MappedFileStream* MappedFileStream::create(const char* filePath)
+{
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > (size_t)-1)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (data == NULL)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    MappedFileStream* stream = new MappedFileStream((const unsigned char*)data, (size_t)size.QuadPart);
+    stream->_file = file;
+    stream->_mapping = mapping;
+    return stream;
+#else
+    int file = ::open(filePath, O_RDONLY);
+    if (file == -1)
+        return NULL;
+
+    gp_stat_struct s;
+    if (fstat(file, &s) != 0 || s.st_size <= 0)
+    {
+        ::close(file);
+        return NULL;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    void* data = mmap(NULL, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    return new MappedFileStream((const unsigned char*)data, (size_t)s.st_size);
+#endif
+}
+
+bool MappedFileStream::canRead()
+{
+    return _data != NULL;
+}
+
+bool MappedFileStream::canWrite()
+{
+    return false;
+}
+
+bool MappedFileStream::canSeek()
+{
+    return _data != NULL;
+}
+
+void MappedFileStream::close()
+{
+    if (_data)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+        _mapping = NULL;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        munmap((void*)_data, _length);
+#endif
+    }
+    _data = NULL;
+    _length = 0;
+    _position = 0;
+}
+
+size_t MappedFileStream::read(void* ptr, size_t size, size_t count)
+{
+    if (!_data || size == 0)
+        return 0;
+
+    // Only whole elements are read, matching fread().
+    size_t available = (_length - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* MappedFileStream::readLine(char* str, int num)
+{
+    if (!_data || num <= 0 || _position >= _length)
+        return NULL;
+
+    // Read up to num - 1 characters, stopping after a newline, matching fgets().
+    int i = 0;
+    while (i < num - 1 && _position < _length)
+    {
+        char c = (char)_data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t MappedFileStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool MappedFileStream::eof()
+{
+    return !_data || _position >= _length;
+}
+
+size_t MappedFileStream::length()
+{
+    return _length;
+}
+
+long int MappedFileStream::position()
+{
+    if (!_data)
+        return -1;
+    return (long int)_position;
+}
+
+bool MappedFileStream::seek(long int offset, int origin)
+{
+    if (!_data)
+        return false;
+
+    long int base = 0;
+    if (origin == SEEK_CUR)
+        base = (long int)_position;
+    else if (origin == SEEK_END)
+        base = (long int)_length;
+    else if (origin != SEEK_SET)
+        return false;
+
+    long int position = base + offset;
+    if (position < 0 || (size_t)position > _length)
+        return false;
+    _position = (size_t)position;
+    return true;
+}
+
+bool MappedFileStream::rewind()
+{
+    if (!_data)
+        return false;
+    _position = 0;
+    return true;
+}
+
+const void* MappedFileStream::borrow(size_t size)
+{
+    if (!_data || size > _length - _position)
+        return NULL;
+
+    const void* ptr = _data + _position;
+    _position += size;
+    return ptr;
+}
+
+#endif
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
@@ -24,7 +24,8 @@ public:
     enum StreamMode
     {
         READ = 1,
-        WRITE = 2
+        WRITE = 2,
+        MEMORY_MAPPED = 4
     };
 
     /**
@@ -146,12 +147,39 @@ public:
      */
     static bool fileExists(const char* filePath);
 
+    /**
+     * Renames a file, replacing any file that already exists at the new path.
+     *
+     * Paths are relative to the currently set resource path, unless they are absolute.
+     *
+     * @param oldPath The path of the file to rename.
+     * @param newPath The new path of the file.
+     *
+     * @return <code>true</code> if the file was renamed; <code>false</code> otherwise.
+     * @script{ignore}
+     */
+    static bool renameFile(const char* oldPath, const char* newPath);
+
+    /**
+     * Deletes a file.
+     *
+     * @param filePath The path of the file, relative to the currently set resource path, unless it is absolute.
+     *
+     * @return <code>true</code> if the file was deleted; <code>false</code> otherwise.
+     * @script{ignore}
+     */
+    static bool removeFile(const char* filePath);
+
     /**
      * Opens a byte stream for the given resource path.
      *
      * If <code>path</code> is a file path, the file at the specified location is opened relative to the currently set
      * resource path.
      *
+     * If <code>streamMode</code> includes MEMORY_MAPPED (along with READ), the file is mapped into memory
+     * where supported, which allows data to be borrowed from the stream without copying (see Stream::borrow).
+     * Otherwise a regular file stream is returned.
+     *
      * @param path The path to the resource to be opened, relative to the currently set resource path.
      * @param streamMode The stream mode used to open the file.
      * 
@@ -10,6 +10,13 @@
 #define FONT_VSH "res/shaders/font.vert"
 #define FONT_FSH "res/shaders/font.frag"
 
+// Number of bits of a code point that index a page of the glyph table
+#define FONT_GLYPH_PAGE_BITS 8
+#define FONT_GLYPH_PAGE_SIZE (1 << FONT_GLYPH_PAGE_BITS)
+
+// Largest number of text layouts cached by a font before the cache is cleared
+#define FONT_LAYOUT_CACHE_SIZE 256
+
 namespace gameplay
 {
 
@@ -17,6 +24,78 @@ static std::vector<Font*> __fontCache;
 
 static Effect* __fontEffect = NULL;
 
+/**
+ * Determines if a byte continues a UTF-8 sequence, rather than starting a character.
+ */
+static inline bool isUTF8Continuation(char c)
+{
+    return ((unsigned char)c & 0xC0) == 0x80;
+}
+
+/**
+ * Decodes the character whose UTF-8 sequence starts at the given byte, setting the length of
+ * the sequence. Bytes that do not start a valid sequence decode to themselves.
+ */
+static unsigned int decodeUTF8(const char* text, unsigned int* length = NULL)
+{
+    const unsigned char* s = (const unsigned char*)text;
+    unsigned int codepoint = s[0];
+    unsigned int count = 0;
+    if (codepoint >= 0xF8)
+        count = 0;
+    else if (codepoint >= 0xF0)
+        count = 3;
+    else if (codepoint >= 0xE0)
+        count = 2;
+    else if (codepoint >= 0xC0)
+        count = 1;
+
+    if (count > 0)
+    {
+        unsigned int decoded = codepoint & (0x3F >> count);
+        unsigned int i = 1;
+        for (; i <= count && isUTF8Continuation(text[i]); ++i)
+        {
+            decoded = (decoded << 6) | (s[i] & 0x3F);
+        }
+        if (i > count)
+        {
+            if (length)
+                *length = count + 1;
+            return decoded;
+        }
+    }
+
+    if (length)
+        *length = 1;
+    return codepoint;
+}
+
+/**
+ * Hashes the string and parameters of a text layout.
+ */
+static unsigned int hashLayout(const char* text, unsigned int size, const Rectangle& area, unsigned int justify, bool wrap, bool rightToLeft)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)text; *c; ++c)
+    {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    const unsigned int values[] = { size, justify, (unsigned int)wrap | ((unsigned int)rightToLeft << 1) };
+    const unsigned char* bytes = (const unsigned char*)values;
+    for (size_t i = 0; i < sizeof(values); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    bytes = (const unsigned char*)&area;
+    for (size_t i = 0; i < sizeof(Rectangle); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
 Font::Font() :
     _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
 {
@@ -31,6 +110,12 @@ Font::~Font()
         __fontCache.erase(itr);
     }
 
+    clearLayouts();
+    for (size_t i = 0, count = _glyphPages.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_glyphPages[i]);
+    }
+
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
@@ -98,41 +183,44 @@ Font* Font::create(const char* path, const char* id)
     return font;
 }
 
-Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format)
+Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format, SpriteBatch* batch)
 {
     GP_ASSERT(family);
     GP_ASSERT(glyphs);
     GP_ASSERT(texture);
 
-    // Create the effect for the font's sprite batch.
-    if (__fontEffect == NULL)
+    if (batch == NULL)
     {
-        const char* defines = NULL;
-        if (format == DISTANCE_FIELD)
-            defines = "DISTANCE_FIELD";
-        __fontEffect = Effect::createFromFile(FONT_VSH, FONT_FSH, defines);
+        // Create the effect for the font's sprite batch.
         if (__fontEffect == NULL)
         {
-            GP_WARN("Failed to create effect for font.");
-            SAFE_RELEASE(texture);
-            return NULL;
+            const char* defines = NULL;
+            if (format == DISTANCE_FIELD)
+                defines = "DISTANCE_FIELD";
+            __fontEffect = Effect::createFromFile(FONT_VSH, FONT_FSH, defines);
+            if (__fontEffect == NULL)
+            {
+                GP_WARN("Failed to create effect for font.");
+                SAFE_RELEASE(texture);
+                return NULL;
+            }
+        }
+        else
+        {
+            __fontEffect->addRef();
         }
-    }
-    else
-    {
-        __fontEffect->addRef();
-    }
 
-    // Create batch for the font.
-    SpriteBatch* batch = SpriteBatch::create(texture, __fontEffect, 128);
+        // Create batch for the font.
+        batch = SpriteBatch::create(texture, __fontEffect, 128);
 
-    // Release __fontEffect since the SpriteBatch keeps a reference to it
-    SAFE_RELEASE(__fontEffect);
+        // Release __fontEffect since the SpriteBatch keeps a reference to it
+        SAFE_RELEASE(__fontEffect);
 
-    if (batch == NULL)
-    {
-        GP_WARN("Failed to create batch for font.");
-        return NULL;
+        if (batch == NULL)
+        {
+            GP_WARN("Failed to create batch for font.");
+            return NULL;
+        }
     }
 
     // Add linear filtering for better font quality.
@@ -156,6 +244,20 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
     font->_glyphCount = glyphCount;
 
+    // Map the code points of the glyphs to their indices, in pages that only exist for the ranges the font covers.
+    for (int i = 0; i < glyphCount; ++i)
+    {
+        unsigned int page = glyphs[i].code >> FONT_GLYPH_PAGE_BITS;
+        if (page >= font->_glyphPages.size())
+            font->_glyphPages.resize(page + 1, NULL);
+        if (font->_glyphPages[page] == NULL)
+        {
+            font->_glyphPages[page] = new int[FONT_GLYPH_PAGE_SIZE];
+            std::fill(font->_glyphPages[page], font->_glyphPages[page] + FONT_GLYPH_PAGE_SIZE, -1);
+        }
+        font->_glyphPages[page][glyphs[i].code & (FONT_GLYPH_PAGE_SIZE - 1)] = i;
+    }
+
     return font;
 }
 
@@ -179,9 +281,46 @@ Font::Format Font::getFormat()
 
 bool Font::isCharacterSupported(int character) const
 {
-    // TODO: Update this once we support unicode fonts
-    int glyphIndex = character - 32; // HACK for ASCII
-    return (glyphIndex >= 0 && glyphIndex < (int)_glyphCount);
+    return character >= 0 && getGlyph((unsigned int)character) != NULL;
+}
+
+const Font::Glyph* Font::getGlyph(unsigned int codepoint) const
+{
+    unsigned int page = codepoint >> FONT_GLYPH_PAGE_BITS;
+    if (page >= _glyphPages.size() || _glyphPages[page] == NULL)
+        return NULL;
+
+    int index = _glyphPages[page][codepoint & (FONT_GLYPH_PAGE_SIZE - 1)];
+    return index >= 0 ? &_glyphs[index] : NULL;
+}
+
+unsigned int Font::encodeUTF8(unsigned int codepoint, char* out)
+{
+    GP_ASSERT(out);
+
+    if (codepoint < 0x80)
+    {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800)
+    {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | ((codepoint >> 18) & 0x07));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
 }
 
 void Font::start()
@@ -356,10 +495,13 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                 xPos += _glyphs[0].advance * 4;
                 break;
             default:
-                int index = c - 32; // HACK for ASCII
-                if (index >= 0 && index < (int)_glyphCount)
+                // Characters are drawn from the first byte of their UTF-8 sequence.
+                if (isUTF8Continuation(c))
+                    break;
+                const Glyph* glyph = getGlyph(decodeUTF8(rightToLeft ? &cursor[i] : &text[i]));
+                if (glyph)
                 {
-                    Glyph& g = _glyphs[index];
+                    const Glyph& g = *glyph;
 
                     if (getFormat() == DISTANCE_FIELD )
                     {
@@ -412,8 +554,93 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         }
     }
 
+    const TextLayout* layout = getLayout(text, area, size, justify, wrap, rightToLeft);
+    if (layout->quads.empty())
+        return;
+
     lazyStart();
 
+    GP_ASSERT(_batch);
+    if (getFormat() == DISTANCE_FIELD)
+    {
+        if (_cutoffParam == NULL)
+            _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
+        // TODO: Fix me so that smaller font are much smoother
+        _cutoffParam->setVector2(Vector2(1.0, 1.0));
+    }
+
+    // Draw the glyphs the text was laid out into.
+    const bool clipped = clip != Rectangle(0, 0, 0, 0);
+    for (size_t i = 0, count = layout->quads.size(); i < count; ++i)
+    {
+        const GlyphQuad& quad = layout->quads[i];
+        const float* uvs = quad.glyph->uvs;
+        if (clipped)
+        {
+            _batch->draw(quad.x, quad.y, quad.width, size, uvs[0], uvs[1], uvs[2], uvs[3], color, clip);
+        }
+        else
+        {
+            _batch->draw(quad.x, quad.y, quad.width, size, uvs[0], uvs[1], uvs[2], uvs[3], color);
+        }
+    }
+}
+
+const Font::TextLayout* Font::getLayout(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+{
+    GP_ASSERT(text);
+
+    unsigned int hash = hashLayout(text, size, area, justify, wrap, rightToLeft);
+    std::unordered_map<unsigned int, TextLayout*>::iterator itr = _layouts.find(hash);
+    TextLayout* layout = NULL;
+    if (itr != _layouts.end())
+    {
+        layout = itr->second;
+        if (layout->size == size && layout->area == area && layout->justify == justify && layout->wrap == wrap &&
+            layout->rightToLeft == rightToLeft && layout->text == text)
+        {
+            return layout;
+        }
+
+        // Replace the layout of another string with the same hash.
+        layout->quads.clear();
+    }
+    else
+    {
+        // Start over once the cache is full, which keeps the layouts of the strings that are drawn every frame.
+        if (_layouts.size() >= FONT_LAYOUT_CACHE_SIZE)
+            clearLayouts();
+
+        layout = new TextLayout();
+        _layouts[hash] = layout;
+    }
+
+    layout->text = text;
+    layout->size = size;
+    layout->area = area;
+    layout->justify = justify;
+    layout->wrap = wrap;
+    layout->rightToLeft = rightToLeft;
+    layoutText(text, area, size, justify, wrap, rightToLeft, &layout->quads);
+
+    return layout;
+}
+
+void Font::clearLayouts()
+{
+    for (std::unordered_map<unsigned int, TextLayout*>::iterator itr = _layouts.begin(); itr != _layouts.end(); ++itr)
+    {
+        SAFE_DELETE(itr->second);
+    }
+    _layouts.clear();
+}
+
+void Font::layoutText(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                      std::vector<GlyphQuad>* quads)
+{
+    GP_ASSERT(text);
+    GP_ASSERT(quads);
+
     float scale = (float)size / _size;
     int spacing = (int)(size * _spacing);
     int yPos = area.y;
@@ -504,15 +731,16 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         }
 
         GP_ASSERT(_glyphs);
-        GP_ASSERT(_batch);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
+            // Characters are placed at the first byte of their UTF-8 sequence.
+            if (isUTF8Continuation(token[i]))
+                continue;
 
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(decodeUTF8(&token[i]));
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -520,27 +748,11 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
                     truncated = true;
                     break;
                 }
-                else if (xPos >= (int)area.x)
+                else if (xPos >= (int)area.x && draw)
                 {
-                    // Draw this character.
-                    if (draw)
-                    {
-                        if (getFormat() == DISTANCE_FIELD)
-                        {
-                            if (_cutoffParam == NULL)
-                                _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
-                            // TODO: Fix me so that smaller font are much smoother
-                            _cutoffParam->setVector2(Vector2(1.0, 1.0));
-                        }
-                        if (clip != Rectangle(0, 0, 0, 0))
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color, clip);
-                        }
-                        else
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
-                        }
-                    }
+                    // Place this character.
+                    GlyphQuad quad = { glyph, xPos + (int)(g.bearingX * scale), yPos, g.width * scale };
+                    quads->push_back(quad);
                 }
                 xPos += (int)(g.advance)*scale + spacing;
             }
@@ -1206,7 +1418,11 @@ float Font::getCharacterSpacing() const
 
 void Font::setCharacterSpacing(float spacing)
 {
-    _spacing = spacing;
+    if (spacing != _spacing)
+    {
+        _spacing = spacing;
+        clearLayouts();
+    }
 }
 
 int Font::getIndexAtLocation(const char* text, const Rectangle& area, unsigned int size, const Vector2& inLocation, Vector2* outLocation,
@@ -1356,12 +1572,15 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
         GP_ASSERT(_glyphs);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
+            // Characters are located at the first byte of their UTF-8 sequence.
+            if (isUTF8Continuation(token[i]))
+                continue;
 
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            unsigned int charLength;
+            const Glyph* glyph = getGlyph(decodeUTF8(&token[i], &charLength));
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -1384,7 +1603,7 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
                 }
 
                 xPos += floor(g.advance*scale + spacing);
-                charIndex++;
+                charIndex += charLength;
             }
         }
 
@@ -1492,11 +1711,12 @@ unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigne
             tokenWidth += _glyphs[0].advance * 4;
             break;
         default:
-            int glyphIndex = c - 32;
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            if (isUTF8Continuation(c))
+                break;
+            const Glyph* g = getGlyph(decodeUTF8(&token[i]));
+            if (g)
             {
-                Glyph& g = _glyphs[glyphIndex];
-                tokenWidth += floor(g.advance * scale + spacing);
+                tokenWidth += floor(g->advance * scale + spacing);
             }
             break;
         }
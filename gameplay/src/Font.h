@@ -8,6 +8,12 @@ namespace gameplay
 
 /**
  * Defines a font for text rendering.
+ *
+ * Text is encoded as UTF-8. Characters that the font has no glyph for are skipped.
+ *
+ * The glyphs that the text drawn within an area is laid out into are cached by the font,
+ * so that strings that are drawn unchanged every frame, such as the text of labels, are
+ * not measured and wrapped again.
  */
 class Font : public Ref
 {
@@ -101,7 +107,7 @@ public:
     /**
      * Determines if this font supports the specified character code.
      *
-     * @param character The character code to check.
+     * @param character The Unicode code point of the character to check.
      * @return True if this Font supports (can draw) the specified character, false otherwise.
      */
     bool isCharacterSupported(int character) const;
@@ -274,6 +280,31 @@ private:
         float uvs[4];
     };
 
+    /**
+     * A glyph positioned by the layout of a string.
+     */
+    struct GlyphQuad
+    {
+        const Glyph* glyph;
+        int x;
+        int y;
+        float width;
+    };
+
+    /**
+     * The glyphs of a string laid out within an area.
+     */
+    struct TextLayout
+    {
+        std::string text;
+        unsigned int size;
+        Rectangle area;
+        Justify justify;
+        bool wrap;
+        bool rightToLeft;
+        std::vector<GlyphQuad> quads;
+    };
+
     /**
      * Constructor.
      */
@@ -307,10 +338,38 @@ private:
      * @param glyphCount The number of items in the glyph array.
      * @param texture A texture map containing rendered glyphs.
      * @param format The format of the font (bitmap or distance fields)
+     * @param batch The sprite batch to draw the glyphs with, which the font takes ownership of,
+     *      or NULL to create one for the texture.
      *
      * @return The new Font or NULL if there was an error.
      */
-    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format);
+    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format, SpriteBatch* batch = NULL);
+
+    /**
+     * Gets the glyph of a character, or NULL if the font has no glyph for it.
+     */
+    const Glyph* getGlyph(unsigned int codepoint) const;
+
+    /**
+     * Gets the cached layout of a string within an area, laying it out if it is not cached.
+     */
+    const TextLayout* getLayout(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft);
+
+    /**
+     * Lays out the glyphs of a string within an area, positioning those that are drawn.
+     */
+    void layoutText(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                    std::vector<GlyphQuad>* quads);
+
+    /**
+     * Releases the cached text layouts.
+     */
+    void clearLayouts();
+
+    /**
+     * Encodes a character as UTF-8, returning the number of bytes written to 'out', which must hold four bytes.
+     */
+    static unsigned int encodeUTF8(unsigned int codepoint, char* out);
 
     void getMeasurementInfo(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
                             std::vector<int>* xPositions, int* yPosition, std::vector<unsigned int>* lineLengths);
@@ -343,6 +402,8 @@ private:
     float _spacing;
     Glyph* _glyphs;
     unsigned int _glyphCount;
+    std::vector<int*> _glyphPages;
+    std::unordered_map<unsigned int, TextLayout*> _layouts;
     Texture* _texture;
     SpriteBatch* _batch;
     Rectangle _viewport;
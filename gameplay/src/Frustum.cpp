@@ -2,6 +2,7 @@
 #include "Frustum.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -130,6 +131,69 @@ float Frustum::intersects(const Ray& ray) const
     return ray.intersects(*this);
 }
 
+bool Frustum::intersects(const BoundingBox& box, unsigned int* planeMask) const
+{
+    GP_ASSERT(planeMask);
+
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        unsigned int bit = 1u << i;
+        if ((*planeMask & bit) == 0)
+            continue;
+
+        float result = box.intersects(*planes[i]);
+        if (result == Plane::INTERSECTS_BACK)
+            return false;
+        if (result == Plane::INTERSECTS_FRONT)
+            *planeMask &= ~bit;
+    }
+    return true;
+}
+
+unsigned int Frustum::intersects(const BoundingSphere* spheres, unsigned int count, unsigned int* visibility, unsigned int planeMask, unsigned char* planeCache) const
+{
+    GP_ASSERT(spheres || count == 0);
+    GP_ASSERT(visibility || count == 0);
+    static_assert(sizeof(BoundingSphere) == 4 * sizeof(float), "Bounding spheres must be packed as (x, y, z, radius).");
+
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    if (count == 0)
+        return 0;
+
+    float planes[24];
+    getPlanes(planes);
+    return MathUtil::cullSpheres(planes, planeMask, &spheres[0].center.x, count, visibility, planeCache);
+}
+
+unsigned int Frustum::intersects(const BoundingBox* boxes, unsigned int count, unsigned int* visibility, unsigned int planeMask, unsigned char* planeCache) const
+{
+    GP_ASSERT(boxes || count == 0);
+    GP_ASSERT(visibility || count == 0);
+    static_assert(sizeof(BoundingBox) == 6 * sizeof(float), "Bounding boxes must be packed as (min, max).");
+
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    if (count == 0)
+        return 0;
+
+    float planes[24];
+    getPlanes(planes);
+    return MathUtil::cullBoxes(planes, planeMask, &boxes[0].min.x, count, visibility, planeCache);
+}
+
+void Frustum::getPlanes(float* dst) const
+{
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        const Vector3& normal = planes[i]->getNormal();
+        dst[i * 4] = normal.x;
+        dst[i * 4 + 1] = normal.y;
+        dst[i * 4 + 2] = normal.z;
+        dst[i * 4 + 3] = planes[i]->getDistance();
+    }
+}
+
 void Frustum::set(const Frustum& frustum)
 {
     _near = frustum._near;
@@ -171,6 +171,60 @@ public:
      */
     bool intersects(const BoundingBox& box) const;
 
+    /**
+     * Tests whether this frustum intersects the specified bounding box, only testing the given planes.
+     *
+     * This supports hierarchical culling: the planes that a parent volume is entirely in front of
+     * are removed from the mask, so the volumes it contains only need to be tested against the
+     * planes that remain. The volumes are entirely inside the frustum once the mask is zero.
+     *
+     * @param box The bounding box to test intersection with.
+     * @param planeMask The planes to test, as bits in the order near, far, left, right, bottom and top.
+     *  Set to the planes that the box intersects.
+     *
+     * @return true if the specified bounding box intersects this frustum; false otherwise.
+     * @script{ignore}
+     */
+    bool intersects(const BoundingBox& box, unsigned int* planeMask) const;
+
+    /**
+     * Tests an array of bounding spheres against this frustum.
+     *
+     * The spheres are tested four at a time using SSE or NEON instructions where available.
+     *
+     * If a plane cache is given, each sphere is first tested against the plane that rejected it
+     * on the previous call. Objects that are still outside are then usually rejected with a single
+     * test. The cache holds one plane index per sphere, initially zero, and is kept between calls.
+     *
+     * @param spheres The bounding spheres to test.
+     * @param count The number of bounding spheres.
+     * @param visibility The visibility mask to set, which must have (count + 31) / 32 elements.
+     *  Bit (i % 32) of element (i / 32) is set if sphere i intersects this frustum, and cleared otherwise.
+     * @param planeMask The planes to test, as bits in the order near, far, left, right, bottom and top.
+     * @param planeCache The plane cache with an element per sphere, or NULL.
+     *
+     * @return The number of spheres that intersect this frustum.
+     * @see intersects(const BoundingBox&, unsigned int*)
+     * @script{ignore}
+     */
+    unsigned int intersects(const BoundingSphere* spheres, unsigned int count, unsigned int* visibility, unsigned int planeMask = 0x3F, unsigned char* planeCache = NULL) const;
+
+    /**
+     * Tests an array of bounding boxes against this frustum.
+     *
+     * @param boxes The bounding boxes to test.
+     * @param count The number of bounding boxes.
+     * @param visibility The visibility mask to set, which must have (count + 31) / 32 elements.
+     *  Bit (i % 32) of element (i / 32) is set if box i intersects this frustum, and cleared otherwise.
+     * @param planeMask The planes to test, as bits in the order near, far, left, right, bottom and top.
+     * @param planeCache The plane cache with an element per box, or NULL.
+     *
+     * @return The number of boxes that intersect this frustum.
+     * @see intersects(const BoundingSphere*, unsigned int, unsigned int*, unsigned int, unsigned char*)
+     * @script{ignore}
+     */
+    unsigned int intersects(const BoundingBox* boxes, unsigned int count, unsigned int* visibility, unsigned int planeMask = 0x3F, unsigned char* planeCache = NULL) const;
+
     /**
      * Tests whether this frustum intersects the specified plane.
      *
@@ -214,6 +268,11 @@ private:
      */
     void updatePlanes();
 
+    /**
+     * Packs the planes as (nx, ny, nz, d) in the order near, far, left, right, bottom and top.
+     */
+    void getPlanes(float* dst) const;
+
     Plane _near;
     Plane _far;
     Plane _bottom;
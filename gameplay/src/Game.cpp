@@ -7,6 +7,7 @@
 #include "SceneLoader.h"
 #include "ControlFactory.h"
 #include "Theme.h"
+#include "TextureAtlas.h"
 #include "Form.h"
 
 /** @script{ignore} */
@@ -65,7 +66,8 @@ Game::Game()
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
       _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
-      _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL)
+      _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL),
+      _jobScheduler(NULL), _assetLoader(NULL), _overlapControllerUpdates(false)
 {
     GP_ASSERT(__gameInstance == NULL);
 
@@ -164,6 +166,30 @@ bool Game::startup()
     RenderState::initialize();
     FrameBuffer::initialize();
 
+    // Start the job scheduler first so that the other controllers may submit work to it.
+    int workerCount = -1;
+    if (_properties)
+    {
+        Properties* jobs = _properties->getNamespace("jobs", true);
+        if (jobs)
+        {
+            if (jobs->exists("workers"))
+                workerCount = jobs->getInt("workers");
+            _overlapControllerUpdates = jobs->getBool("overlapUpdates");
+        }
+    }
+    _jobScheduler = new JobScheduler();
+    _jobScheduler->initialize(workerCount);
+
+    _assetLoader = new AssetLoader();
+    _assetLoader->initialize(_jobScheduler);
+    if (_properties)
+    {
+        Properties* assets = _properties->getNamespace("assets", true);
+        if (assets && assets->exists("frameBudget"))
+            _assetLoader->setFrameBudget(assets->getFloat("frameBudget"));
+    }
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -269,10 +295,17 @@ void Game::shutdown()
         SAFE_DELETE(_physicsController);
         _aiController->finalize();
         SAFE_DELETE(_aiController);
+
+        _assetLoader->finalize();
+        SAFE_DELETE(_assetLoader);
+
+        _jobScheduler->finalize();
+        SAFE_DELETE(_jobScheduler);
         
         ControlFactory::finalize();
 
         Theme::finalize();
+        TextureAtlas::finalize();
 
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
@@ -281,6 +314,7 @@ void Game::shutdown()
 
         FrameBuffer::finalize();
         RenderState::finalize();
+        Effect::finalize();
 
         SAFE_DELETE(_properties);
 
@@ -374,6 +408,9 @@ void Game::frame()
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
 
+    // Finalize assets that finished loading in the background.
+    _assetLoader->update();
+
     if (_state == Game::RUNNING)
     {
         GP_ASSERT(_animationController);
@@ -385,14 +422,8 @@ void Game::frame()
         float elapsedTime = (frameTime - lastFrameTime);
         lastFrameTime = frameTime;
 
-        // Update the scheduled and running animations.
-        _animationController->update(elapsedTime);
-
-        // Update the physics.
-        _physicsController->update(elapsedTime);
-
-        // Update AI.
-        _aiController->update(elapsedTime);
+        // Update the scheduled and running animations, physics and AI.
+        updateControllers(elapsedTime);
 
         // Update gamepads.
         Gamepad::updateInternal(elapsedTime);
@@ -456,6 +487,29 @@ void Game::renderOnce(const char* function)
     Platform::swapBuffers();
 }
 
+void Game::updateControllers(float elapsedTime)
+{
+    if (_overlapControllerUpdates && _jobScheduler->getWorkerCount() > 0)
+    {
+        // Run AI on a worker while the animations are applied on this thread. Physics
+        // runs afterwards since both animations and AI may move physics objects.
+        AIController* aiController = _aiController;
+        JobScheduler::JobHandle aiJob = _jobScheduler->submit([aiController, elapsedTime]()
+        {
+            aiController->update(elapsedTime);
+        });
+        _animationController->update(elapsedTime);
+        _jobScheduler->wait(aiJob);
+        _physicsController->update(elapsedTime);
+    }
+    else
+    {
+        _animationController->update(elapsedTime);
+        _physicsController->update(elapsedTime);
+        _aiController->update(elapsedTime);
+    }
+}
+
 void Game::updateOnce()
 {
     GP_ASSERT(_animationController);
@@ -470,9 +524,7 @@ void Game::updateOnce()
     lastFrameTime = frameTime;
 
     // Update the internal controllers.
-    _animationController->update(elapsedTime);
-    _physicsController->update(elapsedTime);
-    _aiController->update(elapsedTime);
+    updateControllers(elapsedTime);
     _audioController->update(elapsedTime);
     if (_scriptTarget)
         _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, update), elapsedTime);
@@ -778,6 +830,20 @@ void Game::loadConfig()
             {
                 FileSystem::loadResourceAliases(aliases);
             }
+
+            // Compile properties files as they are loaded, if requested.
+            Properties* properties = _properties->getNamespace("properties", true);
+            if (properties)
+            {
+                Properties::setCompileOnLoad(properties->getBool("compile"));
+            }
+
+            // Cache linked shader programs on disk, if requested.
+            Properties* graphics = _properties->getNamespace("graphics", true);
+            if (graphics)
+            {
+                Effect::setCachePath(graphics->getString("shaderCachePath"));
+            }
         }
         else
         {
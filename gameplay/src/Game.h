@@ -10,6 +10,8 @@
 #include "AnimationController.h"
 #include "PhysicsController.h"
 #include "AIController.h"
+#include "JobScheduler.h"
+#include "AssetLoader.h"
 #include "AudioListener.h"
 #include "Rectangle.h"
 #include "Vector4.h"
@@ -269,6 +271,22 @@ public:
      */
     inline ScriptController* getScriptController() const;
 
+    /**
+     * Gets the job scheduler used to run work in parallel on worker threads.
+     *
+     * @return The job scheduler for this game.
+     * @script{ignore}
+     */
+    inline JobScheduler* getJobScheduler() const;
+
+    /**
+     * Gets the asset loader used to load assets in the background.
+     *
+     * @return The asset loader for this game.
+     * @script{ignore}
+     */
+    inline AssetLoader* getAssetLoader() const;
+
     /**
      * Gets the audio listener for 3D audio.
      * 
@@ -721,6 +739,17 @@ private:
      */
     void fireTimeEvents(double frameTime);
 
+    /**
+     * Updates the animation, physics and AI controllers.
+     *
+     * When enabled with 'overlapUpdates' in the 'jobs' config namespace, the AI controller is
+     * updated on a worker thread while the animation controller is updated on the main thread.
+     * This is only safe when AI state handlers do not run scripts or modify node transforms.
+     *
+     * @param elapsedTime The elapsed game time.
+     */
+    void updateControllers(float elapsedTime);
+
     /**
      * Loads the game configuration.
      */
@@ -766,6 +795,9 @@ private:
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;            // Controls the scripting engine.
     ScriptTarget* _scriptTarget;                // Script target for the game
+    JobScheduler* _jobScheduler;                // Runs jobs on a pool of worker threads.
+    AssetLoader* _assetLoader;                  // Loads assets in the background and finalizes them on the main thread.
+    bool _overlapControllerUpdates;             // Whether AI is updated on a worker concurrently with animations.
 
     // Note: Do not add STL object member variables on the stack; this will cause false memory leaks to be reported.
 
@@ -63,6 +63,16 @@ inline AIController* Game::getAIController() const
     return _aiController;
 }
 
+inline JobScheduler* Game::getJobScheduler() const
+{
+    return _jobScheduler;
+}
+
+inline AssetLoader* Game::getAssetLoader() const
+{
+    return _assetLoader;
+}
+
 template <class T>
 void Game::renderOnce(T* instance, void (T::*method)(void*), void* cookie)
 {
@@ -0,0 +1,315 @@
+#include "Base.h"
+#include "JobScheduler.h"
+
+namespace gameplay
+{
+
+// The scheduler that owns the calling thread, and the index of its queue, for worker threads.
+static thread_local JobScheduler* __workerScheduler = NULL;
+static thread_local unsigned int __workerIndex = 0;
+
+JobScheduler::Job::Job(const std::function<void()>& func)
+    : _func(func), _pendingDependencies(0), _complete(false)
+{
+}
+
+bool JobScheduler::Job::isComplete() const
+{
+    return _complete.load();
+}
+
+JobScheduler::JobScheduler()
+    : _queuedCount(0), _running(false)
+{
+}
+
+JobScheduler::~JobScheduler()
+{
+    GP_ASSERT(_workers.empty());
+}
+
+void JobScheduler::initialize(int workerCount)
+{
+    GP_ASSERT(!_running);
+
+    if (workerCount < 0)
+    {
+        // Leave one hardware thread for the main thread, which also runs jobs while it waits.
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? (int)hardwareThreads - 1 : 0;
+    }
+
+    _running = true;
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _queues.push_back(new JobQueue());
+    }
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers.push_back(new std::thread(&workerThreadProc, this, (unsigned int)i));
+    }
+}
+
+void JobScheduler::finalize()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _running = false;
+    }
+    _jobAvailable.notify_all();
+
+    for (size_t i = 0, count = _workers.size(); i < count; ++i)
+    {
+        _workers[i]->join();
+        SAFE_DELETE(_workers[i]);
+    }
+    _workers.clear();
+
+    // Run anything still queued so that nobody waiting on a job is left hanging.
+    while (runPendingJob());
+
+    for (size_t i = 0, count = _queues.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_queues[i]);
+    }
+    _queues.clear();
+}
+
+unsigned int JobScheduler::getWorkerCount() const
+{
+    return (unsigned int)_workers.size();
+}
+
+JobScheduler::JobHandle JobScheduler::submit(const std::function<void()>& func, const JobHandle* dependencies, unsigned int dependencyCount)
+{
+    JobHandle job(new Job(func));
+
+    // Hold an extra dependency while registering with the other jobs, so that this job
+    // cannot be queued by one of them completing before all have been registered.
+    job->_pendingDependencies = 1;
+    for (unsigned int i = 0; i < dependencyCount; ++i)
+    {
+        Job* dependency = dependencies[i].get();
+        if (dependency == NULL)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->_mutex);
+        if (!dependency->_complete)
+        {
+            ++job->_pendingDependencies;
+            dependency->_dependents.push_back(job);
+        }
+    }
+
+    if (--job->_pendingDependencies == 0)
+        enqueue(job);
+
+    return job;
+}
+
+JobScheduler::JobHandle JobScheduler::submit(const std::function<void()>& func, const JobHandle& dependency)
+{
+    return submit(func, &dependency, 1);
+}
+
+void JobScheduler::wait(const JobHandle& job)
+{
+    if (!job)
+        return;
+
+    while (!job->isComplete())
+    {
+        if (!runPendingJob())
+            std::this_thread::yield();
+    }
+}
+
+void JobScheduler::wait(const JobHandle* jobs, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        wait(jobs[i]);
+    }
+}
+
+void JobScheduler::enqueue(const JobHandle& job)
+{
+    // Workers push onto their own queue, everyone else onto the shared queue.
+    JobQueue* queue = (__workerScheduler == this) ? _queues[__workerIndex] : &_sharedQueue;
+    ++_queuedCount;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(job);
+    }
+
+    // Lock the sleep mutex so the notification cannot be lost between a worker checking
+    // the queued count and going to sleep.
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _jobAvailable.notify_one();
+}
+
+JobScheduler::JobHandle JobScheduler::dequeue()
+{
+    JobHandle job;
+    if (_queuedCount.load() == 0)
+        return job;
+
+    const unsigned int queueCount = (unsigned int)_queues.size();
+    const bool worker = (__workerScheduler == this);
+
+    // Run our own most recent job first, since its data is most likely still in cache.
+    if (worker)
+    {
+        JobQueue* queue = _queues[__workerIndex];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            job.swap(queue->jobs.back());
+            queue->jobs.pop_back();
+        }
+    }
+
+    // Then take the oldest job from the shared queue, and finally steal the oldest job
+    // from another worker, starting with our neighbour to spread out contention.
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(_sharedQueue.mutex);
+        if (!_sharedQueue.jobs.empty())
+        {
+            job.swap(_sharedQueue.jobs.front());
+            _sharedQueue.jobs.pop_front();
+        }
+    }
+    for (unsigned int i = 0; !job && i < queueCount; ++i)
+    {
+        unsigned int victim = worker ? (__workerIndex + 1 + i) % queueCount : i;
+        if (worker && victim == __workerIndex)
+            continue;
+
+        JobQueue* queue = _queues[victim];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            job.swap(queue->jobs.front());
+            queue->jobs.pop_front();
+        }
+    }
+
+    if (job)
+        --_queuedCount;
+    return job;
+}
+
+void JobScheduler::execute(const JobHandle& job)
+{
+    job->_func();
+    job->_func = nullptr;
+
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->_mutex);
+        job->_complete = true;
+        dependents.swap(job->_dependents);
+    }
+
+    for (size_t i = 0, count = dependents.size(); i < count; ++i)
+    {
+        if (--dependents[i]->_pendingDependencies == 0)
+            enqueue(dependents[i]);
+    }
+}
+
+bool JobScheduler::runPendingJob()
+{
+    JobHandle job = dequeue();
+    if (!job)
+        return false;
+    execute(job);
+    return true;
+}
+
+void JobScheduler::parallelFor(unsigned int count, const std::function<void(unsigned int)>& func, unsigned int grainSize)
+{
+    if (count == 0)
+        return;
+    if (grainSize == 0)
+        grainSize = 1;
+
+    const unsigned int batchCount = (count + grainSize - 1) / grainSize;
+    if (batchCount == 1 || _workers.empty())
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    // Batches are claimed from a shared counter by the calling thread and by helper jobs
+    // running on the workers. The state is reference counted since a helper job may only
+    // start after the calling thread has already processed every batch and returned.
+    struct Batches
+    {
+        std::atomic<unsigned int> next;
+        std::atomic<unsigned int> remaining;
+        std::function<void(unsigned int)> func;
+        unsigned int count;
+        unsigned int grainSize;
+        unsigned int batchCount;
+    };
+    std::shared_ptr<Batches> batches(new Batches());
+    batches->next = 0;
+    batches->remaining = batchCount;
+    batches->func = func;
+    batches->count = count;
+    batches->grainSize = grainSize;
+    batches->batchCount = batchCount;
+
+    std::function<void()> process = [batches]()
+    {
+        unsigned int batch;
+        while ((batch = batches->next.fetch_add(1)) < batches->batchCount)
+        {
+            unsigned int begin = batch * batches->grainSize;
+            unsigned int end = std::min(begin + batches->grainSize, batches->count);
+            for (unsigned int i = begin; i < end; ++i)
+                batches->func(i);
+            batches->remaining.fetch_sub(1);
+        }
+    };
+
+    unsigned int helpers = std::min((unsigned int)_workers.size(), batchCount - 1);
+    for (unsigned int i = 0; i < helpers; ++i)
+        submit(process);
+
+    process();
+
+    // Help with other queued work while the last batches complete on the workers.
+    while (batches->remaining.load() > 0)
+    {
+        if (!runPendingJob())
+            std::this_thread::yield();
+    }
+}
+
+void JobScheduler::workerThreadProc(JobScheduler* scheduler, unsigned int index)
+{
+    __workerScheduler = scheduler;
+    __workerIndex = index;
+
+    while (true)
+    {
+        if (scheduler->runPendingJob())
+            continue;
+
+        std::unique_lock<std::mutex> lock(scheduler->_sleepMutex);
+        while (scheduler->_running && scheduler->_queuedCount.load() == 0)
+            scheduler->_jobAvailable.wait(lock);
+        if (!scheduler->_running)
+            break;
+    }
+
+    __workerScheduler = NULL;
+}
+
+}
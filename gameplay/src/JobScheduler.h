@@ -0,0 +1,208 @@
+#ifndef JOBSCHEDULER_H_
+#define JOBSCHEDULER_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a work-stealing job scheduler that runs jobs submitted by the engine and the game
+ * on a pool of worker threads.
+ *
+ * Every worker owns a queue of jobs. Jobs submitted from a worker are pushed onto its own queue
+ * and run most recently submitted first, while idle workers steal the oldest jobs from the
+ * queues of busy workers. Jobs submitted from any other thread are shared by all workers.
+ *
+ * A job may depend on other jobs, in which case it is only queued once all of them have completed,
+ * allowing dependency graphs of jobs to be built up front and submitted at once.
+ *
+ * The scheduler is owned by the Game and is created before any of the other controllers.
+ * Jobs must not make GL calls or run script code, since the GL context and the script
+ * state are only safe to use on the main thread.
+ *
+ * @script{ignore}
+ */
+class JobScheduler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines a job submitted to the scheduler.
+     */
+    class Job
+    {
+        friend class JobScheduler;
+
+    public:
+
+        /**
+         * Determines if the job has finished running.
+         *
+         * @return true if the job has completed, false otherwise.
+         */
+        bool isComplete() const;
+
+    private:
+
+        Job(const std::function<void()>& func);
+
+        Job(const Job& copy);
+
+        Job& operator=(const Job&);
+
+        std::function<void()> _func;
+        std::atomic<int> _pendingDependencies;
+        std::atomic<bool> _complete;
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<Job> > _dependents;
+    };
+
+    /**
+     * Handle to a submitted job.
+     */
+    typedef std::shared_ptr<Job> JobHandle;
+
+    /**
+     * Destructor.
+     */
+    ~JobScheduler();
+
+    /**
+     * Gets the number of worker threads owned by the scheduler.
+     *
+     * The calling thread also runs jobs while it waits on them, so a parallel operation
+     * may run on up to getWorkerCount() + 1 threads.
+     *
+     * @return The number of worker threads.
+     */
+    unsigned int getWorkerCount() const;
+
+    /**
+     * Submits a job to be run on the worker threads.
+     *
+     * If the scheduler has no worker threads the job is run when it is waited on.
+     *
+     * @param func The function to run.
+     * @param dependencies The jobs that must complete before this job may run, or NULL.
+     * @param dependencyCount The number of jobs in the dependencies array.
+     *
+     * @return A handle to the submitted job.
+     */
+    JobHandle submit(const std::function<void()>& func, const JobHandle* dependencies = NULL, unsigned int dependencyCount = 0);
+
+    /**
+     * Submits a job to be run on the worker threads once the given job has completed.
+     *
+     * @param func The function to run.
+     * @param dependency The job that must complete before this job may run.
+     *
+     * @return A handle to the submitted job.
+     */
+    JobHandle submit(const std::function<void()>& func, const JobHandle& dependency);
+
+    /**
+     * Waits for the given job to complete.
+     *
+     * The calling thread runs other queued jobs while it waits, so it is safe to wait on
+     * a job from within another job.
+     *
+     * @param job The job to wait on.
+     */
+    void wait(const JobHandle& job);
+
+    /**
+     * Waits for all of the given jobs to complete.
+     *
+     * @param jobs The jobs to wait on.
+     * @param count The number of jobs in the array.
+     */
+    void wait(const JobHandle* jobs, unsigned int count);
+
+    /**
+     * Calls the specified function once for every index in the range [0, count),
+     * distributing the calls across the worker threads and the calling thread.
+     *
+     * This method blocks until all of the calls have returned. The function
+     * is called concurrently from multiple threads, so it must be thread safe.
+     *
+     * @param count The number of indices to process.
+     * @param func The function to call for each index.
+     * @param grainSize The number of consecutive indices processed by a thread at a time.
+     */
+    void parallelFor(unsigned int count, const std::function<void(unsigned int)>& func, unsigned int grainSize = 1);
+
+private:
+
+    /**
+     * A queue of jobs ready to run, owned by a single worker or shared by all of them.
+     */
+    struct JobQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    /**
+     * Constructor.
+     */
+    JobScheduler();
+
+    /**
+     * Hidden copy constructor.
+     */
+    JobScheduler(const JobScheduler& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    JobScheduler& operator=(const JobScheduler&);
+
+    /**
+     * Starts the worker threads.
+     *
+     * @param workerCount The number of worker threads to start, or -1 to use one less than the number of hardware threads.
+     */
+    void initialize(int workerCount = -1);
+
+    /**
+     * Stops and joins the worker threads.
+     */
+    void finalize();
+
+    /**
+     * Queues a job whose dependencies have all completed.
+     */
+    void enqueue(const JobHandle& job);
+
+    /**
+     * Takes the next job to run for the calling thread, stealing from other workers if needed.
+     */
+    JobHandle dequeue();
+
+    /**
+     * Runs a job and releases the jobs that depend on it.
+     */
+    void execute(const JobHandle& job);
+
+    /**
+     * Runs a single queued job on the calling thread, if there is one.
+     *
+     * @return true if a job was run, false if there was no job to run.
+     */
+    bool runPendingJob();
+
+    static void workerThreadProc(JobScheduler* scheduler, unsigned int index);
+
+    std::vector<std::thread*> _workers;
+    std::vector<JobQueue*> _queues;
+    JobQueue _sharedQueue;
+    std::atomic<unsigned int> _queuedCount;
+    std::mutex _sleepMutex;
+    std::condition_variable _jobAvailable;
+    std::atomic<bool> _running;
+};
+
+}
+
+#endif
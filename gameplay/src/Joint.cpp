@@ -65,6 +65,17 @@ void Joint::transformChanged()
 {
     Node::transformChanged();
     _jointMatrixDirty = true;
+    setSkinsDirty();
+}
+
+void Joint::setSkinsDirty(bool bindMatricesChanged)
+{
+    for (SkinReference* itr = &_skin; itr && itr->skin; itr = itr->next)
+    {
+        itr->skin->_paletteDirty = true;
+        if (bindMatricesChanged)
+            itr->skin->_jointOrderDirty = true;
+    }
 }
 
 void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
@@ -77,7 +88,7 @@ void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
     {
         _jointMatrixDirty = false;
 
-        static Matrix t;
+        Matrix t;
         Matrix::multiply(Node::getWorldMatrix(), getInverseBindPose(), &t);
         Matrix::multiply(t, bindShape, &t);
 
@@ -97,6 +108,7 @@ void Joint::setInverseBindPose(const Matrix& m)
 {
     _bindPose = m;
     _jointMatrixDirty = true;
+    setSkinsDirty(true);
 }
 
 void Joint::addSkin(MeshSkin* skin)
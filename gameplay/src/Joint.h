@@ -128,6 +128,11 @@ private:
 
     void removeSkin(MeshSkin* skin);
 
+    /**
+     * Marks the matrix palettes of the skins referencing this joint as dirty.
+     */
+    void setSkinsDirty(bool bindMatricesChanged = false);
+
     /** 
      * The Matrix representation of the Joint's bind pose.
      */
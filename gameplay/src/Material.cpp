@@ -288,6 +288,86 @@ bool Material::loadPass(Technique* technique, Properties* passProperties, PassCa
     return true;
 }
 
+/**
+ * Creates the effects of the passes of a material and returns the number created.
+ * The effects are added to the given list, or released if it is NULL.
+ */
+static unsigned int prewarmMaterial(Properties* materialProperties, const char* defines, std::vector<Effect*>* effects)
+{
+    unsigned int count = 0;
+    Properties* techniqueProperties = NULL;
+    while ((techniqueProperties = materialProperties->getNextNamespace()))
+    {
+        if (strcmp(techniqueProperties->getNamespace(), "technique") != 0)
+            continue;
+
+        Properties* passProperties = NULL;
+        while ((passProperties = techniqueProperties->getNextNamespace()))
+        {
+            if (strcmp(passProperties->getNamespace(), "pass") != 0)
+                continue;
+
+            const char* vertexShaderPath = passProperties->getString("vertexShader");
+            const char* fragmentShaderPath = passProperties->getString("fragmentShader");
+            if (vertexShaderPath == NULL || fragmentShaderPath == NULL)
+                continue;
+
+            // Join the defines in the same order as Material::loadPass, so that the effects are identical.
+            const char* passDefines = passProperties->getString("defines");
+            std::string allDefines = passDefines ? passDefines : "";
+            if (defines && strlen(defines) > 0)
+            {
+                if (allDefines.length() > 0)
+                    allDefines += ';';
+                allDefines += defines;
+            }
+
+            Effect* effect = Effect::createFromFile(vertexShaderPath, fragmentShaderPath, allDefines.c_str());
+            if (effect)
+            {
+                ++count;
+                if (effects)
+                    effects->push_back(effect);
+                else
+                    SAFE_RELEASE(effect);
+            }
+        }
+    }
+    return count;
+}
+
+unsigned int Material::prewarm(const char* url, const char* defines, std::vector<Effect*>* effects)
+{
+    // Effects that are released right away are only kept by the program cache.
+    if (effects == NULL && !Effect::isCacheEnabled())
+        return 0;
+
+    Properties* properties = Properties::create(url);
+    if (properties == NULL)
+    {
+        GP_WARN("Failed to load materials from file: %s", url);
+        return 0;
+    }
+
+    unsigned int count = 0;
+    if (strcmp(properties->getNamespace(), "material") == 0)
+    {
+        count = prewarmMaterial(properties, defines, effects);
+    }
+    else
+    {
+        Properties* materialProperties = NULL;
+        while ((materialProperties = properties->getNextNamespace()))
+        {
+            if (strcmp(materialProperties->getNamespace(), "material") == 0)
+                count += prewarmMaterial(materialProperties, defines, effects);
+        }
+    }
+    SAFE_DELETE(properties);
+
+    return count;
+}
+
 static bool isMaterialKeyword(const char* str)
 {
     GP_ASSERT(str);
@@ -104,6 +104,32 @@ public:
      */
     static Material* create(const char* vshPath, const char* fshPath, const char* defines = NULL);
 
+    /**
+     * Creates the effect of every pass of every material in the given file, so that
+     * the shader programs are compiled before the materials are first loaded.
+     *
+     * The file may contain a single material or several materials. Defines that are
+     * added by a pass callback when the materials are loaded, such as light counts,
+     * are not known here and must be passed in to build the same programs.
+     *
+     * Effects are only shared while they are referenced, so to have materials that
+     * are loaded later reuse them, pass a list to hold them and release them once
+     * the materials have been loaded. Without a list the effects are released right
+     * away, which is only useful to fill the shader program cache so that later runs
+     * load the programs without compiling them. If the program cache is not enabled,
+     * nothing is created in that case.
+     *
+     * @param url The URL of the material file.
+     * @param defines Defines to add to the defines of every pass, or NULL.
+     * @param effects The list to add the created effects to, which the caller must
+     *      release, or NULL to release them right away.
+     *
+     * @return The number of effects created.
+     * @see Effect::isCacheEnabled
+     * @script{ignore}
+     */
+    static unsigned int prewarm(const char* url, const char* defines = NULL, std::vector<Effect*>* effects = NULL);
+
     /**
      * Returns the number of techniques in the material.
      *
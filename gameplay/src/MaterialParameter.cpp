@@ -5,8 +5,12 @@
 namespace gameplay
 {
 
+// Source of value versions, unique across all parameters so that a uniform can tell
+// both which parameter last set it and whether that parameter has changed since.
+static unsigned long long __parameterVersion = 0;
+
 MaterialParameter::MaterialParameter(const char* name) :
-_type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL), _loggerDirtyBits(0)
+_type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL), _loggerDirtyBits(0), _version(0)
 {
     clearValue();
 }
@@ -18,6 +22,8 @@ MaterialParameter::~MaterialParameter()
 
 void MaterialParameter::clearValue()
 {
+    valueChanged();
+
     // Release parameters
     switch (_type)
     {
@@ -207,6 +213,7 @@ void MaterialParameter::setValue(const Matrix& value)
     }
 
     memcpy(_value.floatPtrValue, value.m, sizeof(float) * 16);
+    valueChanged();
 
     _dynamic = true;
     _count = 1;
@@ -446,6 +453,32 @@ void MaterialParameter::setSamplerArray(const Texture::Sampler** values, unsigne
     _type = MaterialParameter::SAMPLER_ARRAY;
 }
 
+void MaterialParameter::valueChanged()
+{
+    _version = ++__parameterVersion;
+}
+
+bool MaterialParameter::isValueOwned() const
+{
+    switch (_type)
+    {
+    case MaterialParameter::FLOAT:
+    case MaterialParameter::INT:
+        return true;
+    case MaterialParameter::FLOAT_ARRAY:
+    case MaterialParameter::INT_ARRAY:
+    case MaterialParameter::VECTOR2:
+    case MaterialParameter::VECTOR3:
+    case MaterialParameter::VECTOR4:
+    case MaterialParameter::MATRIX:
+        // Arrays set without copying reference memory that may change behind our back.
+        return _dynamic;
+    default:
+        // Samplers must rebind their textures and method bindings compute a new value on every bind.
+        return false;
+    }
+}
+
 void MaterialParameter::bind(Effect* effect)
 {
     GP_ASSERT(effect);
@@ -468,6 +501,11 @@ void MaterialParameter::bind(Effect* effect)
         }
     }
 
+    // Nothing to do if the uniform still holds the value of this version of this parameter.
+    bool owned = isValueOwned();
+    if (owned && _uniform->_parameterVersion == _version)
+        return;
+
     switch (_type)
     {
     case MaterialParameter::FLOAT:
@@ -514,6 +552,9 @@ void MaterialParameter::bind(Effect* effect)
             break;
         }
     }
+
+    if (owned)
+        _uniform->_parameterVersion = _version;
 }
 
 void MaterialParameter::bindValue(Node* node, const char* binding)
@@ -704,6 +745,7 @@ void MaterialParameter::setAnimationPropertyValue(int propertyId, AnimationValue
     {
         case ANIMATE_UNIFORM:
         {
+            valueChanged();
             switch (_type)
             {
                 case FLOAT:
@@ -430,6 +430,17 @@ private:
 
     void clearValue();
 
+    /**
+     * Marks the value of the parameter as changed, so that it is uploaded the next time it is bound.
+     */
+    void valueChanged();
+
+    /**
+     * Determines if the value is stored by the parameter itself, rather than referenced or
+     * computed, so that all of its changes go through the parameter.
+     */
+    bool isValueOwned() const;
+
     void bind(Effect* effect);
 
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
@@ -481,6 +492,7 @@ private:
     std::string _name;
     Uniform* _uniform;
     char _loggerDirtyBits;
+    unsigned long long _version;
 };
 
 template <class ClassType, class ParameterType>
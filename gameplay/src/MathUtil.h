@@ -12,6 +12,10 @@ class MathUtil
 {
     friend class Matrix;
     friend class Vector3;
+    friend class Frustum;
+    friend class MeshSkin;
+    friend class AnimationBlendTree;
+    friend class AnimationClip;
 
 public:
 
@@ -66,6 +70,42 @@ private:
 
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+    /**
+     * Tests packed spheres (x, y, z, radius) against up to six planes (nx, ny, nz, d) and sets
+     * the bits of the visible spheres in the visibility mask. Returns the number of visible spheres.
+     */
+    inline static unsigned int cullSpheres(const float* planes, unsigned int planeMask, const float* spheres, unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+
+    /**
+     * Tests packed boxes (min x, y, z, max x, y, z) against up to six planes (nx, ny, nz, d) and sets
+     * the bits of the visible boxes in the visibility mask. Returns the number of visible boxes.
+     */
+    inline static unsigned int cullBoxes(const float* planes, unsigned int planeMask, const float* boxes, unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+
+    /**
+     * Multiplies two matrices and stores the first three rows of the product as 12 floats,
+     * which is the layout of a matrix in a skinning matrix palette.
+     */
+    inline static void multiplyMatrixRows3x4(const float* m1, const float* m2, float* dst);
+
+    /**
+     * Linearly blends two arrays of floats, with the weight of each element scaled by an optional mask:
+     * dst = a + (b - a) * weight * mask.
+     */
+    inline static void blendArrays(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst);
+
+    /**
+     * Adds the difference of two arrays of floats to a third, with the weight of each element scaled by
+     * an optional mask: dst = base + (b - a) * weight * mask.
+     */
+    inline static void addArrayDifference(const float* base, const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst);
+
+    /**
+     * Blends two arrays of quaternions (x, y, z, w) along the shortest path and normalizes the results,
+     * with the weight of each quaternion scaled by an optional mask.
+     */
+    inline static void blendQuaternions(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst);
+
     MathUtil();
 };
 
@@ -73,8 +113,18 @@ private:
 
 #define MATRIX_SIZE ( sizeof(float) * 16)
 
+// SSE is used for the matrix operations on x86 targets unless NEON is requested
+// or GP_NO_SSE is defined.
+#if !defined(GP_USE_NEON) && !defined(GP_NO_SSE) && !defined(GP_USE_SSE)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GP_USE_SSE
+#endif
+#endif
+
 #ifdef GP_USE_NEON
 #include "MathUtilNeon.inl"
+#elif defined(GP_USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -109,6 +109,58 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
     memcpy(dst, product, MATRIX_SIZE);
 }
 
+inline void MathUtil::multiplyMatrixRows3x4(const float* m1, const float* m2, float* dst)
+{
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            const float* b = &m2[c * 4];
+            dst[r * 4 + c] = m1[r] * b[0] + m1[r + 4] * b[1] + m1[r + 8] * b[2] + m1[r + 12] * b[3];
+        }
+    }
+}
+
+inline void MathUtil::blendArrays(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float w = mask ? weight * mask[i] : weight;
+        dst[i] = a[i] + (b[i] - a[i]) * w;
+    }
+}
+
+inline void MathUtil::addArrayDifference(const float* base, const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float w = mask ? weight * mask[i] : weight;
+        dst[i] = base[i] + (b[i] - a[i]) * w;
+    }
+}
+
+inline void MathUtil::blendQuaternions(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i, a += 4, b += 4, dst += 4)
+    {
+        float w = mask ? weight * mask[i] : weight;
+
+        // Blend towards the nearer of the two quaternions that represent the same rotation.
+        float sign = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f ? -1.0f : 1.0f;
+        float x = a[0] + (b[0] * sign - a[0]) * w;
+        float y = a[1] + (b[1] * sign - a[1]) * w;
+        float z = a[2] + (b[2] * sign - a[2]) * w;
+        float s = a[3] + (b[3] * sign - a[3]) * w;
+
+        float n = x * x + y * y + z * z + s * s;
+        n = n > 0.0f ? 1.0f / sqrt(n) : 0.0f;
+        dst[0] = x * n;
+        dst[1] = y * n;
+        dst[2] = z * n;
+        dst[3] = s * n;
+    }
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
     dst[0]  = -m[0];
@@ -172,6 +224,75 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* spheres, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float* s = &spheres[i * 4];
+
+        // Test the plane that rejected the sphere last first, since it is likely to reject it again.
+        bool outside = false;
+        if (planeCache)
+        {
+            const float* p = &planes[planeCache[i] * 4];
+            outside = p[0] * s[0] + p[1] * s[1] + p[2] * s[2] + p[3] < -s[3];
+        }
+        for (unsigned int j = 0; j < 6 && !outside; ++j)
+        {
+            const float* p = &planes[j * 4];
+            if ((planeMask & (1u << j)) && p[0] * s[0] + p[1] * s[1] + p[2] * s[2] + p[3] < -s[3])
+            {
+                outside = true;
+                if (planeCache)
+                    planeCache[i] = (unsigned char)j;
+            }
+        }
+
+        if (!outside)
+        {
+            visibility[i >> 5] |= 1u << (i & 31);
+            ++visible;
+        }
+    }
+    return visible;
 }
 
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* boxes, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float* b = &boxes[i * 6];
+        float c[3] = { (b[0] + b[3]) * 0.5f, (b[1] + b[4]) * 0.5f, (b[2] + b[5]) * 0.5f };
+        float e[3] = { (b[3] - b[0]) * 0.5f, (b[4] - b[1]) * 0.5f, (b[5] - b[2]) * 0.5f };
+
+        // A box is behind a plane if its center is further behind it than the box extends towards it.
+        bool outside = false;
+        if (planeCache)
+        {
+            const float* p = &planes[planeCache[i] * 4];
+            outside = p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -(fabsf(p[0]) * e[0] + fabsf(p[1]) * e[1] + fabsf(p[2]) * e[2]);
+        }
+        for (unsigned int j = 0; j < 6 && !outside; ++j)
+        {
+            const float* p = &planes[j * 4];
+            if ((planeMask & (1u << j)) &&
+                p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -(fabsf(p[0]) * e[0] + fabsf(p[1]) * e[1] + fabsf(p[2]) * e[2]))
+            {
+                outside = true;
+                if (planeCache)
+                    planeCache[i] = (unsigned char)j;
+            }
+        }
 
+        if (!outside)
+        {
+            visibility[i >> 5] |= 1u << (i & 31);
+            ++visible;
+        }
+    }
+    return visible;
+}
+
+}
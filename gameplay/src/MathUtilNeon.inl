@@ -1,3 +1,5 @@
+#include <arm_neon.h>
+
 namespace gameplay
 {
 
@@ -123,6 +125,70 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
     );
 }
 
+inline void MathUtil::multiplyMatrixRows3x4(const float* m1, const float* m2, float* dst)
+{
+    float product[16];
+    multiplyMatrix(m1, m2, product);
+    transposeMatrix(product, product);
+    memcpy(dst, product, sizeof(float) * 12);
+}
+
+inline void MathUtil::blendArrays(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    float32x4_t w = vdupq_n_f32(weight);
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t wi = mask ? vmulq_f32(w, vld1q_f32(&mask[i])) : w;
+        float32x4_t va = vld1q_f32(&a[i]);
+        vst1q_f32(&dst[i], vmlaq_f32(va, vsubq_f32(vld1q_f32(&b[i]), va), wi));
+    }
+    for (; i < count; ++i)
+    {
+        float wi = mask ? weight * mask[i] : weight;
+        dst[i] = a[i] + (b[i] - a[i]) * wi;
+    }
+}
+
+inline void MathUtil::addArrayDifference(const float* base, const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    float32x4_t w = vdupq_n_f32(weight);
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t wi = mask ? vmulq_f32(w, vld1q_f32(&mask[i])) : w;
+        float32x4_t difference = vsubq_f32(vld1q_f32(&b[i]), vld1q_f32(&a[i]));
+        vst1q_f32(&dst[i], vmlaq_f32(vld1q_f32(&base[i]), difference, wi));
+    }
+    for (; i < count; ++i)
+    {
+        float wi = mask ? weight * mask[i] : weight;
+        dst[i] = base[i] + (b[i] - a[i]) * wi;
+    }
+}
+
+inline void MathUtil::blendQuaternions(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float32x4_t qa = vld1q_f32(&a[i * 4]);
+        float32x4_t qb = vld1q_f32(&b[i * 4]);
+        float w = mask ? weight * mask[i] : weight;
+
+        // Blend towards the nearer of the two quaternions that represent the same rotation.
+        float32x4_t product = vmulq_f32(qa, qb);
+        float32x2_t sum = vadd_f32(vget_low_f32(product), vget_high_f32(product));
+        if (vget_lane_f32(vpadd_f32(sum, sum), 0) < 0.0f)
+            qb = vnegq_f32(qb);
+        float32x4_t q = vmlaq_n_f32(qa, vsubq_f32(qb, qa), w);
+
+        product = vmulq_f32(q, q);
+        sum = vadd_f32(vget_low_f32(product), vget_high_f32(product));
+        float length = vget_lane_f32(vpadd_f32(sum, sum), 0);
+        vst1q_f32(&dst[i * 4], vmulq_n_f32(q, length > 0.0f ? 1.0f / sqrtf(length) : 0.0f));
+    }
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
     asm volatile(
@@ -226,4 +292,168 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     );
 }
 
+/**
+ * Gets a bit for each lane of a comparison result.
+ */
+inline int moveMaskNeon(uint32x4_t mask)
+{
+    static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(mask, vld1q_u32(laneBits));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return (int)vget_lane_u32(sum, 0);
+}
+
+/**
+ * Tests four volumes, given by their centers and their extents and radii towards the planes,
+ * against the planes of a frustum. Returns the lanes of the volumes that are outside.
+ */
+inline int cullVolumesNeon(const float* planes, unsigned int planeMask, float32x4_t cx, float32x4_t cy, float32x4_t cz,
+                           float32x4_t ex, float32x4_t ey, float32x4_t ez, float32x4_t r, bool boxes, unsigned char* planeCache)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    int outside = 0;
+    for (int j = planeCache ? -1 : 0; j < 6; ++j)
+    {
+        float32x4_t nx, ny, nz, nw;
+        if (j < 0)
+        {
+            // Test each volume against the plane that rejected it last first, since it is likely to reject it again.
+            float cached[16];
+            for (int k = 0; k < 4; ++k)
+            {
+                const float* p = &planes[planeCache[k] * 4];
+                cached[k] = p[0];
+                cached[4 + k] = p[1];
+                cached[8 + k] = p[2];
+                cached[12 + k] = p[3];
+            }
+            nx = vld1q_f32(&cached[0]);
+            ny = vld1q_f32(&cached[4]);
+            nz = vld1q_f32(&cached[8]);
+            nw = vld1q_f32(&cached[12]);
+        }
+        else if (planeMask & (1u << j))
+        {
+            const float* p = &planes[j * 4];
+            nx = vdupq_n_f32(p[0]);
+            ny = vdupq_n_f32(p[1]);
+            nz = vdupq_n_f32(p[2]);
+            nw = vdupq_n_f32(p[3]);
+        }
+        else
+        {
+            continue;
+        }
+
+        // A volume is behind a plane if its center is further behind it than the volume extends towards it.
+        float32x4_t d = vmlaq_f32(vmlaq_f32(vmlaq_f32(nw, nx, cx), ny, cy), nz, cz);
+        float32x4_t extent = r;
+        if (boxes)
+            extent = vmlaq_f32(vmlaq_f32(vmulq_f32(vabsq_f32(nx), ex), vabsq_f32(ny), ey), vabsq_f32(nz), ez);
+        int rejected = moveMaskNeon(vcltq_f32(vaddq_f32(d, extent), zero)) & ~outside;
+        if (rejected)
+        {
+            if (planeCache && j >= 0)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    if (rejected & (1 << k))
+                        planeCache[k] = (unsigned char)j;
+                }
+            }
+            outside |= rejected;
+            if (outside == 0xF)
+                break;
+        }
+    }
+    return outside;
+}
+
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* spheres, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    static const unsigned char bitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        // Copy the last partial batch so that reads stay within the arrays.
+        unsigned int batchCount = std::min(count - i, 4u);
+        float tail[16];
+        unsigned char tailCache[4];
+        const float* s = &spheres[i * 4];
+        unsigned char* cache = planeCache ? &planeCache[i] : NULL;
+        if (batchCount < 4)
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, s, batchCount * 4 * sizeof(float));
+            s = tail;
+            if (cache)
+            {
+                memset(tailCache, 0, sizeof(tailCache));
+                memcpy(tailCache, cache, batchCount);
+                cache = tailCache;
+            }
+        }
+
+        // De-interleave the x, y, z and radius of the four spheres.
+        float32x4x4_t v = vld4q_f32(s);
+
+        int outside = cullVolumesNeon(planes, planeMask, v.val[0], v.val[1], v.val[2], zero, zero, zero, v.val[3], false, cache);
+        unsigned int bits = ~outside & ((1u << batchCount) - 1);
+        visibility[i >> 5] |= bits << (i & 31);
+        visible += bitCounts[bits];
+
+        if (cache == tailCache)
+            memcpy(&planeCache[i], tailCache, batchCount);
+    }
+    return visible;
+}
+
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* boxes, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    static const unsigned char bitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        unsigned int batchCount = std::min(count - i, 4u);
+        unsigned char tailCache[4];
+        unsigned char* cache = planeCache ? &planeCache[i] : NULL;
+        if (batchCount < 4 && cache)
+        {
+            memset(tailCache, 0, sizeof(tailCache));
+            memcpy(tailCache, cache, batchCount);
+            cache = tailCache;
+        }
+
+        // Gather the boxes into one vector per component, repeating the last box of a partial batch.
+        float components[24];
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            const float* b = &boxes[(i + std::min(k, batchCount - 1)) * 6];
+            for (unsigned int c = 0; c < 6; ++c)
+                components[c * 4 + k] = b[c];
+        }
+        float32x4_t minX = vld1q_f32(&components[0]);
+        float32x4_t minY = vld1q_f32(&components[4]);
+        float32x4_t minZ = vld1q_f32(&components[8]);
+        float32x4_t maxX = vld1q_f32(&components[12]);
+        float32x4_t maxY = vld1q_f32(&components[16]);
+        float32x4_t maxZ = vld1q_f32(&components[20]);
+
+        int outside = cullVolumesNeon(planes, planeMask,
+                                      vmulq_f32(vaddq_f32(minX, maxX), half), vmulq_f32(vaddq_f32(minY, maxY), half), vmulq_f32(vaddq_f32(minZ, maxZ), half),
+                                      vmulq_f32(vsubq_f32(maxX, minX), half), vmulq_f32(vsubq_f32(maxY, minY), half), vmulq_f32(vsubq_f32(maxZ, minZ), half),
+                                      vdupq_n_f32(0.0f), true, cache);
+        unsigned int bits = ~outside & ((1u << batchCount) - 1);
+        visibility[i >> 5] |= bits << (i & 31);
+        visible += bitCounts[bits];
+
+        if (cache == tailCache)
+            memcpy(&planeCache[i], tailCache, batchCount);
+    }
+    return visible;
+}
+
 }
@@ -0,0 +1,351 @@
+#include <xmmintrin.h>
+
+namespace gameplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_sub_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_sub_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_sub_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_mul_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_mul_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_mul_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_mul_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    // Load all columns of m1 up front to support the case where m1 or m2 is the same array as dst.
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    // Each column of the product is a linear combination of the columns of m1.
+    __m128 r[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* b = &m2[i * 4];
+        r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(b[0])), _mm_mul_ps(c1, _mm_set1_ps(b[1]))),
+                          _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(b[2])), _mm_mul_ps(c3, _mm_set1_ps(b[3]))));
+    }
+
+    _mm_storeu_ps(&dst[0],  r[0]);
+    _mm_storeu_ps(&dst[4],  r[1]);
+    _mm_storeu_ps(&dst[8],  r[2]);
+    _mm_storeu_ps(&dst[12], r[3]);
+}
+
+inline void MathUtil::multiplyMatrixRows3x4(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    __m128 r[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* b = &m2[i * 4];
+        r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(b[0])), _mm_mul_ps(c1, _mm_set1_ps(b[1]))),
+                          _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(b[2])), _mm_mul_ps(c3, _mm_set1_ps(b[3]))));
+    }
+
+    // Transpose the columns of the product into rows and drop the last one.
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+    _mm_storeu_ps(&dst[0], r[0]);
+    _mm_storeu_ps(&dst[4], r[1]);
+    _mm_storeu_ps(&dst[8], r[2]);
+}
+
+inline void MathUtil::blendArrays(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    __m128 w = _mm_set1_ps(weight);
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 wi = mask ? _mm_mul_ps(w, _mm_loadu_ps(&mask[i])) : w;
+        __m128 va = _mm_loadu_ps(&a[i]);
+        _mm_storeu_ps(&dst[i], _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&b[i]), va), wi)));
+    }
+    for (; i < count; ++i)
+    {
+        float wi = mask ? weight * mask[i] : weight;
+        dst[i] = a[i] + (b[i] - a[i]) * wi;
+    }
+}
+
+inline void MathUtil::addArrayDifference(const float* base, const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    __m128 w = _mm_set1_ps(weight);
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 wi = mask ? _mm_mul_ps(w, _mm_loadu_ps(&mask[i])) : w;
+        __m128 difference = _mm_sub_ps(_mm_loadu_ps(&b[i]), _mm_loadu_ps(&a[i]));
+        _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_loadu_ps(&base[i]), _mm_mul_ps(difference, wi)));
+    }
+    for (; i < count; ++i)
+    {
+        float wi = mask ? weight * mask[i] : weight;
+        dst[i] = base[i] + (b[i] - a[i]) * wi;
+    }
+}
+
+inline void MathUtil::blendQuaternions(const float* a, const float* b, float weight, const float* mask, unsigned int count, float* dst)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        __m128 qa = _mm_loadu_ps(&a[i * 4]);
+        __m128 qb = _mm_loadu_ps(&b[i * 4]);
+        __m128 w = _mm_set1_ps(mask ? weight * mask[i] : weight);
+
+        // Sum the products across the lanes, leaving the dot product in every lane.
+        __m128 dot = _mm_mul_ps(qa, qb);
+        dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+        dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        // Blend towards the nearer of the two quaternions that represent the same rotation.
+        qb = _mm_xor_ps(qb, _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit));
+        __m128 q = _mm_add_ps(qa, _mm_mul_ps(_mm_sub_ps(qb, qa), w));
+
+        __m128 length = _mm_mul_ps(q, q);
+        length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(2, 3, 0, 1)));
+        length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(1, 0, 3, 2)));
+        length = _mm_sqrt_ps(length);
+        q = _mm_and_ps(_mm_div_ps(q, length), _mm_cmpgt_ps(length, zero));
+        _mm_storeu_ps(&dst[i * 4], q);
+    }
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    __m128 zero = _mm_setzero_ps();
+    _mm_storeu_ps(&dst[0],  _mm_sub_ps(zero, _mm_loadu_ps(&m[0])));
+    _mm_storeu_ps(&dst[4],  _mm_sub_ps(zero, _mm_loadu_ps(&m[4])));
+    _mm_storeu_ps(&dst[8],  _mm_sub_ps(zero, _mm_loadu_ps(&m[8])));
+    _mm_storeu_ps(&dst[12], _mm_sub_ps(zero, _mm_loadu_ps(&m[12])));
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(&dst[0],  c0);
+    _mm_storeu_ps(&dst[4],  c1);
+    _mm_storeu_ps(&dst[8],  c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(x)), _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(y))),
+                          _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(z)), _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w))));
+
+    // Only the xyz components are written since dst may be a Vector3.
+    float t[4];
+    _mm_storeu_ps(t, r);
+    dst[0] = t[0];
+    dst[1] = t[1];
+    dst[2] = t[2];
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    // Handle case where v == dst.
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(v[0])), _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(v[1]))),
+                          _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(v[2])), _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(v[3]))));
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+/**
+ * Tests four volumes, given by their centers and their extents and radii towards the planes,
+ * against the planes of a frustum. Returns the lanes of the volumes that are outside.
+ */
+inline int cullVolumesSSE(const float* planes, unsigned int planeMask, __m128 cx, __m128 cy, __m128 cz,
+                          __m128 ex, __m128 ey, __m128 ez, __m128 r, bool boxes, unsigned char* planeCache)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    int outside = 0;
+    for (int j = planeCache ? -1 : 0; j < 6; ++j)
+    {
+        __m128 nx, ny, nz, nw;
+        if (j < 0)
+        {
+            // Test each volume against the plane that rejected it last first, since it is likely to reject it again.
+            const float* p0 = &planes[planeCache[0] * 4];
+            const float* p1 = &planes[planeCache[1] * 4];
+            const float* p2 = &planes[planeCache[2] * 4];
+            const float* p3 = &planes[planeCache[3] * 4];
+            nx = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+            ny = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+            nz = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+            nw = _mm_setr_ps(p0[3], p1[3], p2[3], p3[3]);
+        }
+        else if (planeMask & (1u << j))
+        {
+            const float* p = &planes[j * 4];
+            nx = _mm_set1_ps(p[0]);
+            ny = _mm_set1_ps(p[1]);
+            nz = _mm_set1_ps(p[2]);
+            nw = _mm_set1_ps(p[3]);
+        }
+        else
+        {
+            continue;
+        }
+
+        // A volume is behind a plane if its center is further behind it than the volume extends towards it.
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), nw));
+        __m128 extent = r;
+        if (boxes)
+        {
+            extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+                                _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+        }
+        int rejected = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, extent), zero)) & ~outside;
+        if (rejected)
+        {
+            if (planeCache && j >= 0)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    if (rejected & (1 << k))
+                        planeCache[k] = (unsigned char)j;
+                }
+            }
+            outside |= rejected;
+            if (outside == 0xF)
+                break;
+        }
+    }
+    return outside;
+}
+
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* spheres, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    static const unsigned char bitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const __m128 zero = _mm_setzero_ps();
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        // Copy the last partial batch so that reads stay within the arrays.
+        unsigned int batchCount = std::min(count - i, 4u);
+        float tail[16];
+        unsigned char tailCache[4];
+        const float* s = &spheres[i * 4];
+        unsigned char* cache = planeCache ? &planeCache[i] : NULL;
+        if (batchCount < 4)
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, s, batchCount * 4 * sizeof(float));
+            s = tail;
+            if (cache)
+            {
+                memset(tailCache, 0, sizeof(tailCache));
+                memcpy(tailCache, cache, batchCount);
+                cache = tailCache;
+            }
+        }
+
+        __m128 x = _mm_loadu_ps(&s[0]);
+        __m128 y = _mm_loadu_ps(&s[4]);
+        __m128 z = _mm_loadu_ps(&s[8]);
+        __m128 r = _mm_loadu_ps(&s[12]);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+
+        int outside = cullVolumesSSE(planes, planeMask, x, y, z, zero, zero, zero, r, false, cache);
+        unsigned int bits = ~outside & ((1u << batchCount) - 1);
+        visibility[i >> 5] |= bits << (i & 31);
+        visible += bitCounts[bits];
+
+        if (cache == tailCache)
+            memcpy(&planeCache[i], tailCache, batchCount);
+    }
+    return visible;
+}
+
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* boxes, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    static const unsigned char bitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const __m128 half = _mm_set1_ps(0.5f);
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        unsigned int batchCount = std::min(count - i, 4u);
+        unsigned char tailCache[4];
+        unsigned char* cache = planeCache ? &planeCache[i] : NULL;
+        if (batchCount < 4 && cache)
+        {
+            memset(tailCache, 0, sizeof(tailCache));
+            memcpy(tailCache, cache, batchCount);
+            cache = tailCache;
+        }
+
+        // Gather the boxes into one register per component, repeating the last box of a partial batch.
+        const float* b[4];
+        for (unsigned int k = 0; k < 4; ++k)
+            b[k] = &boxes[(i + std::min(k, batchCount - 1)) * 6];
+        __m128 minX = _mm_setr_ps(b[0][0], b[1][0], b[2][0], b[3][0]);
+        __m128 minY = _mm_setr_ps(b[0][1], b[1][1], b[2][1], b[3][1]);
+        __m128 minZ = _mm_setr_ps(b[0][2], b[1][2], b[2][2], b[3][2]);
+        __m128 maxX = _mm_setr_ps(b[0][3], b[1][3], b[2][3], b[3][3]);
+        __m128 maxY = _mm_setr_ps(b[0][4], b[1][4], b[2][4], b[3][4]);
+        __m128 maxZ = _mm_setr_ps(b[0][5], b[1][5], b[2][5], b[3][5]);
+
+        int outside = cullVolumesSSE(planes, planeMask,
+                                     _mm_mul_ps(_mm_add_ps(minX, maxX), half), _mm_mul_ps(_mm_add_ps(minY, maxY), half), _mm_mul_ps(_mm_add_ps(minZ, maxZ), half),
+                                     _mm_mul_ps(_mm_sub_ps(maxX, minX), half), _mm_mul_ps(_mm_sub_ps(maxY, minY), half), _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half),
+                                     _mm_setzero_ps(), true, cache);
+        unsigned int bits = ~outside & ((1u << batchCount) - 1);
+        visibility[i >> 5] |= bits << (i & 31);
+        visible += bitCounts[bits];
+
+        if (cache == tailCache)
+            memcpy(&planeCache[i], tailCache, batchCount);
+    }
+    return visible;
+}
+
+}
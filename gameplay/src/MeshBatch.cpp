@@ -7,13 +7,38 @@ namespace gameplay
 
 MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false)
+    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false),
+    _dirty(false), _bufferIndex(0)
 {
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        _vertexBuffers[i] = Mesh::createMesh(vertexFormat, 0, true);
+        _indexBuffers[i] = 0;
+        if (indexed)
+        {
+            GL_ASSERT( glGenBuffers(1, &_indexBuffers[i]) );
+        }
+    }
     resize(initialCapacity);
+    updateVertexAttributeBinding();
 }
 
 MeshBatch::~MeshBatch()
 {
+    for (size_t i = 0, count = _passBindings.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_passBindings[i].bindings[0]);
+        SAFE_RELEASE(_passBindings[i].bindings[1]);
+    }
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        SAFE_RELEASE(_vertexBuffers[i]);
+        if (_indexBuffers[i])
+        {
+            GL_ASSERT( glDeleteBuffers(1, &_indexBuffers[i]) );
+            _indexBuffers[i] = 0;
+        }
+    }
     SAFE_RELEASE(_material);
     SAFE_DELETE_ARRAY(_vertices);
     SAFE_DELETE_ARRAY(_indices);
@@ -46,68 +71,156 @@ MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveTy
 void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
 {
     GP_ASSERT(vertices);
-    
+
+    unsigned short* dstIndices = NULL;
+    unsigned int baseVertex = 0;
+    void* dstVertices = allocate(vertexCount, indexCount, &dstIndices, &baseVertex);
+    if (dstVertices == NULL)
+        return; // batch is full and cannot grow, just clip batch
+
+    // Copy vertex data.
+    memcpy(dstVertices, vertices, vertexCount * _vertexFormat.getVertexSize());
+
+    // Copy index data, with the values offset so that they are relative to the first newly inserted vertex.
+    if (_indexed)
+    {
+        GP_ASSERT(indices);
+        GP_ASSERT(dstIndices);
+        for (unsigned int i = 0; i < indexCount; ++i)
+        {
+            dstIndices[i] = indices[i] + baseVertex;
+        }
+    }
+}
+
+void* MeshBatch::allocate(unsigned int vertexCount, unsigned int indexCount, unsigned short** indices, unsigned int* baseVertex)
+{
     unsigned int newVertexCount = _vertexCount + vertexCount;
     unsigned int newIndexCount = _indexCount + indexCount;
-    if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
+    if (_indexed && _primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
         newIndexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
-    
+
     // Do we need to grow the batch?
-    while (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
+    if (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
     {
-        if (_growSize == 0)
-            return; // growing disabled, just clip batch
-        if (!resize(_capacity + _growSize))
-            return; // failed to grow
+        if (!grow(newVertexCount, _indexed ? newIndexCount : 0))
+            return NULL;
     }
-    
-    // Copy vertex data.
+
     GP_ASSERT(_verticesPtr);
-    unsigned int vBytes = vertexCount * _vertexFormat.getVertexSize();
-    memcpy(_verticesPtr, vertices, vBytes);
-    
-    // Copy index data.
+    void* vertices = _verticesPtr;
+    if (baseVertex)
+        *baseVertex = _vertexCount;
+
     if (_indexed)
     {
         GP_ASSERT(indices);
         GP_ASSERT(_indicesPtr);
 
-        if (_vertexCount == 0)
-        {
-            // Simply copy values directly into the start of the index array.
-            memcpy(_indicesPtr, indices, indexCount * sizeof(unsigned short));
-        }
-        else
+        if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
         {
-            if (_primitiveType == Mesh::TRIANGLE_STRIP)
-            {
-                // Create a degenerate triangle to connect separate triangle strips
-                // by duplicating the previous and next vertices.
-                _indicesPtr[0] = *(_indicesPtr-1);
-                _indicesPtr[1] = _vertexCount;
-                _indicesPtr += 2;
-            }
-            
-            // Loop through all indices and insert them, with their values offset by
-            // 'vertexCount' so that they are relative to the first newly inserted vertex.
-            for (unsigned int i = 0; i < indexCount; ++i)
-            {
-                _indicesPtr[i] = indices[i] + _vertexCount;
-            }
+            // Create a degenerate triangle to connect separate triangle strips
+            // by duplicating the previous and next vertices.
+            _indicesPtr[0] = *(_indicesPtr-1);
+            _indicesPtr[1] = _vertexCount;
+            _indicesPtr += 2;
         }
+        *indices = _indicesPtr;
         _indicesPtr += indexCount;
         _indexCount = newIndexCount;
     }
-    
-    _verticesPtr += vBytes;
+    else if (indices)
+    {
+        *indices = NULL;
+    }
+
+    _verticesPtr += vertexCount * _vertexFormat.getVertexSize();
     _vertexCount = newVertexCount;
+    _dirty = true;
+
+    return vertices;
+}
+
+bool MeshBatch::reserve(unsigned int vertexCount, unsigned int indexCount)
+{
+    unsigned int newVertexCount = _vertexCount + vertexCount;
+    unsigned int newIndexCount = _indexCount + indexCount;
+    if (newVertexCount <= _vertexCapacity && (!_indexed || newIndexCount <= _indexCapacity))
+        return true;
+    return grow(newVertexCount, _indexed ? newIndexCount : 0);
+}
+
+/**
+ * Gets the number of vertices a batch of primitives of the given type and capacity can hold.
+ */
+static unsigned int getVertexCapacity(Mesh::PrimitiveType primitiveType, unsigned int capacity)
+{
+    switch (primitiveType)
+    {
+    case Mesh::LINES:
+        return capacity * 2;
+    case Mesh::LINE_STRIP:
+        return capacity + 1;
+    case Mesh::POINTS:
+        return capacity;
+    case Mesh::TRIANGLES:
+        return capacity * 3;
+    case Mesh::TRIANGLE_STRIP:
+        return capacity + 2;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Gets the largest capacity of an indexed batch of primitives of the given type.
+ */
+static unsigned int getMaxIndexedCapacity(Mesh::PrimitiveType primitiveType)
+{
+    switch (primitiveType)
+    {
+    case Mesh::LINES:
+        return USHRT_MAX / 2;
+    case Mesh::LINE_STRIP:
+        return USHRT_MAX - 1;
+    case Mesh::TRIANGLES:
+        return USHRT_MAX / 3;
+    case Mesh::TRIANGLE_STRIP:
+        return USHRT_MAX - 2;
+    default:
+        return USHRT_MAX;
+    }
+}
+
+bool MeshBatch::grow(unsigned int vertexCount, unsigned int indexCount)
+{
+    if (_growSize == 0)
+        return false; // growing disabled
+
+    // Grow by at least doubling the capacity, so that a batch filled a little at a
+    // time copies each of its vertices a constant number of times on average.
+    unsigned int capacity = _capacity;
+    do
+    {
+        capacity = std::max(capacity * 2, capacity + _growSize);
+    } while (capacity < UINT_MAX / 4 && getVertexCapacity(_primitiveType, capacity) < std::max(vertexCount, indexCount));
+
+    // Indices are 16-bit, so indexed batches cannot grow past the largest capacity they can address.
+    if (_indexed)
+    {
+        capacity = std::min(capacity, getMaxIndexedCapacity(_primitiveType));
+        if (capacity <= _capacity || getVertexCapacity(_primitiveType, capacity) < std::max(vertexCount, indexCount))
+            return false;
+    }
+
+    return resize(capacity);
 }
 
 void MeshBatch::updateVertexAttributeBinding()
 {
     GP_ASSERT(_material);
 
-    // Update our vertex attribute bindings.
+    // The bindings source the vertex buffers, so they do not change when the batch is resized.
     for (unsigned int i = 0, techniqueCount = _material->getTechniqueCount(); i < techniqueCount; ++i)
     {
         Technique* t = _material->getTechniqueByIndex(i);
@@ -116,9 +229,14 @@ void MeshBatch::updateVertexAttributeBinding()
         {
             Pass* p = t->getPassByIndex(j);
             GP_ASSERT(p);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
-            p->setVertexAttributeBinding(b);
-            SAFE_RELEASE(b);
+            PassBinding binding;
+            binding.pass = p;
+            for (unsigned int k = 0; k < 2; ++k)
+            {
+                binding.bindings[k] = VertexAttributeBinding::create(_vertexBuffers[k], p->getEffect());
+            }
+            _passBindings.push_back(binding);
+            p->setVertexAttributeBinding(binding.bindings[_bufferIndex]);
         }
     }
 }
@@ -144,29 +262,9 @@ bool MeshBatch::resize(unsigned int capacity)
     if (capacity == _capacity)
         return true;
 
-    // Store old batch data.
-    unsigned char* oldVertices = _vertices;
-    unsigned short* oldIndices = _indices;
-
-    unsigned int vertexCapacity = 0;
-    switch (_primitiveType)
+    unsigned int vertexCapacity = getVertexCapacity(_primitiveType, capacity);
+    if (vertexCapacity == 0)
     {
-    case Mesh::LINES:
-        vertexCapacity = capacity * 2;
-        break;
-    case Mesh::LINE_STRIP:
-        vertexCapacity = capacity + 1;
-        break;
-    case Mesh::POINTS:
-        vertexCapacity = capacity;
-        break;
-    case Mesh::TRIANGLES:
-        vertexCapacity = capacity * 3;
-        break;
-    case Mesh::TRIANGLE_STRIP:
-        vertexCapacity = capacity + 2;
-        break;
-    default:
         GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
         return false;
     }
@@ -181,42 +279,60 @@ bool MeshBatch::resize(unsigned int capacity)
         return false;
     }
 
-    // Allocate new data and reset pointers.
-    unsigned int voffset = _verticesPtr - _vertices;
-    unsigned int vBytes = vertexCapacity * _vertexFormat.getVertexSize();
-    _vertices = new unsigned char[vBytes];
-    if (voffset >= vBytes)
-        voffset = vBytes - 1;
-    _verticesPtr = _vertices + voffset;
+    // Allocate new data and copy the primitives in the batch, clipping them if the batch shrinks.
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+    unsigned char* oldVertices = _vertices;
+    _vertexCount = std::min(_vertexCount, vertexCapacity);
+    _vertices = new unsigned char[vertexCapacity * vertexSize];
+    _verticesPtr = _vertices + _vertexCount * vertexSize;
+    if (oldVertices)
+        memcpy(_vertices, oldVertices, _vertexCount * vertexSize);
+    SAFE_DELETE_ARRAY(oldVertices);
 
     if (_indexed)
     {
-        unsigned int ioffset = _indicesPtr - _indices;
+        unsigned short* oldIndices = _indices;
+        _indexCount = std::min(_indexCount, indexCapacity);
         _indices = new unsigned short[indexCapacity];
-        if (ioffset >= indexCapacity)
-            ioffset = indexCapacity - 1;
-        _indicesPtr = _indices + ioffset;
+        _indicesPtr = _indices + _indexCount;
+        if (oldIndices)
+            memcpy(_indices, oldIndices, _indexCount * sizeof(unsigned short));
+        SAFE_DELETE_ARRAY(oldIndices);
     }
 
-    // Copy old data back in
-    if (oldVertices)
-        memcpy(_vertices, oldVertices, std::min(_vertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
-    SAFE_DELETE_ARRAY(oldVertices);
-    if (oldIndices)
-        memcpy(_indices, oldIndices, std::min(_indexCapacity, indexCapacity) * sizeof(unsigned short));
-    SAFE_DELETE_ARRAY(oldIndices);
-
     // Assign new capacities
     _capacity = capacity;
     _vertexCapacity = vertexCapacity;
     _indexCapacity = indexCapacity;
 
-    // Update our vertex attribute bindings now that our client array pointers have changed
-    updateVertexAttributeBinding();
-
     return true;
 }
 
+void MeshBatch::upload()
+{
+    // Alternate between two sets of buffers, and orphan the previous contents of the one
+    // written so that the driver does not stall on draws that are still using them.
+    _bufferIndex = 1 - _bufferIndex;
+
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffers[_bufferIndex]->getVertexBuffer()) );
+    GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertexCount * _vertexFormat.getVertexSize(), NULL, GL_STREAM_DRAW) );
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, _vertexCount * _vertexFormat.getVertexSize(), _vertices) );
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+
+    if (_indexed)
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffers[_bufferIndex]) );
+        GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexCount * sizeof(unsigned short), NULL, GL_STREAM_DRAW) );
+        GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, _indexCount * sizeof(unsigned short), _indices) );
+    }
+
+    for (size_t i = 0, count = _passBindings.size(); i < count; ++i)
+    {
+        _passBindings[i].pass->setVertexAttributeBinding(_passBindings[i].bindings[_bufferIndex]);
+    }
+    _dirty = false;
+}
+
 void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
 {
     add(vertices, sizeof(float), vertexCount, indices, indexCount);
@@ -229,6 +345,7 @@ void MeshBatch::start()
     _verticesPtr = _vertices;
     _indicesPtr = _indices;
     _started = true;
+    _dirty = true;
 }
 
 bool MeshBatch::isStarted() const
@@ -246,13 +363,9 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-
     GP_ASSERT(_material);
-    if (_indexed)
-        GP_ASSERT(_indices);
+    if (_dirty)
+        upload();
 
     // Bind the material.
     Technique* technique = _material->getTechnique();
@@ -266,7 +379,9 @@ void MeshBatch::draw()
 
         if (_indexed)
         {
-            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
+            // The element array buffer is bound after the pass, since it is part of the vertex array state.
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffers[_bufferIndex]) );
+            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)0) );
         }
         else
         {
@@ -275,7 +390,8 @@ void MeshBatch::draw()
 
         pass->unbind();
     }
+
+    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
 }
-    
 
 }
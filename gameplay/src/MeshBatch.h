@@ -7,9 +7,17 @@ namespace gameplay
 {
 
 class Material;
+class Pass;
+class VertexAttributeBinding;
 
 /**
  * Defines a class for rendering multiple mesh into a single draw call on the graphics device.
+ *
+ * Primitives are gathered in client memory, either copied in with add() or written in place
+ * with allocate(), and uploaded to vertex and index buffers the first time the batch is drawn
+ * after it has changed. The batch alternates between two sets of buffers and orphans the set
+ * it uploads to, so that filling a batch again does not wait for the GPU to finish drawing its
+ * previous contents.
  */
 class MeshBatch
 {
@@ -23,7 +31,7 @@ public:
      * @param materialPath Path to a material file to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Minimum amount to grow the batch by when it overflows (a value of zero prevents batch growing).
      *
      * @return A new mesh batch.
      * @script{create}
@@ -38,7 +46,7 @@ public:
      * @param material Material to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Minimum amount to grow the batch by when it overflows (a value of zero prevents batch growing).
      *
      * @return A new mesh batch.
      * @script{create}
@@ -64,6 +72,42 @@ public:
      */
     void setCapacity(unsigned int capacity);
 
+    /**
+     * Grows the batch, if needed, so that the given number of vertices and indices can be
+     * added to it without growing again.
+     *
+     * When the batch overflows it at least doubles its capacity, so reserving space is only
+     * needed to avoid the intermediate copies of a batch that is filled a little at a time.
+     *
+     * @param vertexCount The number of vertices to make room for, in addition to those in the batch.
+     * @param indexCount The number of indices to make room for, in addition to those in the batch.
+     *
+     * @return true if the batch has room for the vertices and indices, false otherwise.
+     */
+    bool reserve(unsigned int vertexCount, unsigned int indexCount = 0);
+
+    /**
+     * Adds a group of primitives to the batch and returns the memory of their vertices and
+     * indices, to be written in place by the caller.
+     *
+     * This avoids the copy made by add() for primitives that are generated every frame. The
+     * returned memory holds vertexCount vertices in the vertex format of the batch. For indexed
+     * batches, the indexCount indices are written to the array returned in indices, and must be
+     * offset by baseVertex, the index of the first allocated vertex in the batch. The degenerate
+     * triangles that stitch separate triangle strips together are added by the batch.
+     *
+     * The memory remains valid until the batch is next added to, started or resized.
+     *
+     * @param vertexCount The number of vertices to allocate.
+     * @param indexCount The number of indices to allocate (should be zero for non-indexed batches).
+     * @param indices Set to the indices to write, for indexed batches.
+     * @param baseVertex Set to the index of the first allocated vertex, if not NULL.
+     *
+     * @return The vertices to write, or NULL if the batch could not grow to hold them.
+     * @script{ignore}
+     */
+    void* allocate(unsigned int vertexCount, unsigned int indexCount = 0, unsigned short** indices = NULL, unsigned int* baseVertex = NULL);
+
     /**
      * Returns the material for this mesh batch.
      *
@@ -138,11 +182,22 @@ public:
 
     /**
      * Draws the primitives currently in batch.
+     *
+     * The primitives are uploaded to the graphics device the first time they are drawn.
      */
     void draw();
 
 private:
 
+    /**
+     * The vertex attribute bindings of a pass of the material, one for each vertex buffer.
+     */
+    struct PassBinding
+    {
+        Pass* pass;
+        VertexAttributeBinding* bindings[2];
+    };
+
     /**
      * Constructor.
      */
@@ -164,6 +219,16 @@ private:
 
     bool resize(unsigned int capacity);
 
+    /**
+     * Grows the batch geometrically until it can hold the given total numbers of vertices and indices.
+     */
+    bool grow(unsigned int vertexCount, unsigned int indexCount);
+
+    /**
+     * Uploads the primitives in the batch to the next set of buffers.
+     */
+    void upload();
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -179,6 +244,11 @@ private:
     unsigned short* _indices;
     unsigned short* _indicesPtr;
     bool _started;
+    bool _dirty;
+    Mesh* _vertexBuffers[2];
+    IndexBufferHandle _indexBuffers[2];
+    unsigned int _bufferIndex;
+    std::vector<PassBinding> _passBindings;
 
 };
 
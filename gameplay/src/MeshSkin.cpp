@@ -2,6 +2,9 @@
 #include "MeshSkin.h"
 #include "Joint.h"
 #include "Model.h"
+#include "Game.h"
+#include "PhysicsCollisionObject.h"
+#include "MathUtil.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
@@ -10,7 +13,7 @@ namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL), _paletteDirty(true), _jointOrderDirty(true)
 {
 }
 
@@ -29,6 +32,8 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _paletteDirty = true;
+    _jointOrderDirty = true;
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -121,6 +126,9 @@ void MeshSkin::setJointCount(unsigned int jointCount)
         _joints[i] = NULL;
     }
 
+    _paletteDirty = true;
+    _jointOrderDirty = true;
+
     // Rebuild the matrix palette. Each matrix is 3 rows of Vector4.
     SAFE_DELETE_ARRAY(_matrixPalette);
 
@@ -147,6 +155,8 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
     }
 
     _joints[index] = joint;
+    _paletteDirty = true;
+    _jointOrderDirty = true;
 
     if (joint)
     {
@@ -159,14 +169,167 @@ Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
-    for (size_t i = 0, count = _joints.size(); i < count; i++)
+    if (_paletteDirty)
     {
-        GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        const_cast<MeshSkin*>(this)->_paletteDirty = false;
+        for (size_t i = 0, count = _joints.size(); i < count; i++)
+        {
+            GP_ASSERT(_joints[i]);
+            _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        }
     }
     return _matrixPalette;
 }
 
+void MeshSkin::updateMatrixPalette()
+{
+    if (prepareMatrixPalette())
+        computeMatrixPalette();
+}
+
+void MeshSkin::updateMatrixPalettes(MeshSkin* const* skins, unsigned int count)
+{
+    GP_ASSERT(skins || count == 0);
+
+    // World matrices of nodes are resolved lazily, so the parents of the top-most joints
+    // are resolved on the calling thread before the palettes are computed in parallel.
+    std::vector<MeshSkin*> dirtySkins;
+    dirtySkins.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (skins[i] && skins[i]->prepareMatrixPalette())
+            dirtySkins.push_back(skins[i]);
+    }
+    if (dirtySkins.empty())
+        return;
+
+    JobScheduler* scheduler = Game::getInstance()->getJobScheduler();
+    if (scheduler)
+    {
+        scheduler->parallelFor((unsigned int)dirtySkins.size(), [&dirtySkins](unsigned int i)
+        {
+            dirtySkins[i]->computeMatrixPalette();
+        });
+    }
+    else
+    {
+        for (size_t i = 0, skinCount = dirtySkins.size(); i < skinCount; ++i)
+        {
+            dirtySkins[i]->computeMatrixPalette();
+        }
+    }
+}
+
+void MeshSkin::buildJointOrder()
+{
+    _jointOrder.clear();
+    _jointOrder.reserve(_joints.size());
+
+    // Sort the joints by their depth in the hierarchy, so that parents precede their children.
+    std::vector<std::pair<unsigned int, unsigned int> > depths;
+    depths.reserve(_joints.size());
+    for (size_t i = 0, count = _joints.size(); i < count; ++i)
+    {
+        GP_ASSERT(_joints[i]);
+        unsigned int depth = 0;
+        for (Node* node = _joints[i]->getParent(); node != NULL; node = node->getParent())
+        {
+            ++depth;
+        }
+        depths.push_back(std::make_pair(depth, (unsigned int)i));
+    }
+    std::stable_sort(depths.begin(), depths.end());
+
+    std::map<Node*, int> indices;
+    for (size_t i = 0, count = depths.size(); i < count; ++i)
+    {
+        JointEntry entry;
+        entry.joint = _joints[depths[i].second];
+        entry.parentNode = entry.joint->getParent();
+        std::map<Node*, int>::const_iterator itr = indices.find(entry.parentNode);
+        entry.parent = itr != indices.end() ? itr->second : -1;
+        entry.detached = false;
+        entry.paletteIndex = depths[i].second * PALETTE_ROWS;
+        Matrix::multiply(entry.joint->getInverseBindPose(), _bindShape, &entry.bindMatrix);
+
+        // A joint that is listed twice keeps the index of its first entry.
+        indices.insert(std::make_pair(static_cast<Node*>(entry.joint), (int)i));
+        _jointOrder.push_back(entry);
+    }
+
+    _jointWorld.resize(_jointOrder.size());
+    _jointOrderDirty = false;
+}
+
+bool MeshSkin::prepareMatrixPalette()
+{
+    if (!_paletteDirty || _joints.empty())
+        return false;
+    _paletteDirty = false;
+
+    // Rebuild the joint array if a joint has been moved in the hierarchy.
+    bool rebuild = _jointOrderDirty;
+    for (size_t i = 0, count = _jointOrder.size(); i < count && !rebuild; ++i)
+    {
+        rebuild = _jointOrder[i].joint->getParent() != _jointOrder[i].parentNode;
+    }
+    if (rebuild)
+        buildJointOrder();
+
+    for (size_t i = 0, count = _jointOrder.size(); i < count; ++i)
+    {
+        JointEntry& entry = _jointOrder[i];
+        PhysicsCollisionObject* collisionObject = entry.joint->_collisionObject;
+        entry.detached = collisionObject && !collisionObject->isKinematic();
+
+        // Seed the world matrices of the top-most joints with the world matrices of their parents.
+        if (entry.parent < 0)
+        {
+            if (entry.parentNode && !entry.detached)
+                _jointWorld[i] = entry.parentNode->getWorldMatrix();
+            else
+                _jointWorld[i].setIdentity();
+        }
+    }
+    return true;
+}
+
+void MeshSkin::computeMatrixPalette()
+{
+    GP_ASSERT(_matrixPalette);
+    GP_ASSERT(_jointWorld.size() == _jointOrder.size());
+
+    Matrix local;
+    for (size_t i = 0, count = _jointOrder.size(); i < count; ++i)
+    {
+        const JointEntry& entry = _jointOrder[i];
+        Joint* joint = entry.joint;
+
+        // Compose the local matrix in TRS order from the transform of the joint, which is only read,
+        // rather than with Transform::getMatrix(), which caches it.
+        const Vector3& s = joint->getScale();
+        const Quaternion& q = joint->getRotation();
+        const Vector3& t = joint->getTranslation();
+        float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+        float xx2 = q.x * x2, yy2 = q.y * y2, zz2 = q.z * z2;
+        float xy2 = q.x * y2, xz2 = q.x * z2, yz2 = q.y * z2;
+        float wx2 = q.w * x2, wy2 = q.w * y2, wz2 = q.w * z2;
+        float* m = local.m;
+        m[0] = (1.0f - yy2 - zz2) * s.x;  m[1] = (xy2 + wz2) * s.x;         m[2] = (xz2 - wy2) * s.x;          m[3] = 0.0f;
+        m[4] = (xy2 - wz2) * s.y;         m[5] = (1.0f - xx2 - zz2) * s.y;  m[6] = (yz2 + wx2) * s.y;          m[7] = 0.0f;
+        m[8] = (xz2 + wy2) * s.z;         m[9] = (yz2 - wx2) * s.z;         m[10] = (1.0f - xx2 - yy2) * s.z;  m[11] = 0.0f;
+        m[12] = t.x;                      m[13] = t.y;                      m[14] = t.z;                       m[15] = 1.0f;
+
+        Matrix& world = _jointWorld[i];
+        if (entry.detached)
+            world = local;
+        else
+            Matrix::multiply(entry.parent >= 0 ? _jointWorld[entry.parent] : world, local, &world);
+
+        MathUtil::multiplyMatrixRows3x4(world.m, entry.bindMatrix.m, &_matrixPalette[entry.paletteIndex].x);
+    }
+}
+
 unsigned int MeshSkin::getMatrixPaletteSize() const
 {
     return (unsigned int)_joints.size() * PALETTE_ROWS;
@@ -270,6 +433,9 @@ void MeshSkin::clearJoints()
         SAFE_RELEASE(_joints[i]);
     }
     _joints.clear();
+    _jointOrder.clear();
+    _jointWorld.clear();
+    _jointOrderDirty = true;
 }
 
 }
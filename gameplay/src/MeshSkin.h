@@ -19,6 +19,14 @@ class Joint;
  * vertex blending. This allows for a Model's mesh to support
  * a skeleton on joints that will influence the vertex position
  * and which the joints can be animated.
+ *
+ * The matrix palette is updated lazily when the skin is drawn. Games that draw
+ * many skinned models can instead update their palettes up front, in parallel,
+ * once their joints have been animated:
+ *
+ * @code
+ * MeshSkin::updateMatrixPalettes(&skins[0], (unsigned int)skins.size());
+ * @endcode
  */
 class MeshSkin : public Transform::Listener
 {
@@ -106,6 +114,33 @@ public:
      */
     unsigned int getMatrixPaletteSize() const;
 
+    /**
+     * Updates the matrix palette from the current transforms of the joints.
+     *
+     * The joints are processed as a flat array in hierarchy order, computing their world
+     * matrices from their local transforms rather than through Node::getWorldMatrix(),
+     * and writing the rows of each skinning matrix directly into the palette. Only the
+     * parents of the top-most joints are resolved through their nodes.
+     *
+     * This does nothing if no joint transform has changed since the palette was last updated.
+     */
+    void updateMatrixPalette();
+
+    /**
+     * Updates the matrix palettes of several skins in parallel, on the worker threads of the
+     * Game's JobScheduler.
+     *
+     * This must be called from the thread that updates the scene. The transforms of the
+     * joints must not change while it runs.
+     *
+     * @param skins The skins to update.
+     * @param count The number of skins.
+     *
+     * @see updateMatrixPalette()
+     * @script{ignore}
+     */
+    static void updateMatrixPalettes(MeshSkin* const* skins, unsigned int count);
+
     /**
      * Returns our parent Model.
      */
@@ -118,6 +153,23 @@ public:
 
 private:
 
+    /**
+     * A joint in the flat array of joints, in which parents precede their children.
+     */
+    struct JointEntry
+    {
+        Joint* joint;
+        // The parent node of the joint when the array was built.
+        Node* parentNode;
+        // The index of the parent joint in the array, or -1 if the parent is not a joint of this skin.
+        int parent;
+        // Whether the world matrix of the joint is its local matrix, such as for dynamic physics bodies.
+        bool detached;
+        unsigned int paletteIndex;
+        // The inverse bind pose of the joint multiplied by the bind shape.
+        Matrix bindMatrix;
+    };
+
     /**
      * Constructor.
      */
@@ -175,6 +227,23 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Sorts the joints into the flat array in hierarchy order.
+     */
+    void buildJointOrder();
+
+    /**
+     * Prepares the flat update of the palette on the calling thread, resolving the world matrices
+     * of the parents of the top-most joints. Returns false if the palette is up to date.
+     */
+    bool prepareMatrixPalette();
+
+    /**
+     * Computes the world matrices of the joints and the palette from the prepared flat array.
+     * Only reads the joints, so that several skins may be computed at once.
+     */
+    void computeMatrixPalette();
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -190,6 +259,12 @@ private:
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
     Model* _model;
+    // Whether a joint transform has changed since the palette was updated.
+    bool _paletteDirty;
+    // Whether the joints or their bind matrices changed since the flat joint array was built.
+    bool _jointOrderDirty;
+    std::vector<JointEntry> _jointOrder;
+    std::vector<Matrix> _jointWorld;
 };
 
 }
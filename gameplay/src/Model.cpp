@@ -10,12 +10,12 @@ namespace gameplay
 {
 
 Model::Model() : Drawable(),
-    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL)
+    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL), _instanceBuffer(0)
 {
 }
 
 Model::Model(Mesh* mesh) : Drawable(),
-    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL)
+    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL), _instanceBuffer(0)
 {
     GP_ASSERT(mesh);
     _partCount = mesh->getPartCount();
@@ -34,6 +34,12 @@ Model::~Model()
     }
     SAFE_RELEASE(_mesh);
     SAFE_DELETE(_skin);
+
+    if (_instanceBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_instanceBuffer) );
+        _instanceBuffer = 0;
+    }
 }
 
 Model* Model::create(Mesh* mesh)
@@ -143,19 +149,8 @@ void Model::setMaterial(Material* material, int partIndex)
     if (material)
     {
         // Hookup vertex attribute bindings for all passes in the new material.
-        for (unsigned int i = 0, tCount = material->getTechniqueCount(); i < tCount; ++i)
-        {
-            Technique* t = material->getTechniqueByIndex(i);
-            GP_ASSERT(t);
-            for (unsigned int j = 0, pCount = t->getPassCount(); j < pCount; ++j)
-            {
-                Pass* p = t->getPassByIndex(j);
-                GP_ASSERT(p);
-                VertexAttributeBinding* b = VertexAttributeBinding::create(_mesh, p->getEffect());
-                p->setVertexAttributeBinding(b);
-                SAFE_RELEASE(b);
-            }
-        }
+        setMaterialVertexAttributeBinding(material);
+
         // Apply node binding for the new material.
         if (_node)
         {
@@ -212,6 +207,77 @@ MeshSkin* Model::getSkin() const
     return _skin;
 }
 
+void Model::setInstanceTransforms(const Matrix* transforms, unsigned int count)
+{
+    GP_ASSERT(_mesh);
+    GP_ASSERT(transforms || count == 0);
+
+    if (count == 0)
+    {
+        _instanceTransforms.clear();
+    }
+    else
+    {
+        _instanceTransforms.assign(transforms, transforms + count);
+
+        // Merge the bounds of the mesh at every instance.
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            BoundingSphere bounds(_mesh->getBoundingSphere());
+            bounds.transform(transforms[i]);
+            if (i == 0)
+                _instanceBounds.set(bounds);
+            else
+                _instanceBounds.merge(bounds);
+        }
+
+        if (VertexAttributeBinding::isInstancingSupported())
+        {
+            bool createBuffer = (_instanceBuffer == 0);
+            if (createBuffer)
+            {
+                GL_ASSERT( glGenBuffers(1, &_instanceBuffer) );
+            }
+
+            // Orphan the previous contents so that the driver does not stall on draws still using them.
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+            GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix) * count, NULL, GL_STREAM_DRAW) );
+            GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Matrix) * count, &_instanceTransforms[0]) );
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+
+            // The instance matrices are sourced by the vertex attribute bindings of the passes,
+            // which only reference the buffer and so only need to be created once.
+            if (createBuffer)
+            {
+                if (_material)
+                    setMaterialVertexAttributeBinding(_material);
+                if (_partMaterials)
+                {
+                    for (unsigned int i = 0; i < _partCount; ++i)
+                    {
+                        if (_partMaterials[i])
+                            setMaterialVertexAttributeBinding(_partMaterials[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    if (_node)
+        _node->setBoundsDirty();
+}
+
+unsigned int Model::getInstanceCount() const
+{
+    return (unsigned int)_instanceTransforms.size();
+}
+
+const BoundingSphere& Model::getBoundingSphere() const
+{
+    GP_ASSERT(_mesh);
+    return _instanceTransforms.empty() ? _mesh->getBoundingSphere() : _instanceBounds;
+}
+
 void Model::setSkin(MeshSkin* skin)
 {
     if (_skin != skin)
@@ -345,10 +411,7 @@ unsigned int Model::draw(bool wireframe)
                 GP_ASSERT(pass);
                 pass->bind();
                 GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (!wireframe || !drawWireframe(_mesh))
-                {
-                    GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
-                }
+                drawPart(NULL, wireframe);
                 pass->unbind();
             }
         }
@@ -373,10 +436,7 @@ unsigned int Model::draw(bool wireframe)
                     GP_ASSERT(pass);
                     pass->bind();
                     GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (!wireframe || !drawWireframe(part))
-                    {
-                        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
-                    }
+                    drawPart(part, wireframe);
                     pass->unbind();
                 }
             }
@@ -385,6 +445,62 @@ unsigned int Model::draw(bool wireframe)
     return partCount;
 }
 
+void Model::drawPart(MeshPart* part, bool wireframe)
+{
+    GP_ASSERT(_mesh);
+
+    unsigned int instanceCount = (unsigned int)_instanceTransforms.size();
+#ifdef GP_USE_INSTANCING
+    if (instanceCount > 0 && _instanceBuffer)
+    {
+        // All of the instances in one draw call, with the matrices sourced from the instance buffer.
+        if (part)
+        {
+            GL_ASSERT( glDrawElementsInstanced(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0, instanceCount) );
+        }
+        else
+        {
+            GL_ASSERT( glDrawArraysInstanced(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount(), instanceCount) );
+        }
+        return;
+    }
+#endif
+
+    // Without hardware instancing, draw the instances one at a time with the
+    // instance matrix set as a constant vertex attribute.
+    VertexAttribute instanceAttrib = -1;
+    if (instanceCount > 0)
+    {
+        Effect* effect = Effect::getCurrentEffect();
+        GP_ASSERT(effect);
+        instanceAttrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+    }
+
+    for (unsigned int i = 0; i < std::max(instanceCount, 1u); ++i)
+    {
+        if (instanceAttrib != -1)
+        {
+            const float* m = _instanceTransforms[i].m;
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                GL_ASSERT( glVertexAttrib4fv(instanceAttrib + column, m + column * 4) );
+            }
+        }
+
+        if (part)
+        {
+            if (!wireframe || !drawWireframe(part))
+            {
+                GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+            }
+        }
+        else if (!wireframe || !drawWireframe(_mesh))
+        {
+            GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+        }
+    }
+}
+
 void Model::setMaterialNodeBinding(Material *material)
 {
     GP_ASSERT(material);
@@ -395,6 +511,25 @@ void Model::setMaterialNodeBinding(Material *material)
     }
 }
 
+void Model::setMaterialVertexAttributeBinding(Material* material)
+{
+    GP_ASSERT(material);
+
+    for (unsigned int i = 0, tCount = material->getTechniqueCount(); i < tCount; ++i)
+    {
+        Technique* t = material->getTechniqueByIndex(i);
+        GP_ASSERT(t);
+        for (unsigned int j = 0, pCount = t->getPassCount(); j < pCount; ++j)
+        {
+            Pass* p = t->getPassByIndex(j);
+            GP_ASSERT(p);
+            VertexAttributeBinding* b = VertexAttributeBinding::create(_mesh, p->getEffect(), _instanceBuffer);
+            p->setVertexAttributeBinding(b);
+            SAFE_RELEASE(b);
+        }
+    }
+}
+
 Drawable* Model::clone(NodeCloneContext& context)
 {
     Model* model = Model::create(getMesh());
@@ -432,6 +567,10 @@ Drawable* Model::clone(NodeCloneContext& context)
             }
         }
     }
+    if (!_instanceTransforms.empty())
+    {
+        model->setInstanceTransforms(&_instanceTransforms[0], (unsigned int)_instanceTransforms.size());
+    }
     return model;
 }
 
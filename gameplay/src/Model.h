@@ -25,6 +25,7 @@ class Model : public Ref, public Drawable
     friend class Scene;
     friend class Mesh;
     friend class Bundle;
+    friend class RenderQueue;
 
 public:
 
@@ -130,6 +131,42 @@ public:
      */
     MeshSkin* getSkin() const;
 
+    /**
+     * Sets the transforms of the instances of this model.
+     *
+     * When one or more instances are set, every mesh part and pass of the model draws all of
+     * the instances with a single instanced draw call. The transforms are relative to the node
+     * of the model and are uploaded to a streamed vertex buffer on every call. Effects used to
+     * draw instanced models must be compiled with the INSTANCED define, which transforms each
+     * vertex by the per-instance 'a_instanceMatrix' attribute.
+     *
+     * On devices without hardware instancing the instances are drawn one at a time, with the
+     * matrix set as a constant vertex attribute. Instanced draws ignore the wireframe flag
+     * of draw() when hardware instancing is used.
+     *
+     * @param transforms The transform of each instance, relative to the node of the model.
+     * @param count The number of instances, or zero to draw the model once without instancing.
+     * @script{ignore}
+     */
+    void setInstanceTransforms(const Matrix* transforms, unsigned int count);
+
+    /**
+     * Gets the number of instances of this model.
+     *
+     * @return The number of instances, or zero if the model is not instanced.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Gets the bounding sphere of the model, in the local space of its node.
+     *
+     * This is the bounding sphere of the mesh, or of all of the instances of the mesh when the
+     * model is instanced.
+     *
+     * @return The bounding sphere of the model.
+     */
+    const BoundingSphere& getBoundingSphere() const;
+
     /**
      * @see Drawable::draw
      *
@@ -185,6 +222,21 @@ private:
      */
     void setMaterialNodeBinding(Material *m);
 
+    /**
+     * Sets the vertex attribute bindings of all of the passes of the specified material.
+     */
+    void setMaterialVertexAttributeBinding(Material* material);
+
+    /**
+     * Issues the draw call for a mesh part, or for the whole mesh if part is NULL.
+     *
+     * The pass to draw with and the index buffer of the part must already be bound.
+     *
+     * @param part The mesh part to draw, or NULL to draw the mesh without an index buffer.
+     * @param wireframe true to draw the wireframe only.
+     */
+    void drawPart(MeshPart* part, bool wireframe);
+
     void validatePartCount();
 
     Mesh* _mesh;
@@ -192,6 +244,9 @@ private:
     unsigned int _partCount;
     Material** _partMaterials;
     MeshSkin* _skin;
+    std::vector<Matrix> _instanceTransforms;
+    VertexBufferHandle _instanceBuffer;
+    BoundingSphere _instanceBounds;
 };
 
 }
@@ -26,7 +26,7 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0), _enabled(true), _tags(NULL),
     _drawable(NULL), _camera(NULL), _light(NULL), _audioSource(NULL), _collisionObject(NULL), _agent(NULL), _userObject(NULL),
-      _dirtyBits(NODE_DIRTY_ALL)
+      _dirtyBits(NODE_DIRTY_ALL), _spatialIndexProxy(-1), _spatialIndexDirty(false)
 {
     GP_REGISTER_SCRIPT_EVENTS();
     if (id)
@@ -122,6 +122,13 @@ void Node::addChild(Node* child)
     ++_childCount;
     setBoundsDirty();
 
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->transformHierarchyChanged();
+        scene->addToSpatialIndex(child);
+    }
+
     if (_dirtyBits & NODE_DIRTY_HIERARCHY)
     {
         hierarchyChanged();
@@ -153,6 +160,13 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->transformHierarchyChanged();
+        scene->removeFromSpatialIndex(this);
+    }
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -466,6 +480,25 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
+void Node::resolveWorldMatrix() const
+{
+    if ((_dirtyBits & NODE_DIRTY_WORLD) == 0)
+        return;
+    _dirtyBits &= ~NODE_DIRTY_WORLD;
+
+    if (!isStatic())
+    {
+        if (_parent && (!_collisionObject || _collisionObject->isKinematic()))
+        {
+            Matrix::multiply(_parent->_world, getMatrix(), &_world);
+        }
+        else
+        {
+            _world = getMatrix();
+        }
+    }
+}
+
 const Matrix& Node::getWorldViewMatrix() const
 {
     static Matrix worldView;
@@ -658,6 +691,8 @@ void Node::transformChanged()
 {
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    if (_spatialIndexProxy >= 0 && !_spatialIndexDirty)
+        spatialIndexChanged();
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -683,12 +718,21 @@ void Node::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
     _dirtyBits |= NODE_DIRTY_BOUNDS;
+    if (_spatialIndexProxy >= 0 && !_spatialIndexDirty)
+        spatialIndexChanged();
 
     // Mark our parent bounds as dirty as well
     if (_parent)
         _parent->setBoundsDirty();
 }
 
+void Node::spatialIndexChanged()
+{
+    Scene* scene = getScene();
+    if (scene)
+        scene->spatialIndexChanged(this);
+}
+
 Animation* Node::getAnimation(const char* id) const
 {
     Animation* animation = ((AnimationTarget*)this)->getAnimation(id);
@@ -798,6 +842,10 @@ void Node::setLight(Light* light)
         _light->setNode(this);
     }
 
+    Scene* scene = getScene();
+    if (scene)
+        scene->updateSpatialIndex(this);
+
     setBoundsDirty();
 }
 
@@ -827,6 +875,10 @@ void Node::setDrawable(Drawable* drawable)
                 ref->addRef();
             _drawable->setNode(this);
         }
+
+        Scene* scene = getScene();
+        if (scene)
+            scene->updateSpatialIndex(this);
     }
     setBoundsDirty();
 }
@@ -853,12 +905,12 @@ const BoundingSphere& Node::getBoundingSphere() const
         {
             if (empty)
             {
-                _bounds.set(model->getMesh()->getBoundingSphere());
+                _bounds.set(model->getBoundingSphere());
                 empty = false;
             }
             else
             {
-                _bounds.merge(model->getMesh()->getBoundingSphere());
+                _bounds.merge(model->getBoundingSphere());
             }
         }
         if (_light)
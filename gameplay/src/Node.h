@@ -41,6 +41,7 @@ class Node : public Transform, public Ref
     friend class Bundle;
     friend class MeshSkin;
     friend class Light;
+    friend class Model;
 
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(update, "<Node>f");
@@ -665,6 +666,19 @@ protected:
      */
     void setBoundsDirty();
 
+    /**
+     * Queues the node to have its bounds updated in the spatial index of its scene.
+     */
+    void spatialIndexChanged();
+
+    /**
+     * Resolves the world matrix of this node if it is dirty, without recursing into the
+     * parent or children. The parent world matrix must already be resolved.
+     *
+     * Used by the Scene flat transform pass.
+     */
+    void resolveWorldMatrix() const;
+
     /**
      * Returns the first child node that matches the given ID.
      *
@@ -752,6 +766,10 @@ protected:
     mutable BoundingSphere _bounds;
     /** The dirty bits used for optimization. */
     mutable int _dirtyBits;
+    /** The proxy of this node in the spatial index of its scene, or -1 if it is not indexed. */
+    int _spatialIndexProxy;
+    /** If this node is queued to have its bounds updated in the spatial index. */
+    bool _spatialIndexDirty;
 };
 
 /**
@@ -0,0 +1,1110 @@
+#ifdef GP_USE_NULL_GL
+
+#include "Base.h"
+#include "NullGL.h"
+
+using gameplay::NullGL;
+
+namespace gameplay
+{
+
+static NullGL::Stats __currentStats;
+static NullGL::Stats __frameStats;
+static unsigned int __frameCount = 0;
+static bool __recording = false;
+static std::vector<NullGL::Command> __currentCommands;
+static std::vector<NullGL::Command> __frameCommands;
+
+NullGL::Stats::Stats()
+{
+    reset();
+}
+
+void NullGL::Stats::reset()
+{
+    drawCalls = 0;
+    vertices = 0;
+    clears = 0;
+    stateChanges = 0;
+    uniformUploads = 0;
+    bufferUploads = 0;
+    textureUploads = 0;
+    bytesUploaded = 0;
+}
+
+NullGL::NullGL()
+{
+}
+
+const NullGL::Stats& NullGL::getFrameStats()
+{
+    return __frameStats;
+}
+
+const NullGL::Stats& NullGL::getCurrentStats()
+{
+    return __currentStats;
+}
+
+unsigned int NullGL::getFrameCount()
+{
+    return __frameCount;
+}
+
+void NullGL::setRecording(bool enabled)
+{
+    __recording = enabled;
+    if (!enabled)
+    {
+        __currentCommands.clear();
+        __frameCommands.clear();
+    }
+}
+
+bool NullGL::isRecording()
+{
+    return __recording;
+}
+
+const std::vector<NullGL::Command>& NullGL::getFrameCommands()
+{
+    return __frameCommands;
+}
+
+void NullGL::endFrame()
+{
+    __frameStats = __currentStats;
+    __currentStats.reset();
+    if (__recording)
+    {
+        __frameCommands.swap(__currentCommands);
+        __currentCommands.clear();
+    }
+    ++__frameCount;
+}
+
+void NullGL::record(const char* function, CommandType type, unsigned int size)
+{
+    switch (type)
+    {
+    case COMMAND_DRAW:
+        ++__currentStats.drawCalls;
+        __currentStats.vertices += size;
+        break;
+    case COMMAND_CLEAR:
+        ++__currentStats.clears;
+        break;
+    case COMMAND_STATE:
+        ++__currentStats.stateChanges;
+        break;
+    case COMMAND_UNIFORM:
+        ++__currentStats.uniformUploads;
+        break;
+    case COMMAND_BUFFER_UPLOAD:
+        ++__currentStats.bufferUploads;
+        __currentStats.bytesUploaded += size;
+        break;
+    case COMMAND_TEXTURE_UPLOAD:
+        ++__currentStats.textureUploads;
+        __currentStats.bytesUploaded += size;
+        break;
+    default:
+        break;
+    }
+
+    if (__recording)
+    {
+        Command command;
+        command.function = function;
+        command.type = type;
+        command.size = size;
+        __currentCommands.push_back(command);
+    }
+}
+
+}
+
+// Object state tracked by the stubs. Only what the engine reads back is kept:
+// buffer sizes (for mapping), and the attribute/uniform declarations of each
+// program so that Effect reflection behaves like it does on a real driver.
+
+struct NullGLVariable
+{
+    std::string name;
+    GLenum type;
+    GLint size;
+    GLint location;
+};
+
+struct NullGLShader
+{
+    std::vector<NullGLVariable> attributes;
+    std::vector<NullGLVariable> uniforms;
+};
+
+struct NullGLBuffer
+{
+    NullGLBuffer() : size(0) { }
+    size_t size;
+    std::vector<unsigned char> storage;
+};
+
+struct NullGLProgram
+{
+    std::vector<GLuint> shaders;
+    std::vector<NullGLVariable> attributes;
+    std::vector<NullGLVariable> uniforms;
+};
+
+static GLuint __nextHandle = 1;
+static GLuint __arrayBuffer = 0;
+static GLuint __elementArrayBuffer = 0;
+static GLuint __framebuffer = 0;
+static std::map<GLuint, NullGLBuffer> __buffers;
+static std::map<GLuint, NullGLShader> __shaders;
+static std::map<GLuint, NullGLProgram> __programs;
+
+static void generateHandles(GLsizei n, GLuint* handles)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        handles[i] = __nextHandle++;
+}
+
+static GLuint& boundBuffer(GLenum target)
+{
+    return target == GL_ELEMENT_ARRAY_BUFFER ? __elementArrayBuffer : __arrayBuffer;
+}
+
+static unsigned int getPixelSize(GLenum format, GLenum type)
+{
+    if (type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1)
+        return 2;
+
+    unsigned int components;
+    switch (format)
+    {
+    case GL_RGBA:
+        components = 4;
+        break;
+    case GL_RGB:
+        components = 3;
+        break;
+    case GL_LUMINANCE_ALPHA:
+        components = 2;
+        break;
+    default:
+        components = 1;
+        break;
+    }
+    return components * (type == GL_FLOAT ? 4 : (type == GL_UNSIGNED_SHORT ? 2 : 1));
+}
+
+static GLenum getVariableType(const std::string& type)
+{
+    if (type == "float") return GL_FLOAT;
+    if (type == "vec2") return GL_FLOAT_VEC2;
+    if (type == "vec3") return GL_FLOAT_VEC3;
+    if (type == "vec4") return GL_FLOAT_VEC4;
+    if (type == "mat2") return GL_FLOAT_MAT2;
+    if (type == "mat3") return GL_FLOAT_MAT3;
+    if (type == "mat4") return GL_FLOAT_MAT4;
+    if (type == "int") return GL_INT;
+    if (type == "bool") return GL_BOOL;
+    if (type == "sampler2D") return GL_SAMPLER_2D;
+    if (type == "samplerCube") return GL_SAMPLER_CUBE;
+    return GL_FLOAT;
+}
+
+/**
+ * Evaluates the expressions of #if directives found in the engine shaders:
+ * integer literals, macros, defined(), unary !, comparisons, && and ||.
+ */
+class NullGLExpression
+{
+public:
+
+    NullGLExpression(const char* text, const std::map<std::string, std::string>& defines)
+        : _p(text), _defines(defines)
+    {
+    }
+
+    int evaluate()
+    {
+        return parseOr();
+    }
+
+private:
+
+    void skipSpaces()
+    {
+        while (*_p == ' ' || *_p == '\t')
+            ++_p;
+    }
+
+    bool accept(const char* token)
+    {
+        skipSpaces();
+        size_t len = strlen(token);
+        if (strncmp(_p, token, len) == 0)
+        {
+            _p += len;
+            return true;
+        }
+        return false;
+    }
+
+    std::string identifier()
+    {
+        skipSpaces();
+        const char* start = _p;
+        while (isalnum(*_p) || *_p == '_')
+            ++_p;
+        return std::string(start, _p);
+    }
+
+    int parseOr()
+    {
+        int value = parseAnd();
+        while (accept("||"))
+            value = parseAnd() || value;
+        return value;
+    }
+
+    int parseAnd()
+    {
+        int value = parseCompare();
+        while (accept("&&"))
+            value = parseCompare() && value;
+        return value;
+    }
+
+    int parseCompare()
+    {
+        int value = parseSum();
+        if (accept(">=")) return value >= parseSum();
+        if (accept("<=")) return value <= parseSum();
+        if (accept("==")) return value == parseSum();
+        if (accept("!=")) return value != parseSum();
+        if (accept(">")) return value > parseSum();
+        if (accept("<")) return value < parseSum();
+        return value;
+    }
+
+    int parseSum()
+    {
+        int value = parseProduct();
+        for (;;)
+        {
+            if (accept("+")) value += parseProduct();
+            else if (accept("-")) value -= parseProduct();
+            else return value;
+        }
+    }
+
+    int parseProduct()
+    {
+        int value = parseUnary();
+        while (accept("*"))
+            value *= parseUnary();
+        return value;
+    }
+
+    int parseUnary()
+    {
+        if (accept("!"))
+            return !parseUnary();
+        if (accept("("))
+        {
+            int value = parseOr();
+            accept(")");
+            return value;
+        }
+        skipSpaces();
+        if (isdigit(*_p))
+            return (int)strtol(_p, (char**)&_p, 10);
+
+        std::string name = identifier();
+        if (name == "defined")
+        {
+            bool paren = accept("(");
+            std::string macro = identifier();
+            if (paren)
+                accept(")");
+            return _defines.find(macro) != _defines.end() ? 1 : 0;
+        }
+        std::map<std::string, std::string>::const_iterator itr = _defines.find(name);
+        if (itr == _defines.end() || itr->second.empty())
+            return 0;
+        return NullGLExpression(itr->second.c_str(), _defines).evaluate();
+    }
+
+    const char* _p;
+    const std::map<std::string, std::string>& _defines;
+};
+
+// Extracts the active attribute and uniform declarations from GLSL source,
+// honoring the preprocessor conditionals used by the engine shaders.
+static void reflectShader(const std::string& source, NullGLShader& shader)
+{
+    std::map<std::string, std::string> defines;
+    std::vector<bool> active;
+    std::vector<bool> taken;
+    std::istringstream stream(source);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos)
+            continue;
+        const char* text = line.c_str() + start;
+        bool enabled = active.empty() || active.back();
+
+        if (*text == '#')
+        {
+            std::istringstream directive(line.substr(start + 1));
+            std::string keyword;
+            directive >> keyword;
+            std::string rest;
+            std::getline(directive, rest);
+            if (keyword == "if" || keyword == "ifdef" || keyword == "ifndef")
+            {
+                bool value;
+                if (keyword == "if")
+                    value = NullGLExpression(rest.c_str(), defines).evaluate() != 0;
+                else
+                {
+                    std::istringstream macro(rest);
+                    std::string name;
+                    macro >> name;
+                    value = (defines.find(name) != defines.end()) == (keyword == "ifdef");
+                }
+                active.push_back(enabled && value);
+                taken.push_back(value);
+            }
+            else if (keyword == "elif" && !active.empty())
+            {
+                bool parent = active.size() < 2 || active[active.size() - 2];
+                bool value = !taken.back() && NullGLExpression(rest.c_str(), defines).evaluate() != 0;
+                active.back() = parent && value;
+                taken.back() = taken.back() || value;
+            }
+            else if (keyword == "else" && !active.empty())
+            {
+                bool parent = active.size() < 2 || active[active.size() - 2];
+                active.back() = parent && !taken.back();
+                taken.back() = true;
+            }
+            else if (keyword == "endif" && !active.empty())
+            {
+                active.pop_back();
+                taken.pop_back();
+            }
+            else if (keyword == "define" && enabled)
+            {
+                std::istringstream macro(rest);
+                std::string name, value;
+                macro >> name;
+                std::getline(macro, value);
+                size_t first = value.find_first_not_of(" \t");
+                defines[name] = first == std::string::npos ? "" : value.substr(first);
+            }
+            else if (keyword == "undef" && enabled)
+            {
+                std::istringstream macro(rest);
+                std::string name;
+                macro >> name;
+                defines.erase(name);
+            }
+            continue;
+        }
+
+        if (!enabled)
+            continue;
+
+        std::istringstream declaration(line);
+        std::string qualifier;
+        declaration >> qualifier;
+        std::vector<NullGLVariable>* variables = NULL;
+        if (qualifier == "attribute")
+            variables = &shader.attributes;
+        else if (qualifier == "uniform")
+            variables = &shader.uniforms;
+        if (!variables)
+            continue;
+
+        std::string type;
+        declaration >> type;
+        if (type == "lowp" || type == "mediump" || type == "highp")
+            declaration >> type;
+        std::string name;
+        std::getline(declaration, name, ';');
+
+        NullGLVariable variable;
+        variable.type = getVariableType(type);
+        variable.size = 1;
+        variable.location = -1;
+        size_t bracket = name.find('[');
+        if (bracket != std::string::npos)
+        {
+            std::string count = name.substr(bracket + 1, name.find(']') - bracket - 1);
+            variable.size = std::max(1, NullGLExpression(count.c_str(), defines).evaluate());
+            name = name.substr(0, bracket);
+        }
+        size_t first = name.find_first_not_of(" \t");
+        size_t last = name.find_last_not_of(" \t");
+        if (first == std::string::npos)
+            continue;
+        variable.name = name.substr(first, last - first + 1);
+        variables->push_back(variable);
+    }
+}
+
+static void mergeVariables(const std::vector<NullGLVariable>& source, std::vector<NullGLVariable>& destination)
+{
+    for (size_t i = 0, count = source.size(); i < count; ++i)
+    {
+        bool found = false;
+        for (size_t j = 0, existing = destination.size(); j < existing && !found; ++j)
+            found = destination[j].name == source[i].name;
+        if (!found)
+            destination.push_back(source[i]);
+    }
+}
+
+static const NullGLVariable* findVariable(const std::vector<NullGLVariable>& variables, GLuint index)
+{
+    return index < variables.size() ? &variables[index] : NULL;
+}
+
+static void getActiveVariable(const NullGLVariable* variable, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    if (!variable)
+        return;
+    GLsizei written = std::min((GLsizei)variable->name.length(), bufSize - 1);
+    if (name && bufSize > 0)
+    {
+        memcpy(name, variable->name.c_str(), written);
+        name[written] = '\0';
+    }
+    if (length)
+        *length = written;
+    if (size)
+        *size = variable->size;
+    if (type)
+        *type = variable->type;
+}
+
+static GLint getMaxNameLength(const std::vector<NullGLVariable>& variables)
+{
+    GLint length = 0;
+    for (size_t i = 0, count = variables.size(); i < count; ++i)
+        length = std::max(length, (GLint)variables[i].name.length() + 1);
+    return length;
+}
+
+void nullglActiveTexture(GLenum texture)
+{
+    NullGL::record("glActiveTexture", NullGL::COMMAND_STATE);
+}
+
+void nullglAttachShader(GLuint program, GLuint shader)
+{
+    __programs[program].shaders.push_back(shader);
+    NullGL::record("glAttachShader", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglBindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+    NullGL::record("glBindAttribLocation", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglBindBuffer(GLenum target, GLuint buffer)
+{
+    boundBuffer(target) = buffer;
+    NullGL::record("glBindBuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    __framebuffer = framebuffer;
+    NullGL::record("glBindFramebuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    NullGL::record("glBindRenderbuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglBindTexture(GLenum target, GLuint texture)
+{
+    NullGL::record("glBindTexture", NullGL::COMMAND_STATE);
+}
+
+void nullglBindVertexArray(GLuint array)
+{
+    NullGL::record("glBindVertexArray", NullGL::COMMAND_STATE);
+}
+
+void nullglBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    NullGL::record("glBlendFunc", NullGL::COMMAND_STATE);
+}
+
+void nullglBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    // Shadow storage is only allocated once a buffer gets mapped.
+    NullGLBuffer& buffer = __buffers[boundBuffer(target)];
+    buffer.size = (size_t)size;
+    if (!buffer.storage.empty())
+        buffer.storage.resize(buffer.size);
+    NullGL::record("glBufferData", NullGL::COMMAND_BUFFER_UPLOAD, data ? (unsigned int)size : 0);
+}
+
+void nullglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    NullGL::record("glBufferSubData", NullGL::COMMAND_BUFFER_UPLOAD, (unsigned int)size);
+}
+
+GLenum nullglCheckFramebufferStatus(GLenum target)
+{
+    NullGL::record("glCheckFramebufferStatus", NullGL::COMMAND_QUERY);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void nullglClear(GLbitfield mask)
+{
+    NullGL::record("glClear", NullGL::COMMAND_CLEAR);
+}
+
+void nullglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    NullGL::record("glClearColor", NullGL::COMMAND_STATE);
+}
+
+void nullglClearDepth(GLdouble depth)
+{
+    NullGL::record("glClearDepth", NullGL::COMMAND_STATE);
+}
+
+void nullglClearStencil(GLint s)
+{
+    NullGL::record("glClearStencil", NullGL::COMMAND_STATE);
+}
+
+void nullglCompileShader(GLuint shader)
+{
+    NullGL::record("glCompileShader", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+{
+    NullGL::record("glCompressedTexImage2D", NullGL::COMMAND_TEXTURE_UPLOAD, (unsigned int)imageSize);
+}
+
+GLuint nullglCreateProgram()
+{
+    GLuint program = __nextHandle++;
+    __programs[program];
+    NullGL::record("glCreateProgram", NullGL::COMMAND_RESOURCE);
+    return program;
+}
+
+GLuint nullglCreateShader(GLenum type)
+{
+    GLuint shader = __nextHandle++;
+    __shaders[shader];
+    NullGL::record("glCreateShader", NullGL::COMMAND_RESOURCE);
+    return shader;
+}
+
+void nullglCullFace(GLenum mode)
+{
+    NullGL::record("glCullFace", NullGL::COMMAND_STATE);
+}
+
+void nullglDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        __buffers.erase(buffers[i]);
+    NullGL::record("glDeleteBuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    NullGL::record("glDeleteFramebuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteProgram(GLuint program)
+{
+    __programs.erase(program);
+    NullGL::record("glDeleteProgram", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+    NullGL::record("glDeleteRenderbuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteShader(GLuint shader)
+{
+    __shaders.erase(shader);
+    NullGL::record("glDeleteShader", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    NullGL::record("glDeleteTextures", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    NullGL::record("glDeleteVertexArrays", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglDepthFunc(GLenum func)
+{
+    NullGL::record("glDepthFunc", NullGL::COMMAND_STATE);
+}
+
+void nullglDepthMask(GLboolean flag)
+{
+    NullGL::record("glDepthMask", NullGL::COMMAND_STATE);
+}
+
+void nullglDisable(GLenum cap)
+{
+    NullGL::record("glDisable", NullGL::COMMAND_STATE);
+}
+
+void nullglDisableVertexAttribArray(GLuint index)
+{
+    NullGL::record("glDisableVertexAttribArray", NullGL::COMMAND_STATE);
+}
+
+void nullglDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    NullGL::record("glDrawArrays", NullGL::COMMAND_DRAW, (unsigned int)count);
+}
+
+void nullglDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+    NullGL::record("glDrawArraysInstanced", NullGL::COMMAND_DRAW, (unsigned int)count * (unsigned int)instancecount);
+}
+
+void nullglDrawBuffer(GLenum buf)
+{
+    NullGL::record("glDrawBuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglDrawBuffers(GLsizei n, const GLenum* bufs)
+{
+    NullGL::record("glDrawBuffers", NullGL::COMMAND_STATE);
+}
+
+void nullglDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    NullGL::record("glDrawElements", NullGL::COMMAND_DRAW, (unsigned int)count);
+}
+
+void nullglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+{
+    NullGL::record("glDrawElementsInstanced", NullGL::COMMAND_DRAW, (unsigned int)count * (unsigned int)instancecount);
+}
+
+void nullglEnable(GLenum cap)
+{
+    NullGL::record("glEnable", NullGL::COMMAND_STATE);
+}
+
+void nullglEnableVertexAttribArray(GLuint index)
+{
+    NullGL::record("glEnableVertexAttribArray", NullGL::COMMAND_STATE);
+}
+
+void nullglFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    NullGL::record("glFramebufferRenderbuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    NullGL::record("glFramebufferTexture2D", NullGL::COMMAND_STATE);
+}
+
+void nullglFrontFace(GLenum mode)
+{
+    NullGL::record("glFrontFace", NullGL::COMMAND_STATE);
+}
+
+void nullglGenBuffers(GLsizei n, GLuint* buffers)
+{
+    generateHandles(n, buffers);
+    NullGL::record("glGenBuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    generateHandles(n, framebuffers);
+    NullGL::record("glGenFramebuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    generateHandles(n, renderbuffers);
+    NullGL::record("glGenRenderbuffers", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGenTextures(GLsizei n, GLuint* textures)
+{
+    generateHandles(n, textures);
+    NullGL::record("glGenTextures", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    generateHandles(n, arrays);
+    NullGL::record("glGenVertexArrays", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGenerateMipmap(GLenum target)
+{
+    NullGL::record("glGenerateMipmap", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getActiveVariable(findVariable(__programs[program].attributes, index), bufSize, length, size, type, name);
+    NullGL::record("glGetActiveAttrib", NullGL::COMMAND_QUERY);
+}
+
+void nullglGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getActiveVariable(findVariable(__programs[program].uniforms, index), bufSize, length, size, type, name);
+    NullGL::record("glGetActiveUniform", NullGL::COMMAND_QUERY);
+}
+
+GLint nullglGetAttribLocation(GLuint program, const GLchar* name)
+{
+    NullGL::record("glGetAttribLocation", NullGL::COMMAND_QUERY);
+    const std::vector<NullGLVariable>& attributes = __programs[program].attributes;
+    for (size_t i = 0, count = attributes.size(); i < count; ++i)
+    {
+        if (attributes[i].name == name)
+            return attributes[i].location;
+    }
+    return -1;
+}
+
+GLenum nullglGetError()
+{
+    return GL_NO_ERROR;
+}
+
+void nullglGetIntegerv(GLenum pname, GLint* data)
+{
+    switch (pname)
+    {
+    case GL_FRAMEBUFFER_BINDING:
+        *data = (GLint)__framebuffer;
+        break;
+    case GL_MAX_VERTEX_ATTRIBS:
+        *data = 16;
+        break;
+    case GL_MAX_COLOR_ATTACHMENTS:
+        *data = 4;
+        break;
+    case GL_MAJOR_VERSION:
+        *data = 2;
+        break;
+    default:
+        *data = 0;
+        break;
+    }
+    NullGL::record("glGetIntegerv", NullGL::COMMAND_QUERY);
+}
+
+void nullglGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if (length)
+        *length = 0;
+    if (infoLog && bufSize > 0)
+        infoLog[0] = '\0';
+}
+
+void nullglGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    const NullGLProgram& p = __programs[program];
+    switch (pname)
+    {
+    case GL_LINK_STATUS:
+    case GL_VALIDATE_STATUS:
+        *params = GL_TRUE;
+        break;
+    case GL_ACTIVE_ATTRIBUTES:
+        *params = (GLint)p.attributes.size();
+        break;
+    case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+        *params = getMaxNameLength(p.attributes);
+        break;
+    case GL_ACTIVE_UNIFORMS:
+        *params = (GLint)p.uniforms.size();
+        break;
+    case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+        *params = getMaxNameLength(p.uniforms);
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+    NullGL::record("glGetProgramiv", NullGL::COMMAND_QUERY);
+}
+
+void nullglGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if (length)
+        *length = 0;
+    if (infoLog && bufSize > 0)
+        infoLog[0] = '\0';
+}
+
+void nullglGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    NullGL::record("glGetShaderiv", NullGL::COMMAND_QUERY);
+}
+
+const GLubyte* nullglGetString(GLenum name)
+{
+    static const GLubyte empty[] = "";
+    static const GLubyte renderer[] = "gameplay null GL";
+    return (name == GL_RENDERER || name == GL_VENDOR) ? renderer : empty;
+}
+
+GLint nullglGetUniformLocation(GLuint program, const GLchar* name)
+{
+    NullGL::record("glGetUniformLocation", NullGL::COMMAND_QUERY);
+
+    // Array elements ("u_name[2]") resolve relative to the array's base location.
+    std::string base(name);
+    GLint element = 0;
+    size_t bracket = base.find('[');
+    if (bracket != std::string::npos)
+    {
+        element = atoi(base.c_str() + bracket + 1);
+        base = base.substr(0, bracket);
+    }
+
+    const std::vector<NullGLVariable>& uniforms = __programs[program].uniforms;
+    for (size_t i = 0, count = uniforms.size(); i < count; ++i)
+    {
+        if (uniforms[i].name == base)
+            return element < uniforms[i].size ? uniforms[i].location + element : -1;
+    }
+    return -1;
+}
+
+void nullglHint(GLenum target, GLenum mode)
+{
+    NullGL::record("glHint", NullGL::COMMAND_STATE);
+}
+
+GLboolean nullglIsTexture(GLuint texture)
+{
+    return texture != 0 && texture < __nextHandle ? GL_TRUE : GL_FALSE;
+}
+
+GLboolean nullglIsVertexArray(GLuint array)
+{
+    return array != 0 && array < __nextHandle ? GL_TRUE : GL_FALSE;
+}
+
+void nullglLinkProgram(GLuint program)
+{
+    NullGLProgram& p = __programs[program];
+    p.attributes.clear();
+    p.uniforms.clear();
+    for (size_t i = 0, count = p.shaders.size(); i < count; ++i)
+    {
+        const NullGLShader& shader = __shaders[p.shaders[i]];
+        mergeVariables(shader.attributes, p.attributes);
+        mergeVariables(shader.uniforms, p.uniforms);
+    }
+
+    GLint location = 0;
+    for (size_t i = 0, count = p.attributes.size(); i < count; ++i)
+        p.attributes[i].location = location++;
+    location = 0;
+    for (size_t i = 0, count = p.uniforms.size(); i < count; ++i)
+    {
+        p.uniforms[i].location = location;
+        location += p.uniforms[i].size;
+    }
+    NullGL::record("glLinkProgram", NullGL::COMMAND_RESOURCE);
+}
+
+void* nullglMapBuffer(GLenum target, GLenum access)
+{
+    NullGLBuffer& buffer = __buffers[boundBuffer(target)];
+    buffer.storage.resize(std::max(buffer.size, (size_t)1));
+    NullGL::record("glMapBuffer", NullGL::COMMAND_STATE);
+    return &buffer.storage[0];
+}
+
+void nullglPixelStorei(GLenum pname, GLint param)
+{
+    NullGL::record("glPixelStorei", NullGL::COMMAND_STATE);
+}
+
+void nullglReadBuffer(GLenum src)
+{
+    NullGL::record("glReadBuffer", NullGL::COMMAND_STATE);
+}
+
+void nullglReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+    if (pixels)
+        memset(pixels, 0, (size_t)width * height * getPixelSize(format, type));
+    NullGL::record("glReadPixels", NullGL::COMMAND_QUERY);
+}
+
+void nullglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    NullGL::record("glRenderbufferStorage", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (length && length[i] >= 0)
+            source.append(string[i], length[i]);
+        else
+            source.append(string[i]);
+    }
+    NullGLShader& s = __shaders[shader];
+    s.attributes.clear();
+    s.uniforms.clear();
+    reflectShader(source, s);
+    NullGL::record("glShaderSource", NullGL::COMMAND_RESOURCE);
+}
+
+void nullglStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    NullGL::record("glStencilFunc", NullGL::COMMAND_STATE);
+}
+
+void nullglStencilMask(GLuint mask)
+{
+    NullGL::record("glStencilMask", NullGL::COMMAND_STATE);
+}
+
+void nullglStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+    NullGL::record("glStencilOp", NullGL::COMMAND_STATE);
+}
+
+void nullglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    NullGL::record("glTexImage2D", NullGL::COMMAND_TEXTURE_UPLOAD, pixels ? (unsigned int)(width * height * getPixelSize(format, type)) : 0);
+}
+
+void nullglTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    NullGL::record("glTexParameteri", NullGL::COMMAND_STATE);
+}
+
+void nullglTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    NullGL::record("glTexSubImage2D", NullGL::COMMAND_TEXTURE_UPLOAD, (unsigned int)(width * height * getPixelSize(format, type)));
+}
+
+void nullglUniform1f(GLint location, GLfloat v0)
+{
+    NullGL::record("glUniform1f", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform1fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    NullGL::record("glUniform1fv", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform1i(GLint location, GLint v0)
+{
+    NullGL::record("glUniform1i", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform1iv(GLint location, GLsizei count, const GLint* value)
+{
+    NullGL::record("glUniform1iv", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    NullGL::record("glUniform2f", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform2fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    NullGL::record("glUniform2fv", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    NullGL::record("glUniform3f", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform3fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    NullGL::record("glUniform3fv", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    NullGL::record("glUniform4f", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    NullGL::record("glUniform4fv", NullGL::COMMAND_UNIFORM);
+}
+
+void nullglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    NullGL::record("glUniformMatrix4fv", NullGL::COMMAND_UNIFORM);
+}
+
+GLboolean nullglUnmapBuffer(GLenum target)
+{
+    // A write-only mapping is assumed to have rewritten the whole buffer.
+    std::map<GLuint, NullGLBuffer>::const_iterator itr = __buffers.find(boundBuffer(target));
+    NullGL::record("glUnmapBuffer", NullGL::COMMAND_BUFFER_UPLOAD, itr != __buffers.end() ? (unsigned int)itr->second.size : 0);
+    return GL_TRUE;
+}
+
+void nullglUseProgram(GLuint program)
+{
+    NullGL::record("glUseProgram", NullGL::COMMAND_STATE);
+}
+
+void nullglVertexAttrib4fv(GLuint index, const GLfloat* v)
+{
+    NullGL::record("glVertexAttrib4fv", NullGL::COMMAND_STATE);
+}
+
+void nullglVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    NullGL::record("glVertexAttribDivisor", NullGL::COMMAND_STATE);
+}
+
+void nullglVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    NullGL::record("glVertexAttribPointer", NullGL::COMMAND_STATE);
+}
+
+void nullglViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    NullGL::record("glViewport", NullGL::COMMAND_STATE);
+}
+
+#endif
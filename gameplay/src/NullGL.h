@@ -0,0 +1,453 @@
+#ifndef NULLGL_H_
+#define NULLGL_H_
+
+/**
+ * Null GL backend.
+ *
+ * When the engine is built with GP_USE_NULL_GL defined, this header is included
+ * from Base.h right after the platform GL headers. Every GL entry point used by
+ * the engine is redirected to a recording stub that never touches a driver, so
+ * the full CPU side of the renderer (scene traversal, material binding, batching,
+ * uploads) can be executed and measured on machines without a display or GPU.
+ *
+ * The GL headers are still used for types and enumerations only.
+ */
+
+#undef glActiveTexture
+#undef glAttachShader
+#undef glBindAttribLocation
+#undef glBindBuffer
+#undef glBindFramebuffer
+#undef glBindRenderbuffer
+#undef glBindTexture
+#undef glBindVertexArray
+#undef glBlendFunc
+#undef glBufferData
+#undef glBufferSubData
+#undef glCheckFramebufferStatus
+#undef glClear
+#undef glClearColor
+#undef glClearDepth
+#undef glClearStencil
+#undef glCompileShader
+#undef glCompressedTexImage2D
+#undef glCreateProgram
+#undef glCreateShader
+#undef glCullFace
+#undef glDeleteBuffers
+#undef glDeleteFramebuffers
+#undef glDeleteProgram
+#undef glDeleteRenderbuffers
+#undef glDeleteShader
+#undef glDeleteTextures
+#undef glDeleteVertexArrays
+#undef glDepthFunc
+#undef glDepthMask
+#undef glDisable
+#undef glDisableVertexAttribArray
+#undef glDrawArrays
+#undef glDrawArraysInstanced
+#undef glDrawBuffer
+#undef glDrawBuffers
+#undef glDrawElements
+#undef glDrawElementsInstanced
+#undef glEnable
+#undef glEnableVertexAttribArray
+#undef glFramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#undef glFrontFace
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenRenderbuffers
+#undef glGenTextures
+#undef glGenVertexArrays
+#undef glGenerateMipmap
+#undef glGetActiveAttrib
+#undef glGetActiveUniform
+#undef glGetAttribLocation
+#undef glGetError
+#undef glGetIntegerv
+#undef glGetProgramInfoLog
+#undef glGetProgramiv
+#undef glGetShaderInfoLog
+#undef glGetShaderiv
+#undef glGetString
+#undef glGetUniformLocation
+#undef glHint
+#undef glIsTexture
+#undef glIsVertexArray
+#undef glLinkProgram
+#undef glMapBuffer
+#undef glPixelStorei
+#undef glReadBuffer
+#undef glReadPixels
+#undef glRenderbufferStorage
+#undef glShaderSource
+#undef glStencilFunc
+#undef glStencilMask
+#undef glStencilOp
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glTexSubImage2D
+#undef glUniform1f
+#undef glUniform1fv
+#undef glUniform1i
+#undef glUniform1iv
+#undef glUniform2f
+#undef glUniform2fv
+#undef glUniform3f
+#undef glUniform3fv
+#undef glUniform4f
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glUnmapBuffer
+#undef glUseProgram
+#undef glVertexAttrib4fv
+#undef glVertexAttribDivisor
+#undef glVertexAttribPointer
+#undef glViewport
+
+#define glActiveTexture nullglActiveTexture
+#define glAttachShader nullglAttachShader
+#define glBindAttribLocation nullglBindAttribLocation
+#define glBindBuffer nullglBindBuffer
+#define glBindFramebuffer nullglBindFramebuffer
+#define glBindRenderbuffer nullglBindRenderbuffer
+#define glBindTexture nullglBindTexture
+#define glBindVertexArray nullglBindVertexArray
+#define glBlendFunc nullglBlendFunc
+#define glBufferData nullglBufferData
+#define glBufferSubData nullglBufferSubData
+#define glCheckFramebufferStatus nullglCheckFramebufferStatus
+#define glClear nullglClear
+#define glClearColor nullglClearColor
+#define glClearDepth nullglClearDepth
+#define glClearStencil nullglClearStencil
+#define glCompileShader nullglCompileShader
+#define glCompressedTexImage2D nullglCompressedTexImage2D
+#define glCreateProgram nullglCreateProgram
+#define glCreateShader nullglCreateShader
+#define glCullFace nullglCullFace
+#define glDeleteBuffers nullglDeleteBuffers
+#define glDeleteFramebuffers nullglDeleteFramebuffers
+#define glDeleteProgram nullglDeleteProgram
+#define glDeleteRenderbuffers nullglDeleteRenderbuffers
+#define glDeleteShader nullglDeleteShader
+#define glDeleteTextures nullglDeleteTextures
+#define glDeleteVertexArrays nullglDeleteVertexArrays
+#define glDepthFunc nullglDepthFunc
+#define glDepthMask nullglDepthMask
+#define glDisable nullglDisable
+#define glDisableVertexAttribArray nullglDisableVertexAttribArray
+#define glDrawArrays nullglDrawArrays
+#define glDrawArraysInstanced nullglDrawArraysInstanced
+#define glDrawBuffer nullglDrawBuffer
+#define glDrawBuffers nullglDrawBuffers
+#define glDrawElements nullglDrawElements
+#define glDrawElementsInstanced nullglDrawElementsInstanced
+#define glEnable nullglEnable
+#define glEnableVertexAttribArray nullglEnableVertexAttribArray
+#define glFramebufferRenderbuffer nullglFramebufferRenderbuffer
+#define glFramebufferTexture2D nullglFramebufferTexture2D
+#define glFrontFace nullglFrontFace
+#define glGenBuffers nullglGenBuffers
+#define glGenFramebuffers nullglGenFramebuffers
+#define glGenRenderbuffers nullglGenRenderbuffers
+#define glGenTextures nullglGenTextures
+#define glGenVertexArrays nullglGenVertexArrays
+#define glGenerateMipmap nullglGenerateMipmap
+#define glGetActiveAttrib nullglGetActiveAttrib
+#define glGetActiveUniform nullglGetActiveUniform
+#define glGetAttribLocation nullglGetAttribLocation
+#define glGetError nullglGetError
+#define glGetIntegerv nullglGetIntegerv
+#define glGetProgramInfoLog nullglGetProgramInfoLog
+#define glGetProgramiv nullglGetProgramiv
+#define glGetShaderInfoLog nullglGetShaderInfoLog
+#define glGetShaderiv nullglGetShaderiv
+#define glGetString nullglGetString
+#define glGetUniformLocation nullglGetUniformLocation
+#define glHint nullglHint
+#define glIsTexture nullglIsTexture
+#define glIsVertexArray nullglIsVertexArray
+#define glLinkProgram nullglLinkProgram
+#define glMapBuffer nullglMapBuffer
+#define glPixelStorei nullglPixelStorei
+#define glReadBuffer nullglReadBuffer
+#define glReadPixels nullglReadPixels
+#define glRenderbufferStorage nullglRenderbufferStorage
+#define glShaderSource nullglShaderSource
+#define glStencilFunc nullglStencilFunc
+#define glStencilMask nullglStencilMask
+#define glStencilOp nullglStencilOp
+#define glTexImage2D nullglTexImage2D
+#define glTexParameteri nullglTexParameteri
+#define glTexSubImage2D nullglTexSubImage2D
+#define glUniform1f nullglUniform1f
+#define glUniform1fv nullglUniform1fv
+#define glUniform1i nullglUniform1i
+#define glUniform1iv nullglUniform1iv
+#define glUniform2f nullglUniform2f
+#define glUniform2fv nullglUniform2fv
+#define glUniform3f nullglUniform3f
+#define glUniform3fv nullglUniform3fv
+#define glUniform4f nullglUniform4f
+#define glUniform4fv nullglUniform4fv
+#define glUniformMatrix4fv nullglUniformMatrix4fv
+#define glUnmapBuffer nullglUnmapBuffer
+#define glUseProgram nullglUseProgram
+#define glVertexAttrib4fv nullglVertexAttrib4fv
+#define glVertexAttribDivisor nullglVertexAttribDivisor
+#define glVertexAttribPointer nullglVertexAttribPointer
+#define glViewport nullglViewport
+
+void nullglActiveTexture(GLenum texture);
+void nullglAttachShader(GLuint program, GLuint shader);
+void nullglBindAttribLocation(GLuint program, GLuint index, const GLchar* name);
+void nullglBindBuffer(GLenum target, GLuint buffer);
+void nullglBindFramebuffer(GLenum target, GLuint framebuffer);
+void nullglBindRenderbuffer(GLenum target, GLuint renderbuffer);
+void nullglBindTexture(GLenum target, GLuint texture);
+void nullglBindVertexArray(GLuint array);
+void nullglBlendFunc(GLenum sfactor, GLenum dfactor);
+void nullglBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void nullglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+GLenum nullglCheckFramebufferStatus(GLenum target);
+void nullglClear(GLbitfield mask);
+void nullglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void nullglClearDepth(GLdouble depth);
+void nullglClearStencil(GLint s);
+void nullglCompileShader(GLuint shader);
+void nullglCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data);
+GLuint nullglCreateProgram();
+GLuint nullglCreateShader(GLenum type);
+void nullglCullFace(GLenum mode);
+void nullglDeleteBuffers(GLsizei n, const GLuint* buffers);
+void nullglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void nullglDeleteProgram(GLuint program);
+void nullglDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void nullglDeleteShader(GLuint shader);
+void nullglDeleteTextures(GLsizei n, const GLuint* textures);
+void nullglDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void nullglDepthFunc(GLenum func);
+void nullglDepthMask(GLboolean flag);
+void nullglDisable(GLenum cap);
+void nullglDisableVertexAttribArray(GLuint index);
+void nullglDrawArrays(GLenum mode, GLint first, GLsizei count);
+void nullglDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+void nullglDrawBuffer(GLenum buf);
+void nullglDrawBuffers(GLsizei n, const GLenum* bufs);
+void nullglDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void nullglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+void nullglEnable(GLenum cap);
+void nullglEnableVertexAttribArray(GLuint index);
+void nullglFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void nullglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void nullglFrontFace(GLenum mode);
+void nullglGenBuffers(GLsizei n, GLuint* buffers);
+void nullglGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void nullglGenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void nullglGenTextures(GLsizei n, GLuint* textures);
+void nullglGenVertexArrays(GLsizei n, GLuint* arrays);
+void nullglGenerateMipmap(GLenum target);
+void nullglGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+void nullglGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+GLint nullglGetAttribLocation(GLuint program, const GLchar* name);
+GLenum nullglGetError();
+void nullglGetIntegerv(GLenum pname, GLint* data);
+void nullglGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void nullglGetProgramiv(GLuint program, GLenum pname, GLint* params);
+void nullglGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void nullglGetShaderiv(GLuint shader, GLenum pname, GLint* params);
+const GLubyte* nullglGetString(GLenum name);
+GLint nullglGetUniformLocation(GLuint program, const GLchar* name);
+void nullglHint(GLenum target, GLenum mode);
+GLboolean nullglIsTexture(GLuint texture);
+GLboolean nullglIsVertexArray(GLuint array);
+void nullglLinkProgram(GLuint program);
+void* nullglMapBuffer(GLenum target, GLenum access);
+void nullglPixelStorei(GLenum pname, GLint param);
+void nullglReadBuffer(GLenum src);
+void nullglReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+void nullglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void nullglShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void nullglStencilFunc(GLenum func, GLint ref, GLuint mask);
+void nullglStencilMask(GLuint mask);
+void nullglStencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+void nullglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+void nullglTexParameteri(GLenum target, GLenum pname, GLint param);
+void nullglTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+void nullglUniform1f(GLint location, GLfloat v0);
+void nullglUniform1fv(GLint location, GLsizei count, const GLfloat* value);
+void nullglUniform1i(GLint location, GLint v0);
+void nullglUniform1iv(GLint location, GLsizei count, const GLint* value);
+void nullglUniform2f(GLint location, GLfloat v0, GLfloat v1);
+void nullglUniform2fv(GLint location, GLsizei count, const GLfloat* value);
+void nullglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+void nullglUniform3fv(GLint location, GLsizei count, const GLfloat* value);
+void nullglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+void nullglUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+void nullglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+GLboolean nullglUnmapBuffer(GLenum target);
+void nullglUseProgram(GLuint program);
+void nullglVertexAttrib4fv(GLuint index, const GLfloat* v);
+void nullglVertexAttribDivisor(GLuint index, GLuint divisor);
+void nullglVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+void nullglViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+namespace gameplay
+{
+
+/**
+ * Defines the recording side of the null GL backend.
+ *
+ * The stubs count every command they receive into per-frame statistics.
+ * A frame ends each time the platform swaps buffers, at which point the
+ * running counters become the last frame's statistics and are reset.
+ * Optionally, the individual commands of each frame can also be recorded,
+ * which allows two runs of the same scene to be compared call by call.
+ *
+ * Only available when the engine is built with GP_USE_NULL_GL.
+ *
+ * @script{ignore}
+ */
+class NullGL
+{
+public:
+
+    /**
+     * The category of a recorded GL command.
+     */
+    enum CommandType
+    {
+        COMMAND_DRAW,
+        COMMAND_CLEAR,
+        COMMAND_STATE,
+        COMMAND_UNIFORM,
+        COMMAND_BUFFER_UPLOAD,
+        COMMAND_TEXTURE_UPLOAD,
+        COMMAND_RESOURCE,
+        COMMAND_QUERY
+    };
+
+    /**
+     * A single recorded GL command.
+     */
+    struct Command
+    {
+        /** The name of the GL function that was called. */
+        const char* function;
+        /** The category of the command. */
+        CommandType type;
+        /** The number of vertices/indices drawn, or the number of bytes uploaded. */
+        unsigned int size;
+    };
+
+    /**
+     * GL command statistics for a frame.
+     */
+    struct Stats
+    {
+        /**
+         * Constructor.
+         */
+        Stats();
+
+        /**
+         * Resets all counters to zero.
+         */
+        void reset();
+
+        /** The number of glDrawArrays/glDrawElements calls, including instanced draws. */
+        unsigned int drawCalls;
+        /** The number of vertices (or indices) submitted by draw calls, multiplied by the instance count. */
+        unsigned int vertices;
+        /** The number of glClear calls. */
+        unsigned int clears;
+        /** The number of state changes (capabilities, blend/depth/stencil state, bindings, program switches). */
+        unsigned int stateChanges;
+        /** The number of glUniform* calls. */
+        unsigned int uniformUploads;
+        /** The number of vertex/index buffer uploads (glBufferData, glBufferSubData and mapped buffer writes). */
+        unsigned int bufferUploads;
+        /** The number of texture image uploads. */
+        unsigned int textureUploads;
+        /** The total number of bytes uploaded by buffer and texture uploads. */
+        unsigned int bytesUploaded;
+    };
+
+    /**
+     * Gets the statistics of the last completed frame.
+     *
+     * @return The statistics of the last completed frame.
+     */
+    static const Stats& getFrameStats();
+
+    /**
+     * Gets the statistics of the frame currently being submitted.
+     *
+     * @return The running statistics of the current frame.
+     */
+    static const Stats& getCurrentStats();
+
+    /**
+     * Gets the number of frames completed so far.
+     *
+     * @return The number of completed frames.
+     */
+    static unsigned int getFrameCount();
+
+    /**
+     * Sets whether individual commands are recorded in addition to the statistics.
+     *
+     * Recording is disabled by default.
+     *
+     * @param enabled true to record the commands of each frame, false to only count them.
+     */
+    static void setRecording(bool enabled);
+
+    /**
+     * Determines whether individual commands are being recorded.
+     *
+     * @return true if commands are recorded, false otherwise.
+     */
+    static bool isRecording();
+
+    /**
+     * Gets the commands recorded during the last completed frame.
+     *
+     * The list is empty unless recording is enabled.
+     *
+     * @return The list of commands of the last completed frame.
+     */
+    static const std::vector<Command>& getFrameCommands();
+
+    /**
+     * Ends the current frame.
+     *
+     * This is called by the platform when buffers are swapped.
+     */
+    static void endFrame();
+
+    /**
+     * Records a single command.
+     *
+     * This is used internally by the GL stubs.
+     *
+     * @param function The GL function name.
+     * @param type The category of the command.
+     * @param size The vertex/index count or byte size associated with the command.
+     */
+    static void record(const char* function, CommandType type, unsigned int size = 0);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    NullGL();
+};
+
+}
+
+#endif
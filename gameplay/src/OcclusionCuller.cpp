@@ -0,0 +1,460 @@
+#include "Base.h"
+#include "OcclusionCuller.h"
+#include "MathUtil.h"
+#include "Node.h"
+#include "Camera.h"
+#include "Model.h"
+#include "Bundle.h"
+
+#ifdef GP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// Size of the tiles whose farthest depths are tested before the pixels of the depth buffer.
+#define OCCLUSION_TILE_SIZE 8
+
+// Name of the node tag that marks occluders.
+#define OCCLUSION_OCCLUDER_TAG "occluder"
+
+namespace gameplay
+{
+
+/**
+ * Appends the triangles of a triangle list or strip, offset by the given vertex index.
+ */
+template <class T>
+static void addTriangles(const T* indices, unsigned int indexCount, Mesh::PrimitiveType type, std::vector<unsigned int>& dst)
+{
+    if (type == Mesh::TRIANGLES)
+    {
+        for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+        {
+            dst.push_back(indices[i]);
+            dst.push_back(indices[i + 1]);
+            dst.push_back(indices[i + 2]);
+        }
+    }
+    else if (type == Mesh::TRIANGLE_STRIP)
+    {
+        // Every other triangle of a strip has its winding reversed.
+        for (unsigned int i = 0; i + 2 < indexCount; ++i)
+        {
+            unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (a == b || b == c || a == c)
+                continue;
+            dst.push_back((i & 1) ? b : a);
+            dst.push_back((i & 1) ? a : b);
+            dst.push_back(c);
+        }
+    }
+}
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height)
+    : _width(std::max(width, 1u)), _height(std::max(height, 1u)), _stride((_width + 3) & ~3u), _tilesDirty(true), _triangleCount(0)
+{
+    _depth.resize(_stride * _height, 1.0f);
+    _tileDepth.resize(((_width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE) * ((_height + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE), 1.0f);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    for (std::map<std::string, OccluderMesh*>::iterator itr = _meshes.begin(); itr != _meshes.end(); ++itr)
+    {
+        SAFE_DELETE(itr->second);
+    }
+}
+
+unsigned int OcclusionCuller::getWidth() const
+{
+    return _width;
+}
+
+unsigned int OcclusionCuller::getHeight() const
+{
+    return _height;
+}
+
+unsigned int OcclusionCuller::getTriangleCount() const
+{
+    return _triangleCount;
+}
+
+const float* OcclusionCuller::getDepthBuffer() const
+{
+    return &_depth[0];
+}
+
+void OcclusionCuller::clear(const Matrix& viewProjectionMatrix)
+{
+    _viewProjection = viewProjectionMatrix;
+    std::fill(_depth.begin(), _depth.end(), 1.0f);
+    _tilesDirty = true;
+    _triangleCount = 0;
+}
+
+const OcclusionCuller::OccluderMesh* OcclusionCuller::getOccluderMesh(Node* node)
+{
+    const char* tag = node->getTag(OCCLUSION_OCCLUDER_TAG);
+    if (tag == NULL)
+        return NULL;
+
+    // Use the mesh of the model of the node, unless the tag names a mesh to use instead.
+    std::string url = tag;
+    if (url.empty())
+    {
+        Model* model = dynamic_cast<Model*>(node->getDrawable());
+        if (model && model->getMesh())
+            url = model->getMesh()->getUrl();
+        if (url.empty())
+            return NULL;
+    }
+
+    std::map<std::string, OccluderMesh*>::const_iterator itr = _meshes.find(url);
+    if (itr != _meshes.end())
+        return itr->second;
+
+    // Meshes that fail to load are remembered so that they are only read once.
+    OccluderMesh* mesh = NULL;
+    Bundle::MeshData* data = Bundle::readMeshData(url.c_str());
+    if (data)
+    {
+        unsigned int positionOffset = 0;
+        bool hasPosition = false;
+        for (unsigned int i = 0, count = data->vertexFormat.getElementCount(); i < count; ++i)
+        {
+            const VertexFormat::Element& element = data->vertexFormat.getElement(i);
+            if (element.usage == VertexFormat::POSITION)
+            {
+                hasPosition = element.size >= 3;
+                break;
+            }
+            positionOffset += element.size * sizeof(float);
+        }
+
+        if (hasPosition)
+        {
+            mesh = new OccluderMesh();
+            unsigned int vertexStride = data->vertexFormat.getVertexSize();
+            mesh->positions.resize(data->vertexCount * 3);
+            for (unsigned int i = 0; i < data->vertexCount; ++i)
+            {
+                memcpy(&mesh->positions[i * 3], &data->vertexData[i * vertexStride + positionOffset], sizeof(float) * 3);
+            }
+
+            if (data->parts.empty())
+            {
+                std::vector<unsigned int> sequence(data->vertexCount);
+                for (unsigned int i = 0; i < data->vertexCount; ++i)
+                    sequence[i] = i;
+                if (!sequence.empty())
+                    addTriangles(&sequence[0], data->vertexCount, data->primitiveType, mesh->indices);
+            }
+            for (size_t i = 0, count = data->parts.size(); i < count; ++i)
+            {
+                const Bundle::MeshPartData* part = data->parts[i];
+                switch (part->indexFormat)
+                {
+                case Mesh::INDEX8:
+                    addTriangles((const unsigned char*)part->indexData, part->indexCount, part->primitiveType, mesh->indices);
+                    break;
+                case Mesh::INDEX16:
+                    addTriangles((const unsigned short*)part->indexData, part->indexCount, part->primitiveType, mesh->indices);
+                    break;
+                case Mesh::INDEX32:
+                    addTriangles((const unsigned int*)part->indexData, part->indexCount, part->primitiveType, mesh->indices);
+                    break;
+                }
+            }
+        }
+        SAFE_DELETE(data);
+    }
+
+    if (mesh == NULL)
+        GP_WARN("Failed to read occluder mesh '%s'.", url.c_str());
+    _meshes[url] = mesh;
+
+    return mesh;
+}
+
+bool OcclusionCuller::addOccluder(Node* node)
+{
+    GP_ASSERT(node);
+
+    const OccluderMesh* mesh = getOccluderMesh(node);
+    if (mesh == NULL || mesh->indices.empty())
+        return false;
+
+    addOccluder(&mesh->positions[0], (unsigned int)mesh->positions.size() / 3, &mesh->indices[0], (unsigned int)mesh->indices.size(), node->getWorldMatrix());
+    return true;
+}
+
+void OcclusionCuller::addOccluder(const float* positions, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, const Matrix& worldMatrix)
+{
+    GP_ASSERT(positions);
+    GP_ASSERT(indices);
+
+    Matrix worldViewProjection;
+    Matrix::multiply(_viewProjection, worldMatrix, &worldViewProjection);
+
+    _clipVertices.resize(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        const float* p = &positions[i * 3];
+        worldViewProjection.transformVector(Vector4(p[0], p[1], p[2], 1.0f), &_clipVertices[i]);
+    }
+
+    for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+    {
+        GP_ASSERT(indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount);
+        rasterizeTriangle(_clipVertices[indices[i]], _clipVertices[indices[i + 1]], _clipVertices[indices[i + 2]]);
+    }
+    _tilesDirty = true;
+}
+
+void OcclusionCuller::rasterizeTriangle(const Vector4& a, const Vector4& b, const Vector4& c)
+{
+    // Clip against the near plane (z >= -w), which may turn the triangle into a quad.
+    const Vector4* in[3] = { &a, &b, &c };
+    Vector4 polygon[4];
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const Vector4& p = *in[i];
+        const Vector4& q = *in[(i + 1) % 3];
+        float dp = p.z + p.w;
+        float dq = q.z + q.w;
+        if (dp >= 0.0f)
+            polygon[count++] = p;
+        if ((dp >= 0.0f) != (dq >= 0.0f))
+            polygon[count++] = p + (q - p) * (dp / (dp - dq));
+    }
+    if (count < 3)
+        return;
+
+    // Project to the screen, with rows from the bottom of the screen.
+    float x[4], y[4], z[4];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float invW = 1.0f / polygon[i].w;
+        x[i] = (polygon[i].x * invW * 0.5f + 0.5f) * _width;
+        y[i] = (polygon[i].y * invW * 0.5f + 0.5f) * _height;
+        z[i] = polygon[i].z * invW;
+    }
+
+    rasterizeTriangle(x, y, z);
+    if (count == 4)
+    {
+        float qx[3] = { x[0], x[2], x[3] };
+        float qy[3] = { y[0], y[2], y[3] };
+        float qz[3] = { z[0], z[2], z[3] };
+        rasterizeTriangle(qx, qy, qz);
+    }
+    ++_triangleCount;
+}
+
+void OcclusionCuller::rasterizeTriangle(const float* x, const float* y, const float* z)
+{
+    // Back facing triangles are skipped, since the front faces of closed occluders cover them.
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (!(area > 0.0f))
+        return;
+
+    // The pixels whose centers are within the bounds of the triangle.
+    float minX = std::min(x[0], std::min(x[1], x[2]));
+    float maxX = std::max(x[0], std::max(x[1], x[2]));
+    float minY = std::min(y[0], std::min(y[1], y[2]));
+    float maxY = std::max(y[0], std::max(y[1], y[2]));
+    int x0 = std::max((int)ceilf(minX - 0.5f), 0);
+    int x1 = std::min((int)floorf(maxX - 0.5f), (int)_width - 1);
+    int y0 = std::max((int)ceilf(minY - 0.5f), 0);
+    int y1 = std::min((int)floorf(maxY - 0.5f), (int)_height - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    // Edge functions e = a * px + b * py + c, which are positive inside the triangle,
+    // and the depth plane z = za * px + zb * py + zc.
+    float ea[3], eb[3], ec[3];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        unsigned int j = (i + 1) % 3;
+        ea[i] = y[i] - y[j];
+        eb[i] = x[j] - x[i];
+        ec[i] = -(ea[i] * x[i] + eb[i] * y[i]);
+    }
+    // The edge opposite a vertex weights that vertex: edge 1-2 weights vertex 0, and so on.
+    float invArea = 1.0f / area;
+    float dz1 = (z[1] - z[0]) * invArea;
+    float dz2 = (z[2] - z[0]) * invArea;
+    float za = ea[2] * dz1 + ea[0] * dz2;
+    float zb = eb[2] * dz1 + eb[0] * dz2;
+    float zc = z[0] + ec[2] * dz1 + ec[0] * dz2;
+
+#ifdef GP_USE_SSE
+    // Rasterize four aligned pixels at a time, masking the pixels outside of the bounds.
+    int alignedX0 = x0 & ~3;
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    for (int py = y0; py <= y1; ++py)
+    {
+        float* row = &_depth[py * _stride];
+        float cy = py + 0.5f;
+        __m128 rowE[3];
+        for (unsigned int i = 0; i < 3; ++i)
+            rowE[i] = _mm_set1_ps(eb[i] * cy + ec[i]);
+        __m128 rowZ = _mm_set1_ps(zb * cy + zc);
+
+        for (int px = alignedX0; px <= x1; px += 4)
+        {
+            __m128 cx = _mm_add_ps(_mm_set1_ps((float)px), laneOffsets);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[0]), cx), rowE[0]), zero);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[1]), cx), rowE[1]), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[2]), cx), rowE[2]), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(cx, _mm_set1_ps(x0 + 0.5f)));
+            inside = _mm_and_ps(inside, _mm_cmple_ps(cx, _mm_set1_ps(x1 + 0.5f)));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            __m128 depth = _mm_loadu_ps(&row[px]);
+            __m128 pz = _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), cx), rowZ), depth);
+            _mm_storeu_ps(&row[px], _mm_or_ps(_mm_and_ps(inside, pz), _mm_andnot_ps(inside, depth)));
+        }
+    }
+#else
+    for (int py = y0; py <= y1; ++py)
+    {
+        float* row = &_depth[py * _stride];
+        float cy = py + 0.5f;
+        for (int px = x0; px <= x1; ++px)
+        {
+            float cx = px + 0.5f;
+            if (ea[0] * cx + eb[0] * cy + ec[0] >= 0.0f &&
+                ea[1] * cx + eb[1] * cy + ec[1] >= 0.0f &&
+                ea[2] * cx + eb[2] * cy + ec[2] >= 0.0f)
+            {
+                float pz = za * cx + zb * cy + zc;
+                if (pz < row[px])
+                    row[px] = pz;
+            }
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::updateTiles() const
+{
+    unsigned int tilesX = (_width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE;
+    std::fill(_tileDepth.begin(), _tileDepth.end(), -FLT_MAX);
+    for (unsigned int py = 0; py < _height; ++py)
+    {
+        const float* row = &_depth[py * _stride];
+        float* tiles = &_tileDepth[(py / OCCLUSION_TILE_SIZE) * tilesX];
+        for (unsigned int px = 0; px < _width; ++px)
+        {
+            float& tile = tiles[px / OCCLUSION_TILE_SIZE];
+            tile = std::max(tile, row[px]);
+        }
+    }
+    _tilesDirty = false;
+}
+
+bool OcclusionCuller::isOccluded(const BoundingBox& box) const
+{
+    if (_triangleCount == 0 || box.isEmpty())
+        return false;
+
+    // Project the corners of the box to find the pixels it covers and its nearest depth.
+    Vector3 corners[8];
+    box.getCorners(corners);
+    float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    Vector4 clip;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        _viewProjection.transformVector(Vector4(corners[i].x, corners[i].y, corners[i].z, 1.0f), &clip);
+        if (clip.z < -clip.w || !(clip.w > 0.0f))
+            return false;
+
+        float invW = 1.0f / clip.w;
+        float sx = (clip.x * invW * 0.5f + 0.5f) * _width;
+        float sy = (clip.y * invW * 0.5f + 0.5f) * _height;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        minZ = std::min(minZ, clip.z * invW);
+    }
+
+    int x0 = std::max((int)floorf(minX), 0);
+    int x1 = std::min((int)floorf(maxX), (int)_width - 1);
+    int y0 = std::max((int)floorf(minY), 0);
+    int y1 = std::min((int)floorf(maxY), (int)_height - 1);
+    if (x0 > x1 || y0 > y1)
+        return false;
+
+    if (_tilesDirty)
+        updateTiles();
+
+    unsigned int tilesX = (_width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE;
+    for (int ty = y0 / OCCLUSION_TILE_SIZE; ty <= y1 / OCCLUSION_TILE_SIZE; ++ty)
+    {
+        for (int tx = x0 / OCCLUSION_TILE_SIZE; tx <= x1 / OCCLUSION_TILE_SIZE; ++tx)
+        {
+            // Every pixel of the tile is in front of the box.
+            if (_tileDepth[ty * tilesX + tx] < minZ)
+                continue;
+
+            int rowStart = std::max(ty * OCCLUSION_TILE_SIZE, y0);
+            int rowEnd = std::min(ty * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1, y1);
+            int columnStart = std::max(tx * OCCLUSION_TILE_SIZE, x0);
+            int columnEnd = std::min(tx * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1, x1);
+            for (int py = rowStart; py <= rowEnd; ++py)
+            {
+                const float* row = &_depth[py * _stride];
+                for (int px = columnStart; px <= columnEnd; ++px)
+                {
+                    if (row[px] >= minZ)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool OcclusionCuller::isOccluded(const BoundingSphere& sphere) const
+{
+    if (sphere.isEmpty())
+        return false;
+
+    BoundingBox box;
+    box.set(sphere);
+    return isOccluded(box);
+}
+
+unsigned int OcclusionCuller::cull(const Camera* camera, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(camera);
+
+    clear(camera->getViewProjectionMatrix());
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        if (nodes[i]->hasTag(OCCLUSION_OCCLUDER_TAG))
+            addOccluder(nodes[i]);
+    }
+    if (_triangleCount == 0)
+        return 0;
+
+    // Occluders are kept, since they are in front of their own bounds.
+    size_t visibleCount = 0;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        if (node->hasTag(OCCLUSION_OCCLUDER_TAG) || !isOccluded(node->getBoundingSphere()))
+            nodes[visibleCount++] = node;
+    }
+    unsigned int culled = (unsigned int)(nodes.size() - visibleCount);
+    nodes.resize(visibleCount);
+
+    return culled;
+}
+
+}
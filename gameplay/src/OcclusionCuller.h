@@ -0,0 +1,205 @@
+#ifndef OCCLUSIONCULLER_H_
+#define OCCLUSIONCULLER_H_
+
+#include "Matrix.h"
+#include "Vector4.h"
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+
+namespace gameplay
+{
+
+class Node;
+class Camera;
+
+/**
+ * Defines a CPU occlusion culler that tests bounding volumes against a small software depth buffer.
+ *
+ * Occluders are low-polygon meshes that are rasterized into the depth buffer, four pixels at a time
+ * using SSE where available. The bounding volumes of other objects are then projected to the screen
+ * and tested against the depth buffer, first against the farthest depth of each tile of pixels and
+ * then against the pixels themselves. An object is occluded if every pixel its bounds cover holds an
+ * occluder in front of the nearest point of its bounds.
+ *
+ * Nodes are marked as occluders with the "occluder" tag. The value of the tag may be the URL of a
+ * low-polygon mesh in a bundle ('bundle#id') to rasterize in place of the mesh of the model of the
+ * node, which is used when the value is empty. The vertex data of occluder meshes is read from
+ * their bundles once and kept on the CPU.
+ *
+ * The culler runs entirely on the CPU and is typically used after frustum culling, such as:
+ *
+ * @code
+ * nodes.clear();
+ * scene->findNodes(camera->getFrustum(), nodes);
+ * occlusionCuller.cull(camera, nodes);
+ * @endcode
+ *
+ * The depth buffer is conservative only up to its resolution, so occluders should be slightly
+ * smaller than the geometry they stand in for.
+ *
+ * @script{ignore}
+ */
+class OcclusionCuller
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param width The width of the depth buffer in pixels.
+     * @param height The height of the depth buffer in pixels.
+     */
+    OcclusionCuller(unsigned int width = 256, unsigned int height = 128);
+
+    /**
+     * Destructor.
+     */
+    ~OcclusionCuller();
+
+    /**
+     * Gets the width of the depth buffer.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height of the depth buffer.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Clears the depth buffer and sets the view projection matrix that occluders and
+     * bounding volumes are projected with.
+     *
+     * @param viewProjectionMatrix The view projection matrix of the camera.
+     */
+    void clear(const Matrix& viewProjectionMatrix);
+
+    /**
+     * Rasterizes the occluder mesh of a node into the depth buffer.
+     *
+     * @param node The node to rasterize, which should have the "occluder" tag.
+     *
+     * @return true if the node has an occluder mesh, false otherwise.
+     */
+    bool addOccluder(Node* node);
+
+    /**
+     * Rasterizes a triangle list into the depth buffer. Triangles must be wound counter-clockwise.
+     *
+     * @param positions The vertex positions as (x, y, z) floats.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the triangles.
+     * @param indexCount The number of indices.
+     * @param worldMatrix The world matrix of the mesh.
+     */
+    void addOccluder(const float* positions, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, const Matrix& worldMatrix);
+
+    /**
+     * Determines if a bounding box is hidden behind the occluders in the depth buffer.
+     *
+     * Boxes that cross the near plane or lie outside of the screen are not occluded.
+     *
+     * @param box The bounding box in world space.
+     *
+     * @return true if the box is occluded, false if it may be visible.
+     */
+    bool isOccluded(const BoundingBox& box) const;
+
+    /**
+     * Determines if a bounding sphere is hidden behind the occluders in the depth buffer.
+     *
+     * @param sphere The bounding sphere in world space.
+     *
+     * @return true if the sphere is occluded, false if it may be visible.
+     */
+    bool isOccluded(const BoundingSphere& sphere) const;
+
+    /**
+     * Removes the nodes that are occluded from a list of nodes, such as those found in the view
+     * frustum of a camera.
+     *
+     * The depth buffer is cleared and the nodes in the list that have the "occluder" tag are
+     * rasterized into it. The other nodes are then tested with their bounding spheres.
+     *
+     * @param camera The camera the nodes are viewed with.
+     * @param nodes The nodes to cull, which is updated in place.
+     *
+     * @return The number of nodes removed.
+     */
+    unsigned int cull(const Camera* camera, std::vector<Node*>& nodes);
+
+    /**
+     * Gets the number of occluder triangles rasterized since the depth buffer was cleared.
+     *
+     * @return The triangle count.
+     */
+    unsigned int getTriangleCount() const;
+
+    /**
+     * Gets the depth buffer, as rows of normalized device depths from the bottom of the screen.
+     * Rows are padded to a multiple of four pixels.
+     *
+     * @return The depth buffer.
+     */
+    const float* getDepthBuffer() const;
+
+private:
+
+    /**
+     * The triangles of an occluder mesh.
+     */
+    struct OccluderMesh
+    {
+        std::vector<float> positions;
+        std::vector<unsigned int> indices;
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    OcclusionCuller(const OcclusionCuller& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    OcclusionCuller& operator=(const OcclusionCuller&);
+
+    /**
+     * Gets the occluder mesh of a node, reading it from its bundle on first use. Returns NULL if the node has none.
+     */
+    const OccluderMesh* getOccluderMesh(Node* node);
+
+    /**
+     * Clips a triangle in clip space against the near plane and rasterizes it.
+     */
+    void rasterizeTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+
+    /**
+     * Rasterizes a triangle in screen space, keeping the nearest depth of each pixel.
+     */
+    void rasterizeTriangle(const float* x, const float* y, const float* z);
+
+    /**
+     * Computes the farthest depth of each tile of the depth buffer.
+     */
+    void updateTiles() const;
+
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _stride;
+    std::vector<float> _depth;
+    mutable std::vector<float> _tileDepth;
+    mutable bool _tilesDirty;
+    Matrix _viewProjection;
+    unsigned int _triangleCount;
+    std::vector<Vector4> _clipVertices;
+    std::map<std::string, OccluderMesh*> _meshes;
+};
+
+}
+
+#endif
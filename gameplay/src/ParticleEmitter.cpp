@@ -5,6 +5,17 @@
 #include "Scene.h"
 #include "Quaternion.h"
 #include "Properties.h"
+#include "MathUtil.h"
+
+#if defined(GP_USE_SSE)
+#include <xmmintrin.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_RANDOM_SSE2
+#endif
+#elif defined(GP_USE_NEON)
+#include <arm_neon.h>
+#endif
 
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
@@ -15,8 +26,8 @@ namespace gameplay
 {
 
 ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
-    _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
+    _particleCountMax(particleCountMax), _particleCount(0),
+    _emissionRate(PARTICLE_EMISSION_RATE), _randomSeed(0), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
     _colorStart(Vector4::zero()), _colorStartVar(Vector4::zero()), _colorEnd(Vector4::one()), _colorEndVar(Vector4::zero()),
@@ -32,16 +43,347 @@ ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
     _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _emitTime(0), _lastUpdated(0)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+    _particles.allocate(particleCountMax);
+
+    // Seed from the C library generator so that emitters still follow srand() unless seeded explicitly.
+    setRandomSeed((unsigned int)rand());
 }
 
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
+ParticleEmitter::RandomGenerator::RandomGenerator()
+    : _bufferIndex(4)
+{
+    seed(0);
+}
+
+void ParticleEmitter::RandomGenerator::seed(unsigned int seed)
+{
+    // Expand the seed into the state of the four streams with splitmix64, which
+    // guarantees well mixed, non-zero states even for small or similar seeds.
+    unsigned long long x = seed;
+    for (unsigned int stream = 0; stream < 4; ++stream)
+    {
+        for (unsigned int word = 0; word < 4; word += 2)
+        {
+            unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z = z ^ (z >> 31);
+            _state[word * 4 + stream] = (unsigned int)z;
+            _state[(word + 1) * 4 + stream] = (unsigned int)(z >> 32);
+        }
+    }
+    _bufferIndex = 4;
+}
+
+void ParticleEmitter::RandomGenerator::next4(unsigned int* dst)
+{
+#if defined(PARTICLE_RANDOM_SSE2)
+    __m128i s0 = _mm_loadu_si128((const __m128i*)&_state[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)&_state[4]);
+    __m128i s2 = _mm_loadu_si128((const __m128i*)&_state[8]);
+    __m128i s3 = _mm_loadu_si128((const __m128i*)&_state[12]);
+
+    _mm_storeu_si128((__m128i*)dst, _mm_add_epi32(s0, s3));
+
+    __m128i t = _mm_slli_epi32(s1, 9);
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+    _mm_storeu_si128((__m128i*)&_state[0], s0);
+    _mm_storeu_si128((__m128i*)&_state[4], s1);
+    _mm_storeu_si128((__m128i*)&_state[8], s2);
+    _mm_storeu_si128((__m128i*)&_state[12], s3);
+#elif defined(GP_USE_NEON)
+    uint32x4_t s0 = vld1q_u32(&_state[0]);
+    uint32x4_t s1 = vld1q_u32(&_state[4]);
+    uint32x4_t s2 = vld1q_u32(&_state[8]);
+    uint32x4_t s3 = vld1q_u32(&_state[12]);
+
+    vst1q_u32(dst, vaddq_u32(s0, s3));
+
+    uint32x4_t t = vshlq_n_u32(s1, 9);
+    s2 = veorq_u32(s2, s0);
+    s3 = veorq_u32(s3, s1);
+    s1 = veorq_u32(s1, s2);
+    s0 = veorq_u32(s0, s3);
+    s2 = veorq_u32(s2, t);
+    s3 = vorrq_u32(vshlq_n_u32(s3, 11), vshrq_n_u32(s3, 21));
+
+    vst1q_u32(&_state[0], s0);
+    vst1q_u32(&_state[4], s1);
+    vst1q_u32(&_state[8], s2);
+    vst1q_u32(&_state[12], s3);
+#else
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        unsigned int* s = &_state[i];
+        dst[i] = s[0] + s[12];
+
+        unsigned int t = s[4] << 9;
+        s[8] ^= s[0];
+        s[12] ^= s[4];
+        s[4] ^= s[8];
+        s[0] ^= s[12];
+        s[8] ^= t;
+        s[12] = (s[12] << 11) | (s[12] >> 21);
+    }
+#endif
+}
+
+void ParticleEmitter::RandomGenerator::fill(float* dst, unsigned int count)
+{
+    GP_ASSERT(dst || count == 0);
+
+    // Use the top 24 bits of each value, which map exactly onto the float mantissa.
+    const float scale = 1.0f / 16777216.0f;
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        unsigned int r[4];
+        next4(r);
+#if defined(PARTICLE_RANDOM_SSE2)
+        __m128i bits = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)r), 8);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(scale)));
+#elif defined(GP_USE_NEON)
+        uint32x4_t bits = vshrq_n_u32(vld1q_u32(r), 8);
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_u32(bits), scale));
+#else
+        dst[i] = (float)(r[0] >> 8) * scale;
+        dst[i + 1] = (float)(r[1] >> 8) * scale;
+        dst[i + 2] = (float)(r[2] >> 8) * scale;
+        dst[i + 3] = (float)(r[3] >> 8) * scale;
+#endif
+    }
+    for (; i < count; ++i)
+    {
+        dst[i] = nextFloat();
+    }
+}
+
+float ParticleEmitter::RandomGenerator::nextFloat()
+{
+    return (float)(nextUInt() >> 8) * (1.0f / 16777216.0f);
+}
+
+unsigned int ParticleEmitter::RandomGenerator::nextUInt()
+{
+    if (_bufferIndex == 4)
+    {
+        next4(_buffer);
+        _bufferIndex = 0;
+    }
+    return _buffer[_bufferIndex++];
+}
+
+ParticleEmitter::ParticleData::ParticleData()
+    : _frame(NULL), _buffer(NULL)
+{
+    memset(_streams, 0, sizeof(_streams));
+}
+
+ParticleEmitter::ParticleData::~ParticleData()
+{
+    SAFE_DELETE_ARRAY(_buffer);
+    SAFE_DELETE_ARRAY(_frame);
+}
+
+void ParticleEmitter::ParticleData::allocate(unsigned int capacity)
+{
+    SAFE_DELETE_ARRAY(_buffer);
+    SAFE_DELETE_ARRAY(_frame);
+
+    // Pad each stream to a multiple of four particles so that every stream starts on a
+    // 16-byte boundary and the SIMD kernels never need a scalar tail loop.
+    const unsigned int stride = (capacity + 3) & ~3u;
+    const size_t size = (size_t)stride * STREAM_COUNT;
+    _buffer = new float[size + 3];
+    memset(_buffer, 0, (size + 3) * sizeof(float));
+    float* base = (float*)(((uintptr_t)_buffer + 15) & ~(uintptr_t)15);
+    for (unsigned int i = 0; i < STREAM_COUNT; ++i)
+    {
+        _streams[i] = base + (size_t)i * stride;
+    }
+
+    _frame = new unsigned int[stride];
+    memset(_frame, 0, stride * sizeof(unsigned int));
+}
+
+void ParticleEmitter::ParticleData::copy(unsigned int dst, unsigned int src)
+{
+    for (unsigned int i = 0; i < STREAM_COUNT; ++i)
+    {
+        _streams[i][dst] = _streams[i][src];
+    }
+    _frame[dst] = _frame[src];
+}
+
+void ParticleEmitter::integrateParticles(ParticleData& d, unsigned int count, float elapsedMs, float elapsedSecs)
+{
+    float* px = d[ParticleData::POSITION_X];
+    float* py = d[ParticleData::POSITION_Y];
+    float* pz = d[ParticleData::POSITION_Z];
+    float* vx = d[ParticleData::VELOCITY_X];
+    float* vy = d[ParticleData::VELOCITY_Y];
+    float* vz = d[ParticleData::VELOCITY_Z];
+    const float* ax = d[ParticleData::ACCELERATION_X];
+    const float* ay = d[ParticleData::ACCELERATION_Y];
+    const float* az = d[ParticleData::ACCELERATION_Z];
+    float* angle = d[ParticleData::ANGLE];
+    const float* angleSpeed = d[ParticleData::ROTATION_PER_PARTICLE_SPEED];
+    float* energy = d[ParticleData::ENERGY];
+    const float* energyStart = d[ParticleData::ENERGY_START];
+    float* size = d[ParticleData::SIZE];
+    const float* sizeStart = d[ParticleData::SIZE_START];
+    const float* sizeEnd = d[ParticleData::SIZE_END];
+
+#if defined(GP_USE_SSE)
+    // The streams are padded to a multiple of four, so the padding lanes are simulated
+    // along with the live particles and simply ignored.
+    const __m128 ms = _mm_set1_ps(elapsedMs);
+    const __m128 dt = _mm_set1_ps(elapsedSecs);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128 e = _mm_sub_ps(_mm_load_ps(&energy[i]), ms);
+        _mm_store_ps(&energy[i], e);
+
+        __m128 v;
+        v = _mm_add_ps(_mm_load_ps(&vx[i]), _mm_mul_ps(_mm_load_ps(&ax[i]), dt));
+        _mm_store_ps(&vx[i], v);
+        _mm_store_ps(&px[i], _mm_add_ps(_mm_load_ps(&px[i]), _mm_mul_ps(v, dt)));
+        v = _mm_add_ps(_mm_load_ps(&vy[i]), _mm_mul_ps(_mm_load_ps(&ay[i]), dt));
+        _mm_store_ps(&vy[i], v);
+        _mm_store_ps(&py[i], _mm_add_ps(_mm_load_ps(&py[i]), _mm_mul_ps(v, dt)));
+        v = _mm_add_ps(_mm_load_ps(&vz[i]), _mm_mul_ps(_mm_load_ps(&az[i]), dt));
+        _mm_store_ps(&vz[i], v);
+        _mm_store_ps(&pz[i], _mm_add_ps(_mm_load_ps(&pz[i]), _mm_mul_ps(v, dt)));
+
+        _mm_store_ps(&angle[i], _mm_add_ps(_mm_load_ps(&angle[i]), _mm_mul_ps(_mm_load_ps(&angleSpeed[i]), dt)));
+
+        // Simple linear interpolation of color and size.
+        __m128 percent = _mm_sub_ps(one, _mm_div_ps(e, _mm_load_ps(&energyStart[i])));
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            const float* start = d._streams[ParticleData::COLOR_START_R + c];
+            const float* end = d._streams[ParticleData::COLOR_END_R + c];
+            float* color = d._streams[ParticleData::COLOR_R + c];
+            __m128 s = _mm_load_ps(&start[i]);
+            _mm_store_ps(&color[i], _mm_add_ps(s, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&end[i]), s), percent)));
+        }
+        __m128 s = _mm_load_ps(&sizeStart[i]);
+        _mm_store_ps(&size[i], _mm_add_ps(s, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&sizeEnd[i]), s), percent)));
+    }
+#elif defined(GP_USE_NEON)
+    const float32x4_t ms = vdupq_n_f32(elapsedMs);
+    const float32x4_t dt = vdupq_n_f32(elapsedSecs);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        float32x4_t e = vsubq_f32(vld1q_f32(&energy[i]), ms);
+        vst1q_f32(&energy[i], e);
+
+        float32x4_t v;
+        v = vmlaq_f32(vld1q_f32(&vx[i]), vld1q_f32(&ax[i]), dt);
+        vst1q_f32(&vx[i], v);
+        vst1q_f32(&px[i], vmlaq_f32(vld1q_f32(&px[i]), v, dt));
+        v = vmlaq_f32(vld1q_f32(&vy[i]), vld1q_f32(&ay[i]), dt);
+        vst1q_f32(&vy[i], v);
+        vst1q_f32(&py[i], vmlaq_f32(vld1q_f32(&py[i]), v, dt));
+        v = vmlaq_f32(vld1q_f32(&vz[i]), vld1q_f32(&az[i]), dt);
+        vst1q_f32(&vz[i], v);
+        vst1q_f32(&pz[i], vmlaq_f32(vld1q_f32(&pz[i]), v, dt));
+
+        vst1q_f32(&angle[i], vmlaq_f32(vld1q_f32(&angle[i]), vld1q_f32(&angleSpeed[i]), dt));
+
+        // Simple linear interpolation of color and size. NEON has no divide, so refine the
+        // reciprocal estimate of the starting energy with two Newton-Raphson steps.
+        float32x4_t es = vld1q_f32(&energyStart[i]);
+        float32x4_t r = vrecpeq_f32(es);
+        r = vmulq_f32(vrecpsq_f32(es, r), r);
+        r = vmulq_f32(vrecpsq_f32(es, r), r);
+        float32x4_t percent = vsubq_f32(one, vmulq_f32(e, r));
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            const float* start = d._streams[ParticleData::COLOR_START_R + c];
+            const float* end = d._streams[ParticleData::COLOR_END_R + c];
+            float* color = d._streams[ParticleData::COLOR_R + c];
+            float32x4_t s = vld1q_f32(&start[i]);
+            vst1q_f32(&color[i], vmlaq_f32(s, vsubq_f32(vld1q_f32(&end[i]), s), percent));
+        }
+        float32x4_t s = vld1q_f32(&sizeStart[i]);
+        vst1q_f32(&size[i], vmlaq_f32(s, vsubq_f32(vld1q_f32(&sizeEnd[i]), s), percent));
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        energy[i] -= elapsedMs;
+
+        vx[i] += ax[i] * elapsedSecs;
+        vy[i] += ay[i] * elapsedSecs;
+        vz[i] += az[i] * elapsedSecs;
+        px[i] += vx[i] * elapsedSecs;
+        py[i] += vy[i] * elapsedSecs;
+        pz[i] += vz[i] * elapsedSecs;
+
+        angle[i] += angleSpeed[i] * elapsedSecs;
+
+        // Simple linear interpolation of color and size.
+        float percent = 1.0f - (energy[i] / energyStart[i]);
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            const float start = d._streams[ParticleData::COLOR_START_R + c][i];
+            const float end = d._streams[ParticleData::COLOR_END_R + c][i];
+            d._streams[ParticleData::COLOR_R + c][i] = start + (end - start) * percent;
+        }
+        size[i] = sizeStart[i] + (sizeEnd[i] - sizeStart[i]) * percent;
+    }
+#endif
+}
+
+unsigned int ParticleEmitter::findDeadParticle(const float* energy, unsigned int start, unsigned int count)
+{
+    unsigned int i = start;
+
+#if defined(GP_USE_SSE) || defined(GP_USE_NEON)
+    // Check the particles up to the next four particle boundary one at a time,
+    // then skip over whole groups of four living particles at once.
+    for (; i < count && (i & 3) != 0; ++i)
+    {
+        if (energy[i] <= 0.0f)
+            return i;
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+#if defined(GP_USE_SSE)
+        if (_mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(&energy[i]), _mm_setzero_ps())) != 0)
+            break;
+#else
+        uint32x4_t dead = vcleq_f32(vld1q_f32(&energy[i]), vdupq_n_f32(0.0f));
+        uint32x2_t any = vorr_u32(vget_low_u32(dead), vget_high_u32(dead));
+        if ((vget_lane_u32(any, 0) | vget_lane_u32(any, 1)) != 0)
+            break;
+#endif
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (energy[i] <= 0.0f)
+            return i;
+    }
+    return count;
+}
+
 ParticleEmitter* ParticleEmitter::create(const char* textureFile, BlendMode blendMode, unsigned int particleCountMax)
 {
     Texture* texture = Texture::create(textureFile, true);
@@ -263,6 +605,17 @@ unsigned int ParticleEmitter::getEmissionRate() const
     return _emissionRate;
 }
 
+void ParticleEmitter::setRandomSeed(unsigned int seed)
+{
+    _randomSeed = seed;
+    _random.seed(seed);
+}
+
+unsigned int ParticleEmitter::getRandomSeed() const
+{
+    return _randomSeed;
+}
+
 void ParticleEmitter::setEmissionRate(unsigned int rate)
 {
     GP_ASSERT(rate);
@@ -300,7 +653,6 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
 
     // Limit particleCount so as not to go over _particleCountMax.
     if (particleCount + _particleCount > _particleCountMax)
@@ -317,67 +669,121 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[13] = 0.0f;
     world.m[14] = 0.0f;
 
-    // Emit the new particles.
-    for (unsigned int i = 0; i < particleCount; i++)
+    if (particleCount == 0)
+        return;
+
+    // Generate each component of the new particles as one batch, directly into the particle streams.
+    ParticleData& d = _particles;
+    const unsigned int first = _particleCount;
+    const unsigned int end = first + particleCount;
+
+    const float* colorStart = &_colorStart.x;
+    const float* colorStartVar = &_colorStartVar.x;
+    const float* colorEnd = &_colorEnd.x;
+    const float* colorEndVar = &_colorEndVar.x;
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+        float* start = d._streams[ParticleData::COLOR_START_R + c] + first;
+        generateScalarsInVariance(start, particleCount, colorStart[c], colorStartVar[c]);
+        generateScalarsInVariance(d._streams[ParticleData::COLOR_END_R + c] + first, particleCount, colorEnd[c], colorEndVar[c]);
+        memcpy(d._streams[ParticleData::COLOR_R + c] + first, start, particleCount * sizeof(float));
+    }
+
+    generateScalars(d[ParticleData::ENERGY_START] + first, particleCount, _energyMin, _energyMax);
+    memcpy(d[ParticleData::ENERGY] + first, d[ParticleData::ENERGY_START] + first, particleCount * sizeof(float));
+    generateScalars(d[ParticleData::SIZE_START] + first, particleCount, _sizeStartMin, _sizeStartMax);
+    memcpy(d[ParticleData::SIZE] + first, d[ParticleData::SIZE_START] + first, particleCount * sizeof(float));
+    generateScalars(d[ParticleData::SIZE_END] + first, particleCount, _sizeEndMin, _sizeEndMax);
+    generateScalars(d[ParticleData::ROTATION_PER_PARTICLE_SPEED] + first, particleCount, _rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+    generateScalars(d[ParticleData::ROTATION_SPEED] + first, particleCount, _rotationSpeedMin, _rotationSpeedMax);
+
+    // The initial angle is a random fraction of the per particle rotation speed.
+    float* angle = d[ParticleData::ANGLE];
+    const float* rotationPerParticleSpeed = d[ParticleData::ROTATION_PER_PARTICLE_SPEED];
+    _random.fill(angle + first, particleCount);
+    for (unsigned int i = first; i < end; ++i)
+    {
+        angle[i] *= rotationPerParticleSpeed[i];
+    }
+
+    // Only initial position can be generated within an ellipsoidal domain.
+    if (_ellipsoid)
+    {
+        for (unsigned int i = first; i < end; ++i)
+        {
+            Vector3 position;
+            generateVectorInEllipsoid(_position, _positionVar, &position);
+            d[ParticleData::POSITION_X][i] = position.x;
+            d[ParticleData::POSITION_Y][i] = position.y;
+            d[ParticleData::POSITION_Z][i] = position.z;
+        }
+    }
+    else
+    {
+        generateScalarsInVariance(d[ParticleData::POSITION_X] + first, particleCount, _position.x, _positionVar.x);
+        generateScalarsInVariance(d[ParticleData::POSITION_Y] + first, particleCount, _position.y, _positionVar.y);
+        generateScalarsInVariance(d[ParticleData::POSITION_Z] + first, particleCount, _position.z, _positionVar.z);
+    }
+    generateScalarsInVariance(d[ParticleData::VELOCITY_X] + first, particleCount, _velocity.x, _velocityVar.x);
+    generateScalarsInVariance(d[ParticleData::VELOCITY_Y] + first, particleCount, _velocity.y, _velocityVar.y);
+    generateScalarsInVariance(d[ParticleData::VELOCITY_Z] + first, particleCount, _velocity.z, _velocityVar.z);
+    generateScalarsInVariance(d[ParticleData::ACCELERATION_X] + first, particleCount, _acceleration.x, _accelerationVar.x);
+    generateScalarsInVariance(d[ParticleData::ACCELERATION_Y] + first, particleCount, _acceleration.y, _accelerationVar.y);
+    generateScalarsInVariance(d[ParticleData::ACCELERATION_Z] + first, particleCount, _acceleration.z, _accelerationVar.z);
+    generateScalarsInVariance(d[ParticleData::ROTATION_AXIS_X] + first, particleCount, _rotationAxis.x, _rotationAxisVar.x);
+    generateScalarsInVariance(d[ParticleData::ROTATION_AXIS_Y] + first, particleCount, _rotationAxis.y, _rotationAxisVar.y);
+    generateScalarsInVariance(d[ParticleData::ROTATION_AXIS_Z] + first, particleCount, _rotationAxis.z, _rotationAxisVar.z);
+
+    // Initial position, velocity and acceleration can all be relative to the emitter's transform.
+    // Rotate specified properties by the node's rotation, and translate position relative to
+    // the node's world space.
+    const float* rotationSpeed = d[ParticleData::ROTATION_SPEED];
+    for (unsigned int i = first; i < end; ++i)
     {
-        Particle* p = &_particles[_particleCount];
-
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
-
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
-
-        // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
-
-        // Initial position, velocity and acceleration can all be relative to the emitter's transform.
-        // Rotate specified properties by the node's rotation.
+        Vector3 position(d[ParticleData::POSITION_X][i], d[ParticleData::POSITION_Y][i], d[ParticleData::POSITION_Z][i]);
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(&position);
         }
+        position.add(translation);
+        d[ParticleData::POSITION_X][i] = position.x;
+        d[ParticleData::POSITION_Y][i] = position.y;
+        d[ParticleData::POSITION_Z][i] = position.z;
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            Vector3 velocity(d[ParticleData::VELOCITY_X][i], d[ParticleData::VELOCITY_Y][i], d[ParticleData::VELOCITY_Z][i]);
+            world.transformPoint(&velocity);
+            d[ParticleData::VELOCITY_X][i] = velocity.x;
+            d[ParticleData::VELOCITY_Y][i] = velocity.y;
+            d[ParticleData::VELOCITY_Z][i] = velocity.z;
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            Vector3 acceleration(d[ParticleData::ACCELERATION_X][i], d[ParticleData::ACCELERATION_Y][i], d[ParticleData::ACCELERATION_Z][i]);
+            world.transformPoint(&acceleration);
+            d[ParticleData::ACCELERATION_X][i] = acceleration.x;
+            d[ParticleData::ACCELERATION_Y][i] = acceleration.y;
+            d[ParticleData::ACCELERATION_Z][i] = acceleration.z;
         }
 
         // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        Vector3 rotationAxis(d[ParticleData::ROTATION_AXIS_X][i], d[ParticleData::ROTATION_AXIS_Y][i], d[ParticleData::ROTATION_AXIS_Z][i]);
+        if (rotationSpeed[i] != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(&rotationAxis);
+            d[ParticleData::ROTATION_AXIS_X][i] = rotationAxis.x;
+            d[ParticleData::ROTATION_AXIS_Y][i] = rotationAxis.y;
+            d[ParticleData::ROTATION_AXIS_Z][i] = rotationAxis.z;
         }
 
-        // Translate position relative to the node's world space.
-        p->_position.add(translation);
-
         // Initial sprite frame.
-        if (_spriteFrameRandomOffset > 0)
-        {
-            p->_frame = rand() % _spriteFrameRandomOffset;
-        }
-        else
-        {
-            p->_frame = 0;
-        }
-        p->_timeOnCurrentFrame = 0.0f;
-
-        ++_particleCount;
+        d._frame[i] = _spriteFrameRandomOffset > 0 ? _random.nextUInt() % _spriteFrameRandomOffset : 0;
+        d[ParticleData::TIME_ON_CURRENT_FRAME][i] = 0.0f;
     }
+
+    _particleCount = end;
 }
 
 unsigned int ParticleEmitter::getParticlesCount() const
@@ -744,37 +1150,28 @@ bool ParticleEmitter::getOrbitAcceleration() const
     return _orbitAcceleration;
 }
 
-long ParticleEmitter::generateScalar(long min, long max)
+void ParticleEmitter::generateScalars(float* dst, unsigned int count, float min, float max)
 {
-    // Note: this is not a very good RNG, but it should be suitable for our purposes.
-    long r = 0;
-    for (unsigned int i = 0; i < sizeof(long)/sizeof(int); i++)
+    GP_ASSERT(dst);
+
+    _random.fill(dst, count);
+    const float range = max - min;
+    for (unsigned int i = 0; i < count; ++i)
     {
-        r = r << 8; // sizeof(int) * CHAR_BITS
-        r |= rand();
+        dst[i] = min + range * dst[i];
     }
-
-    // Now we have a random long between 0 and MAX_LONG.  We need to clamp it between min and max.
-    r %= max - min;
-    r += min;
-
-    return r;
 }
 
-float ParticleEmitter::generateScalar(float min, float max)
-{
-    return min + (max - min) * MATH_RANDOM_0_1();
-}
-
-void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst)
+void ParticleEmitter::generateScalarsInVariance(float* dst, unsigned int count, float base, float variance)
 {
     GP_ASSERT(dst);
 
-    // Scale each component of the variance vector by a random float
-    // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
+    // Scale the variance by a random float between -1 and 1, then add this to the base.
+    _random.fill(dst, count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = base + variance * (2.0f * dst[i] - 1.0f);
+    }
 }
 
 void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst)
@@ -784,11 +1181,11 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     // Generate a point within a unit cube, then reject if the point is not in a unit sphere.
     do
     {
-        dst->x = MATH_RANDOM_MINUS1_1();
-        dst->y = MATH_RANDOM_MINUS1_1();
-        dst->z = MATH_RANDOM_MINUS1_1();
-    } while (dst->length() > 1.0f);
-    
+        dst->x = 2.0f * _random.nextFloat() - 1.0f;
+        dst->y = 2.0f * _random.nextFloat() - 1.0f;
+        dst->z = 2.0f * _random.nextFloat() - 1.0f;
+    } while (dst->lengthSquared() > 1.0f);
+
     // Scale this point by the scaling vector.
     dst->x *= scale.x;
     dst->y *= scale.y;
@@ -798,30 +1195,6 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     dst->add(center);
 }
 
-void ParticleEmitter::generateVector(const Vector3& base, const Vector3& variance, Vector3* dst, bool ellipsoid)
-{
-    if (ellipsoid)
-    {
-        generateVectorInEllipsoid(base, variance, dst);
-    }
-    else
-    {
-        generateVectorInRect(base, variance, dst);
-    }
-}
-
-void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance, Vector4* dst)
-{
-    GP_ASSERT(dst);
-
-    // Scale each component of the variance color by a random float
-    // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
-    dst->w = base.w + variance.w * MATH_RANDOM_MINUS1_1();
-}
-
 ParticleEmitter::BlendMode ParticleEmitter::getBlendModeFromString(const char* str)
 {
     GP_ASSERT(str);
@@ -863,14 +1236,14 @@ void ParticleEmitter::update(float elapsedTime)
 
     // Cap particle updates at a maximum rate. This saves processing
     // and also improves precision since updating with very small
-    // time increments is more lossy.
-    static double runningTime = 0;
-    runningTime += elapsedTime;
-    if (runningTime < PARTICLE_UPDATE_RATE_MAX)
-        return;    
+    // time increments is more lossy. The time is accumulated per emitter
+    // so that emitters can be updated independently of each other.
+    _lastUpdated += elapsedTime;
+    if (_lastUpdated < PARTICLE_UPDATE_RATE_MAX)
+        return;
 
-    float elapsedMs = runningTime;
-    runningTime = 0;
+    float elapsedMs = _lastUpdated;
+    _lastUpdated = 0;
 
     float elapsedSecs = elapsedMs * 0.001f;
 
@@ -893,92 +1266,126 @@ void ParticleEmitter::update(float elapsedTime)
         }
     }
 
-    // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
-    {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedMs;
-
-        if (p->_energy > 0L)
-        {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
-
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
-
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
-
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
+    if (_particleCount == 0)
+        return;
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    ParticleData& d = _particles;
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+    // Rotate the velocity and acceleration of particles that spin around an axis.
+    if (_rotationSpeedMin != 0.0f || _rotationSpeedMax != 0.0f)
+    {
+        const float* rotationSpeed = d[ParticleData::ROTATION_SPEED];
+        for (unsigned int i = 0; i < _particleCount; ++i)
+        {
+            Vector3 axis(d[ParticleData::ROTATION_AXIS_X][i], d[ParticleData::ROTATION_AXIS_Y][i], d[ParticleData::ROTATION_AXIS_Z][i]);
+            if (rotationSpeed[i] == 0.0f || axis.isZero())
+                continue;
+
+            Matrix::createRotation(axis, rotationSpeed[i] * elapsedSecs, &_rotation);
+
+            Vector3 v(d[ParticleData::VELOCITY_X][i], d[ParticleData::VELOCITY_Y][i], d[ParticleData::VELOCITY_Z][i]);
+            Vector3 a(d[ParticleData::ACCELERATION_X][i], d[ParticleData::ACCELERATION_Y][i], d[ParticleData::ACCELERATION_Z][i]);
+            _rotation.transformPoint(&v);
+            _rotation.transformPoint(&a);
+            d[ParticleData::VELOCITY_X][i] = v.x;
+            d[ParticleData::VELOCITY_Y][i] = v.y;
+            d[ParticleData::VELOCITY_Z][i] = v.z;
+            d[ParticleData::ACCELERATION_X][i] = a.x;
+            d[ParticleData::ACCELERATION_Y][i] = a.y;
+            d[ParticleData::ACCELERATION_Z][i] = a.z;
+        }
+    }
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    // Integrate motion and interpolate color and size for all particles at once.
+    integrateParticles(d, _particleCount, elapsedMs, elapsedSecs);
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        const float* energy = d[ParticleData::ENERGY];
+        const float* energyStart = d[ParticleData::ENERGY_START];
+        float* timeOnCurrentFrame = d[ParticleData::TIME_ON_CURRENT_FRAME];
+        unsigned int* frame = d._frame;
+        for (unsigned int i = 0; i < _particleCount; ++i)
+        {
+            if (energy[i] <= 0.0f)
+                continue;
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+            if (!_spriteLooped)
             {
-                if (!_spriteLooped)
+                // The last frame should finish exactly when the particle dies.
+                float percent = 1.0f - (energy[i] / energyStart[i]);
+                float percentSpent = 0.0f;
+                for (unsigned int j = 0; j < frame[i]; j++)
                 {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
+                    percentSpent += _spritePercentPerFrame;
                 }
-                else
+                timeOnCurrentFrame[i] = percent - percentSpent;
+                if (frame[i] < _spriteFrameCount - 1 &&
+                    timeOnCurrentFrame[i] >= _spritePercentPerFrame)
                 {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
+                    ++frame[i];
+                }
+            }
+            else
+            {
+                // _spriteFrameDurationSecs is an absolute time measured in seconds,
+                // and the animation repeats indefinitely.
+                timeOnCurrentFrame[i] += elapsedSecs;
+                if (timeOnCurrentFrame[i] >= _spriteFrameDurationSecs)
+                {
+                    timeOnCurrentFrame[i] -= _spriteFrameDurationSecs;
+                    ++frame[i];
+                    if (frame[i] == _spriteFrameCount)
                     {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
+                        frame[i] = 0;
                     }
                 }
             }
         }
-        else
+    }
+
+    // Remove dead particles by moving the particle furthest from the start of the
+    // array down to take their place. The moved particle is checked in turn.
+    unsigned int i = 0;
+    while ((i = findDeadParticle(d[ParticleData::ENERGY], i, _particleCount)) < _particleCount)
+    {
+        --_particleCount;
+        if (i != _particleCount)
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
-            {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
-            }
-            --_particleCount;
+            d.copy(i, _particleCount);
         }
     }
 }
 
+void ParticleEmitter::update(ParticleEmitter** emitters, unsigned int count, float elapsedTime)
+{
+    GP_ASSERT(emitters || count == 0);
+
+    // Emitting particles reads the world matrix of the emitter's node, which is resolved
+    // lazily and may be shared with other emitters through a common parent. Resolve them
+    // all up front so the parallel updates below only read node state.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (emitters[i]->_node)
+            emitters[i]->_node->getWorldMatrix();
+    }
+
+    JobScheduler* scheduler = Game::getInstance()->getJobScheduler();
+    if (scheduler)
+    {
+        scheduler->parallelFor(count, [emitters, elapsedTime](unsigned int i)
+        {
+            emitters[i]->update(elapsedTime);
+        });
+    }
+    else
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            emitters[i]->update(elapsedTime);
+    }
+}
+
 unsigned int ParticleEmitter::draw(bool wireframe)
 {
     if (!isActive())
@@ -987,7 +1394,6 @@ unsigned int ParticleEmitter::draw(bool wireframe)
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -1011,13 +1417,17 @@ unsigned int ParticleEmitter::draw(bool wireframe)
         Vector3 up;
         cameraWorldMatrix.getUpVector(&up);
 
+        const ParticleData& d = _particles;
         for (unsigned int i = 0; i < _particleCount; i++)
         {
-            Particle* p = &_particles[i];
-
-            _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                p->_color, pivot, p->_angle);
+            const Vector3 position(d[ParticleData::POSITION_X][i], d[ParticleData::POSITION_Y][i], d[ParticleData::POSITION_Z][i]);
+            const Vector4 color(d[ParticleData::COLOR_R][i], d[ParticleData::COLOR_G][i], d[ParticleData::COLOR_B][i], d[ParticleData::COLOR_A][i]);
+            const float size = d[ParticleData::SIZE][i];
+            const float* texCoords = &_spriteTextureCoords[d._frame[i] * 4];
+
+            _spriteBatch->draw(position, right, up, size, size,
+                                texCoords[0], texCoords[1], texCoords[2], texCoords[3],
+                                color, pivot, d[ParticleData::ANGLE][i]);
         }
 
         // Render.
@@ -1064,6 +1474,7 @@ Drawable* ParticleEmitter::clone(NodeCloneContext& context)
     clone->_orbitPosition = _orbitPosition;
     clone->_orbitVelocity = _orbitVelocity;
     clone->_orbitAcceleration = _orbitAcceleration;
+    clone->setRandomSeed(_randomSeed);
 
     return clone;
 }
@@ -244,6 +244,24 @@ public:
      */
     unsigned int getEmissionRate() const;
 
+    /**
+     * Sets the seed of the random number generator used to emit particles.
+     *
+     * Each emitter has its own generator. Two emitters with the same properties and seed
+     * emit identical particles for the same sequence of updates, which allows effects to
+     * be replayed deterministically.
+     *
+     * @param seed The seed for the random number generator.
+     */
+    void setRandomSeed(unsigned int seed);
+
+    /**
+     * Gets the seed last used to initialize the random number generator of this emitter.
+     *
+     * @return The random seed.
+     */
+    unsigned int getRandomSeed() const;
+
     /**
      * Starts emitting particles over time at this ParticleEmitter's emission rate.
      *
@@ -707,6 +725,20 @@ public:
      */
     void update(float elapsedTime);
 
+    /**
+     * Updates a set of particle emitters in parallel on the game's job scheduler.
+     *
+     * Each emitter is updated by a single thread, so this is equivalent to calling
+     * update(float) on each emitter, but spreads independent emitters across cores.
+     * The emitters must all be distinct.
+     *
+     * @param emitters The particle emitters to update.
+     * @param count The number of emitters in the array.
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     * @script{ignore}
+     */
+    static void update(ParticleEmitter** emitters, unsigned int count, float elapsedTime);
+
     /**
      * @see Drawable::draw
      *
@@ -746,55 +778,144 @@ private:
      */
     ParticleEmitter& operator=(const ParticleEmitter&);
 
-    // Generates a scalar within the range defined by min and max.
-    float generateScalar(float min, float max);
-
-    long generateScalar(long min, long max);
-
-    // Generates a vector within the domain defined by a base vector and its variance.
-    void generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst);
-
     // Generates a vector within the ellipsoidal domain defined by a center point and scale vector.
     void generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst);
 
-    void generateVector(const Vector3& base, const Vector3& variance, Vector3* dst, bool ellipsoid);
+    // Fills dst with count random values in the range [min, max].
+    void generateScalars(float* dst, unsigned int count, float min, float max);
 
-    // Generates a color within the domain defined by a base vector and its variance.
-    void generateColor(const Vector4& base, const Vector4& variance, Vector4* dst);
+    // Fills dst with count random values within the domain defined by a base value and its variance.
+    void generateScalarsInVariance(float* dst, unsigned int count, float base, float variance);
 
     // Gets the blend mode from string.
     static ParticleEmitter::BlendMode getBlendModeFromString(const char* src);
 
+    class ParticleData;
+
+    // Integrates motion and interpolates color and size for the first count particles.
+    static void integrateParticles(ParticleData& particles, unsigned int count, float elapsedMs, float elapsedSecs);
+
+    // Finds the first particle at or after start that has run out of energy, or returns count if none has.
+    static unsigned int findDeadParticle(const float* energy, unsigned int start, unsigned int count);
+
     /**
-     * Defines the data for a single particle in the system.
+     * Defines a fast random number generator that produces four values at a time.
+     *
+     * The generator runs four independent xoshiro128+ streams side by side so that the
+     * streams advance together in SIMD registers and batches of values are cheap to generate.
      */
-    class Particle
+    class RandomGenerator
     {
+    public:
+
+        RandomGenerator();
+
+        /**
+         * Resets the generator to the sequence defined by the given seed.
+         */
+        void seed(unsigned int seed);
+
+        /**
+         * Fills dst with count uniformly distributed values in the range [0, 1).
+         */
+        void fill(float* dst, unsigned int count);
+
+        /**
+         * Gets the next uniformly distributed value in the range [0, 1).
+         */
+        float nextFloat();
+
+        /**
+         * Gets the next uniformly distributed 32-bit value.
+         */
+        unsigned int nextUInt();
 
+    private:
+
+        /**
+         * Advances all four streams, writing one value from each into dst.
+         */
+        void next4(unsigned int* dst);
+
+        // The state of the four streams, stored word-major: _state[word * 4 + stream].
+        unsigned int _state[16];
+        unsigned int _buffer[4];
+        unsigned int _bufferIndex;
+    };
+
+    /**
+     * Defines the data for all of the particles in the system.
+     *
+     * Each component of the particles is stored in its own 16-byte aligned array (structure of arrays)
+     * so that the particles can be simulated four at a time with SIMD instructions, and so that each
+     * stage of the update only touches the memory of the components it uses.
+     */
+    class ParticleData
+    {
     public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
+
+        /**
+         * The float component arrays of the particles.
+         */
+        enum Stream
+        {
+            POSITION_X, POSITION_Y, POSITION_Z,
+            VELOCITY_X, VELOCITY_Y, VELOCITY_Z,
+            ACCELERATION_X, ACCELERATION_Y, ACCELERATION_Z,
+            COLOR_START_R, COLOR_START_G, COLOR_START_B, COLOR_START_A,
+            COLOR_END_R, COLOR_END_G, COLOR_END_B, COLOR_END_A,
+            COLOR_R, COLOR_G, COLOR_B, COLOR_A,
+            ROTATION_PER_PARTICLE_SPEED,
+            ROTATION_AXIS_X, ROTATION_AXIS_Y, ROTATION_AXIS_Z,
+            ROTATION_SPEED,
+            ANGLE,
+            ENERGY_START,
+            ENERGY,
+            SIZE_START,
+            SIZE_END,
+            SIZE,
+            TIME_ON_CURRENT_FRAME,
+            STREAM_COUNT
+        };
+
+        ParticleData();
+
+        ~ParticleData();
+
+        /**
+         * Allocates the component arrays for the given number of particles.
+         * The arrays are padded to a multiple of four particles.
+         */
+        void allocate(unsigned int capacity);
+
+        /**
+         * Copies all of the components of the particle at index src to index dst.
+         */
+        void copy(unsigned int dst, unsigned int src);
+
+        /**
+         * Gets the component array for the given stream.
+         */
+        float* operator[](Stream stream) const { return _streams[stream]; }
+
+        float* _streams[STREAM_COUNT];
+        unsigned int* _frame;
+
+    private:
+
+        ParticleData(const ParticleData& copy);
+
+        ParticleData& operator=(const ParticleData&);
+
+        float* _buffer;
     };
 
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    ParticleData _particles;
     unsigned int _emissionRate;
+    RandomGenerator _random;
+    unsigned int _randomSeed;
     bool _started;
     bool _ellipsoid;
     float _sizeStartMin;
@@ -1,5 +1,5 @@
 #ifndef GP_NO_PLATFORM
-#ifdef __linux__
+#if defined(__linux__) && !defined(GP_USE_NULL_GL)
 
 #include "Base.h"
 #include "Platform.h"
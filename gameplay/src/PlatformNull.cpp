@@ -0,0 +1,390 @@
+#ifndef GP_NO_PLATFORM
+#if defined(__linux__) && defined(GP_USE_NULL_GL)
+
+#include "Base.h"
+#include "Platform.h"
+#include "FileSystem.h"
+#include "Game.h"
+#include "NullGL.h"
+
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+
+int __argc = 0;
+char** __argv = 0;
+
+static struct timespec __timespec;
+static double __timeStart;
+static double __timeAbsolute;
+static double __timeStep = 0.0;
+static unsigned int __frameLimit = 0;
+static bool __vsync = WINDOW_VSYNC;
+static bool __multiSampling = false;
+static bool __cursorVisible = true;
+static int __windowSize[2];
+
+// Per-frame budget limits read from the 'headless/budget' config namespace. Zero means unlimited.
+static gameplay::NullGL::Stats __budget;
+
+// Peak and accumulated statistics over the whole run.
+static gameplay::NullGL::Stats __peakStats;
+static double __totalStats[8];
+static unsigned int __frameOverBudget = 0;
+
+namespace gameplay
+{
+
+extern void print(const char* format, ...)
+{
+    GP_ASSERT(format);
+    va_list argptr;
+    va_start(argptr, format);
+    vfprintf(stderr, format, argptr);
+    va_end(argptr);
+}
+
+extern int strcmpnocase(const char* s1, const char* s2)
+{
+    return strcasecmp(s1, s2);
+}
+
+static double timespec2millis(struct timespec *a)
+{
+    GP_ASSERT(a);
+    return (1000.0 * a->tv_sec) + (0.000001 * a->tv_nsec);
+}
+
+// Folds the statistics of the frame that just ended into the run totals and checks it against the budget.
+static void accumulateFrameStats()
+{
+    const NullGL::Stats& stats = NullGL::getFrameStats();
+    const unsigned int values[8] = { stats.drawCalls, stats.vertices, stats.clears, stats.stateChanges,
+                                     stats.uniformUploads, stats.bufferUploads, stats.textureUploads, stats.bytesUploaded };
+    unsigned int* peaks[8] = { &__peakStats.drawCalls, &__peakStats.vertices, &__peakStats.clears, &__peakStats.stateChanges,
+                               &__peakStats.uniformUploads, &__peakStats.bufferUploads, &__peakStats.textureUploads, &__peakStats.bytesUploaded };
+    const unsigned int limits[8] = { __budget.drawCalls, __budget.vertices, __budget.clears, __budget.stateChanges,
+                                     __budget.uniformUploads, __budget.bufferUploads, __budget.textureUploads, __budget.bytesUploaded };
+    bool overBudget = false;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        __totalStats[i] += values[i];
+        *peaks[i] = std::max(*peaks[i], values[i]);
+        if (limits[i] > 0 && values[i] > limits[i])
+            overBudget = true;
+    }
+    if (overBudget)
+        ++__frameOverBudget;
+}
+
+// Prints the run report and returns the process exit code (non-zero when the budget was exceeded).
+static int reportStats(double elapsedTime)
+{
+    static const char* names[8] = { "drawCalls", "vertices", "clears", "stateChanges",
+                                    "uniformUploads", "bufferUploads", "textureUploads", "bytesUploaded" };
+    const unsigned int peaks[8] = { __peakStats.drawCalls, __peakStats.vertices, __peakStats.clears, __peakStats.stateChanges,
+                                    __peakStats.uniformUploads, __peakStats.bufferUploads, __peakStats.textureUploads, __peakStats.bytesUploaded };
+    const unsigned int limits[8] = { __budget.drawCalls, __budget.vertices, __budget.clears, __budget.stateChanges,
+                                     __budget.uniformUploads, __budget.bufferUploads, __budget.textureUploads, __budget.bytesUploaded };
+
+    unsigned int frames = std::max(NullGL::getFrameCount(), 1u);
+    print("Null GL: %u frames submitted in %.1f ms\n", NullGL::getFrameCount(), elapsedTime);
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        if (limits[i] > 0)
+            print("  %-16s avg %12.1f  peak %10u  budget %10u\n", names[i], __totalStats[i] / frames, peaks[i], limits[i]);
+        else
+            print("  %-16s avg %12.1f  peak %10u\n", names[i], __totalStats[i] / frames, peaks[i]);
+    }
+    if (__frameOverBudget > 0)
+    {
+        print("Null GL: %u frame(s) exceeded the render budget.\n", __frameOverBudget);
+        return 1;
+    }
+    return 0;
+}
+
+Platform::Platform(Game* game) : _game(game)
+{
+}
+
+Platform::~Platform()
+{
+}
+
+Platform* Platform::create(Game* game)
+{
+    GP_ASSERT(game);
+
+    FileSystem::setResourcePath("./");
+    Platform* platform = new Platform(game);
+
+    // No display or GL context is created. The window size is only used as the
+    // size of the default frame buffer seen by the game.
+    __windowSize[0] = 1280;
+    __windowSize[1] = 800;
+    if (game->getConfig())
+    {
+        Properties* config = game->getConfig()->getNamespace("window", true);
+        if (config)
+        {
+            int width = config->getInt("width");
+            int height = config->getInt("height");
+            int samples = config->getInt("samples");
+            if (width != 0) __windowSize[0] = width;
+            if (height != 0) __windowSize[1] = height;
+            __multiSampling = samples > 0;
+        }
+
+        config = game->getConfig()->getNamespace("headless", true);
+        if (config)
+        {
+            __frameLimit = (unsigned int)config->getInt("frames");
+            __timeStep = config->getFloat("timeStep");
+            NullGL::setRecording(config->getBool("record"));
+
+            Properties* budget = config->getNamespace("budget", true);
+            if (budget)
+            {
+                __budget.drawCalls = (unsigned int)budget->getInt("drawCalls");
+                __budget.vertices = (unsigned int)budget->getInt("vertices");
+                __budget.clears = (unsigned int)budget->getInt("clears");
+                __budget.stateChanges = (unsigned int)budget->getInt("stateChanges");
+                __budget.uniformUploads = (unsigned int)budget->getInt("uniformUploads");
+                __budget.bufferUploads = (unsigned int)budget->getInt("bufferUploads");
+                __budget.textureUploads = (unsigned int)budget->getInt("textureUploads");
+                __budget.bytesUploaded = (unsigned int)budget->getInt("bytesUploaded");
+            }
+        }
+    }
+
+    print("GL version: null (headless)\n");
+
+    return platform;
+}
+
+int Platform::enterMessagePump()
+{
+    GP_ASSERT(_game);
+
+    // Get the initial time.
+    clock_gettime(CLOCK_REALTIME, &__timespec);
+    __timeStart = timespec2millis(&__timespec);
+    __timeAbsolute = 0L;
+
+    // Run the game.
+    _game->run();
+
+    while (true)
+    {
+        // Game state will be uninitialized if game was closed through Game::exit()
+        if (_game->getState() == Game::UNINITIALIZED)
+            break;
+
+        _game->frame();
+        swapBuffers();
+
+        if (__frameLimit > 0 && NullGL::getFrameCount() >= __frameLimit)
+            break;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &__timespec);
+    int result = reportStats(timespec2millis(&__timespec) - __timeStart);
+
+    if (_game->getState() != Game::UNINITIALIZED)
+        shutdownInternal();
+
+    return result;
+}
+
+void Platform::signalShutdown()
+{
+}
+
+bool Platform::canExit()
+{
+    return true;
+}
+
+unsigned int Platform::getDisplayWidth()
+{
+    return __windowSize[0];
+}
+
+unsigned int Platform::getDisplayHeight()
+{
+    return __windowSize[1];
+}
+
+double Platform::getAbsoluteTime()
+{
+    if (__timeStep > 0.0)
+    {
+        // Advance time by a fixed step per frame so that runs are reproducible.
+        __timeAbsolute = NullGL::getFrameCount() * __timeStep;
+        return __timeAbsolute;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &__timespec);
+    double now = timespec2millis(&__timespec);
+    __timeAbsolute = now - __timeStart;
+
+    return __timeAbsolute;
+}
+
+void Platform::setAbsoluteTime(double time)
+{
+    __timeAbsolute = time;
+}
+
+bool Platform::isVsync()
+{
+    return __vsync;
+}
+
+void Platform::setVsync(bool enable)
+{
+    __vsync = enable;
+}
+
+void Platform::swapBuffers()
+{
+    NullGL::endFrame();
+    accumulateFrameStats();
+}
+
+void Platform::sleep(long ms)
+{
+    usleep(ms * 1000);
+}
+
+void Platform::setMultiSampling(bool enabled)
+{
+    __multiSampling = enabled;
+}
+
+bool Platform::isMultiSampling()
+{
+    return __multiSampling;
+}
+
+void Platform::setMultiTouch(bool enabled)
+{
+    // not supported
+}
+
+bool Platform::isMultiTouch()
+{
+    return false;
+}
+
+bool Platform::hasAccelerometer()
+{
+    return false;
+}
+
+void Platform::getAccelerometerValues(float* pitch, float* roll)
+{
+    GP_ASSERT(pitch);
+    GP_ASSERT(roll);
+
+    *pitch = 0;
+    *roll = 0;
+}
+
+void Platform::getSensorValues(float* accelX, float* accelY, float* accelZ, float* gyroX, float* gyroY, float* gyroZ)
+{
+    if (accelX)
+        *accelX = 0;
+    if (accelY)
+        *accelY = 0;
+    if (accelZ)
+        *accelZ = 0;
+    if (gyroX)
+        *gyroX = 0;
+    if (gyroY)
+        *gyroY = 0;
+    if (gyroZ)
+        *gyroZ = 0;
+}
+
+void Platform::getArguments(int* argc, char*** argv)
+{
+    if (argc)
+        *argc = __argc;
+    if (argv)
+        *argv = __argv;
+}
+
+bool Platform::hasMouse()
+{
+    return false;
+}
+
+void Platform::setMouseCaptured(bool captured)
+{
+    // not supported
+}
+
+bool Platform::isMouseCaptured()
+{
+    return false;
+}
+
+void Platform::setCursorVisible(bool visible)
+{
+    __cursorVisible = visible;
+}
+
+bool Platform::isCursorVisible()
+{
+    return __cursorVisible;
+}
+
+void Platform::displayKeyboard(bool display)
+{
+    // not supported
+}
+
+void Platform::shutdownInternal()
+{
+    Game::getInstance()->shutdown();
+}
+
+bool Platform::isGestureSupported(Gesture::GestureEvent evt)
+{
+    return false;
+}
+
+void Platform::registerGesture(Gesture::GestureEvent evt)
+{
+}
+
+void Platform::unregisterGesture(Gesture::GestureEvent evt)
+{
+}
+
+bool Platform::isGestureRegistered(Gesture::GestureEvent evt)
+{
+    return false;
+}
+
+void Platform::pollGamepadState(Gamepad* gamepad)
+{
+}
+
+bool Platform::launchURL(const char* url)
+{
+    return false;
+}
+
+std::string Platform::displayFileDialog(size_t mode, const char* title, const char* filterDescription, const char* filterExtensions, const char* initialDirectory)
+{
+    return "";
+}
+
+}
+
+#endif
+#endif
@@ -3,9 +3,24 @@
 #include "FileSystem.h"
 #include "Quaternion.h"
 
+// Extension appended to the path of a properties file to get the path of its compiled form.
+#define PROPERTIES_COMPILED_EXTENSION ".gpp"
+
+// Compiled properties file version.
+#define PROPERTIES_COMPILED_VERSION_MAJOR 1
+#define PROPERTIES_COMPILED_VERSION_MINOR 0
+
 namespace gameplay
 {
 
+// Whether text properties files are compiled when they are loaded.
+static std::atomic<bool> __compileOnLoad(false);
+
+// Number of compiled files written, which makes the names of their temporary files unique.
+static std::atomic<unsigned int> __compiledFileCount(0);
+
+static const char __compiledSignature[9] = { '\xAB', 'G', 'P', 'P', '\xBB', '\r', '\n', '\x1A', '\n' };
+
 /**
  * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
  */
@@ -19,6 +34,73 @@ static signed char readChar(Stream* stream)
     return c;
 }
 
+/**
+ * Computes the 32-bit FNV-1a hash of the given data, continuing from the given hash.
+ */
+static unsigned int hashData(const unsigned char* data, size_t size, unsigned int hash)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Computes the size and hash of the contents of a stream, and rewinds it.
+ */
+static bool hashStream(Stream* stream, unsigned int* size, unsigned int* hash)
+{
+    size_t length = stream->length();
+    unsigned int h = 2166136261u;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(stream->borrow(length));
+    if (data)
+    {
+        h = hashData(data, length, h);
+    }
+    else
+    {
+        unsigned char buffer[4096];
+        size_t read;
+        while ((read = stream->read(buffer, 1, sizeof(buffer))) > 0)
+        {
+            h = hashData(buffer, read, h);
+        }
+    }
+    *size = (unsigned int)length;
+    *hash = h;
+    return stream->rewind();
+}
+
+/**
+ * Reads a length-prefixed string from a compiled properties file.
+ */
+static bool readCompiledString(Stream* stream, std::string* str)
+{
+    unsigned int length;
+    if (stream->read(&length, 4, 1) != 1 || length > stream->length() - (size_t)stream->position())
+        return false;
+
+    const char* data = reinterpret_cast<const char*>(stream->borrow(length));
+    if (data)
+    {
+        str->assign(data, length);
+        return true;
+    }
+    str->resize(length);
+    return length == 0 || stream->read(&(*str)[0], 1, length) == length;
+}
+
+/**
+ * Writes a length-prefixed string to a compiled properties file.
+ */
+static bool writeCompiledString(Stream* stream, const std::string& str)
+{
+    unsigned int length = (unsigned int)str.length();
+    return stream->write(&length, 4, 1) == 1 && (length == 0 || stream->write(str.c_str(), 1, length) == length);
+}
+
 // Utility functions (shared with SceneLoader).
 /** @script{ignore} */
 void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath);
@@ -33,6 +115,7 @@ Properties::Properties()
 Properties::Properties(const Properties& copy)
     : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties), _variables(NULL), _dirPath(NULL), _visited(false), _parent(copy._parent)
 {
+    rebuildPropertyIndex();
     setDirectoryPath(copy._dirPath);
     _namespaces = std::vector<Properties*>();
     std::vector<Properties*>::const_iterator it;
@@ -80,16 +163,9 @@ Properties* Properties::create(const char* url)
     std::vector<std::string> namespacePath;
     calculateNamespacePath(urlString, fileString, namespacePath);
 
-    std::unique_ptr<Stream> stream(FileSystem::open(fileString.c_str()));
-    if (stream.get() == NULL)
-    {
-        GP_WARN("Failed to open file '%s'.", fileString.c_str());
+    Properties* properties = loadFile(fileString.c_str());
+    if (properties == NULL)
         return NULL;
-    }
-
-    Properties* properties = new Properties(stream.get());
-    properties->resolveInheritance();
-    stream->close();
 
     // Get the specified properties object.
     Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
@@ -112,6 +188,241 @@ Properties* Properties::create(const char* url)
     return p;
 }
 
+bool Properties::compile(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::READ | FileSystem::MEMORY_MAPPED));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open file '%s'.", path);
+        return false;
+    }
+
+    unsigned int sourceSize;
+    unsigned int sourceHash;
+    if (!hashStream(stream.get(), &sourceSize, &sourceHash))
+    {
+        GP_WARN("Failed to read file '%s'.", path);
+        return false;
+    }
+
+    Properties* properties = new Properties(stream.get());
+    properties->resolveInheritance();
+    stream->close();
+
+    std::string compiledPath(path);
+    compiledPath.append(PROPERTIES_COMPILED_EXTENSION);
+    bool result = writeCompiledFile(properties, compiledPath.c_str(), sourceSize, sourceHash);
+    SAFE_DELETE(properties);
+
+    return result;
+}
+
+void Properties::setCompileOnLoad(bool enabled)
+{
+    __compileOnLoad = enabled;
+}
+
+Properties* Properties::loadFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    // The text is read a character at a time, so map it into memory where supported.
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::READ | FileSystem::MEMORY_MAPPED));
+    unsigned int sourceSize = 0;
+    unsigned int sourceHash = 0;
+    bool hashed = false;
+
+    // Load the compiled form if it was compiled from the current text, or if only the compiled form exists.
+    std::string compiledPath(path);
+    compiledPath.append(PROPERTIES_COMPILED_EXTENSION);
+    std::unique_ptr<Stream> compiled(FileSystem::open(compiledPath.c_str(), FileSystem::READ | FileSystem::MEMORY_MAPPED));
+    if (compiled.get())
+    {
+        char sig[9];
+        unsigned char version[2];
+        unsigned int source[2];
+        if (compiled->read(sig, 1, 9) == 9 && memcmp(sig, __compiledSignature, 9) == 0 &&
+            compiled->read(version, 1, 2) == 2 &&
+            version[0] == PROPERTIES_COMPILED_VERSION_MAJOR && version[1] == PROPERTIES_COMPILED_VERSION_MINOR &&
+            compiled->read(source, 4, 2) == 2)
+        {
+            // The text is only hashed when there is a compiled form to check it against.
+            if (stream.get())
+            {
+                if (!hashStream(stream.get(), &sourceSize, &sourceHash))
+                {
+                    GP_WARN("Failed to read file '%s'.", path);
+                    return NULL;
+                }
+                hashed = true;
+            }
+            if (stream.get() == NULL || (source[0] == sourceSize && source[1] == sourceHash))
+            {
+                Properties* properties = new Properties();
+                if (properties->readCompiled(compiled.get()))
+                    return properties;
+
+                GP_WARN("Failed to read compiled properties file '%s'.", compiledPath.c_str());
+                SAFE_DELETE(properties);
+            }
+        }
+        compiled.reset();
+    }
+
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    bool compile = __compileOnLoad;
+    if (compile && !hashed && !hashStream(stream.get(), &sourceSize, &sourceHash))
+    {
+        GP_WARN("Failed to read file '%s'.", path);
+        return NULL;
+    }
+
+    Properties* properties = new Properties(stream.get());
+    properties->resolveInheritance();
+    stream->close();
+
+    if (compile)
+        writeCompiledFile(properties, compiledPath.c_str(), sourceSize, sourceHash);
+
+    return properties;
+}
+
+bool Properties::readCompiled(Stream* stream)
+{
+    GP_ASSERT(stream);
+
+    if (!readCompiledString(stream, &_namespace) ||
+        !readCompiledString(stream, &_id) ||
+        !readCompiledString(stream, &_parentID))
+        return false;
+
+    std::string name;
+    std::string value;
+    unsigned int count;
+    if (stream->read(&count, 4, 1) != 1)
+        return false;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!readCompiledString(stream, &name) || !readCompiledString(stream, &value))
+            return false;
+        addProperty(name.c_str(), value.c_str());
+    }
+
+    if (stream->read(&count, 4, 1) != 1)
+        return false;
+    if (count > 0)
+    {
+        _variables = new std::vector<Property>();
+        _variables->reserve(count);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (!readCompiledString(stream, &name) || !readCompiledString(stream, &value))
+                return false;
+            _variables->push_back(Property(name.c_str(), value.c_str()));
+        }
+    }
+
+    if (stream->read(&count, 4, 1) != 1)
+        return false;
+    _namespaces.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Properties* space = new Properties();
+        space->_parent = this;
+        _namespaces.push_back(space);
+        if (!space->readCompiled(stream))
+            return false;
+    }
+
+    rewind();
+    return true;
+}
+
+bool Properties::writeCompiled(Stream* stream) const
+{
+    GP_ASSERT(stream);
+
+    if (!writeCompiledString(stream, _namespace) ||
+        !writeCompiledString(stream, _id) ||
+        !writeCompiledString(stream, _parentID))
+        return false;
+
+    unsigned int count = (unsigned int)_properties.size();
+    if (stream->write(&count, 4, 1) != 1)
+        return false;
+    for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    {
+        if (!writeCompiledString(stream, itr->name) || !writeCompiledString(stream, itr->value))
+            return false;
+    }
+
+    count = _variables ? (unsigned int)_variables->size() : 0;
+    if (stream->write(&count, 4, 1) != 1)
+        return false;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const Property& variable = (*_variables)[i];
+        if (!writeCompiledString(stream, variable.name) || !writeCompiledString(stream, variable.value))
+            return false;
+    }
+
+    count = (unsigned int)_namespaces.size();
+    if (stream->write(&count, 4, 1) != 1)
+        return false;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!_namespaces[i]->writeCompiled(stream))
+            return false;
+    }
+
+    return true;
+}
+
+bool Properties::writeCompiledFile(const Properties* properties, const char* path, unsigned int sourceSize, unsigned int sourceHash)
+{
+    GP_ASSERT(properties);
+    GP_ASSERT(path);
+
+    // Write to a file of its own and move it into place, so that loads of the same file on other
+    // threads never see it partly written.
+    char suffix[16];
+    sprintf(suffix, ".%u.tmp", __compiledFileCount++);
+    std::string tempPath(path);
+    tempPath.append(suffix);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(tempPath.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to create compiled properties file '%s'.", path);
+        return false;
+    }
+
+    unsigned char version[2] = { PROPERTIES_COMPILED_VERSION_MAJOR, PROPERTIES_COMPILED_VERSION_MINOR };
+    unsigned int source[2] = { sourceSize, sourceHash };
+    bool result = stream->write(__compiledSignature, 1, 9) == 9 &&
+                  stream->write(version, 1, 2) == 2 &&
+                  stream->write(source, 4, 2) == 2 &&
+                  properties->writeCompiled(stream.get());
+    stream->close();
+    stream.reset();
+
+    if (result)
+        result = FileSystem::renameFile(tempPath.c_str(), path);
+    if (!result)
+    {
+        GP_WARN("Failed to write compiled properties file '%s'.", path);
+        FileSystem::removeFile(tempPath.c_str());
+    }
+    return result;
+}
+
 static bool isVariable(const char* str, char* outName, size_t outSize)
 {
     size_t len = strlen(str);
@@ -216,7 +527,7 @@ void Properties::readProperties(Stream* stream)
                 else
                 {
                     // Normal name/value pair
-                    _properties.push_back(Property(name, value));
+                    addProperty(name, value);
                 }
             }
             else
@@ -364,11 +675,11 @@ void Properties::readProperties(Stream* stream)
                             // Store "name value" as a name/value pair, or even just "name".
                             if (value != NULL)
                             {
-                                _properties.push_back(Property(name, value));
+                                addProperty(name, value);
                             }
                             else
                             {
-                                _properties.push_back(Property(name, ""));
+                                addProperty(name, "");
                             }
                         }
                     }
@@ -477,6 +788,7 @@ void Properties::resolveInheritance(const char* id)
 
                 // Copy data from the parent into the child.
                 derived->_properties = parent->_properties;
+                derived->rebuildPropertyIndex();
                 derived->_namespaces = std::vector<Properties*>();
                 std::vector<Properties*>::const_iterator itt;
                 for (itt = parent->_namespaces.begin(); itt < parent->_namespaces.end(); ++itt)
@@ -557,6 +869,44 @@ void Properties::mergeWith(Properties* overrides)
     }
 }
 
+void Properties::addProperty(const char* name, const char* value)
+{
+    _properties.push_back(Property(name, value));
+
+    // Only the first property with a given name is indexed, matching a search of the list in order.
+    Property* property = &_properties.back();
+    _propertyIndex.insert(std::make_pair(property->name.c_str(), property));
+}
+
+Properties::Property* Properties::findProperty(const char* name) const
+{
+    GP_ASSERT(name);
+
+    PropertyIndex::const_iterator itr = _propertyIndex.find(name);
+    return itr != _propertyIndex.end() ? itr->second : NULL;
+}
+
+void Properties::rebuildPropertyIndex()
+{
+    _propertyIndex.clear();
+    _propertyIndex.reserve(_properties.size());
+    for (std::list<Property>::iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    {
+        _propertyIndex.insert(std::make_pair(itr->name.c_str(), &(*itr)));
+    }
+}
+
+size_t Properties::PropertyNameHash::operator()(const char* name) const
+{
+    size_t hash = 2166136261u;
+    for (; *name; ++name)
+    {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 const char* Properties::getNextProperty()
 {
     if (_propertiesItr == _properties.end())
@@ -637,13 +987,7 @@ bool Properties::exists(const char* name) const
     if (name == NULL)
         return false;
 
-    for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
-    {
-        if (itr->name == name)
-            return true;
-    }
-
-    return false;
+    return findProperty(name) != NULL;
 }
 
 static const bool isStringNumeric(const char* str)
@@ -727,13 +1071,10 @@ const char* Properties::getString(const char* name, const char* defaultValue) co
             return getVariable(variable, defaultValue);
         }
 
-        for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+        Property* property = findProperty(name);
+        if (property)
         {
-            if (itr->name == name)
-            {
-                value = itr->value.c_str();
-                break;
-            }
+            value = property->value.c_str();
         }
     }
     else
@@ -761,18 +1102,16 @@ bool Properties::setString(const char* name, const char* value)
 {
     if (name)
     {
-        for (std::list<Property>::iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+        Property* property = findProperty(name);
+        if (property)
         {
-            if (itr->name == name)
-            {
-                // Update the first property that matches this name
-                itr->value = value ? value : "";
-                return true;
-            }
+            // Update the first property that matches this name
+            property->value = value ? value : "";
+            return true;
         }
 
         // There is no property with this name, so add one
-        _properties.push_back(Property(name, value ? value : ""));
+        addProperty(name, value ? value : "");
     }
     else
     {
@@ -1015,6 +1354,7 @@ Properties* Properties::clone()
     p->_parentID = _parentID;
     p->_properties = _properties;
     p->_propertiesItr = p->_properties.end();
+    p->rebuildPropertyIndex();
     p->setDirectoryPath(_dirPath);
 
     for (size_t i = 0, count = _namespaces.size(); i < count; i++)
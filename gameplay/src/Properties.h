@@ -155,6 +155,32 @@ public:
      */
     static Properties* create(const char* url);
 
+    /**
+     * Compiles the properties file at the specified path to the binary form used by create().
+     *
+     * The compiled file has the extension ".gpp" appended to the path of the text file and is
+     * loaded in its place by create(), skipping the text parsing and inheritance resolution.
+     * A compiled file records a hash of the text it was compiled from and is ignored when the
+     * text file is present and no longer matches it.
+     *
+     * @param path The path of the properties file to compile.
+     *
+     * @return True if the compiled file was written, false otherwise.
+     * @script{ignore}
+     */
+    static bool compile(const char* path);
+
+    /**
+     * Sets whether properties files are compiled the first time they are loaded by create().
+     *
+     * This is disabled by default, and can be enabled with 'compile' in the 'properties'
+     * namespace of the game config. Compiled files that already exist are used either way.
+     *
+     * @param enabled true to write compiled files when loading text properties files, false otherwise.
+     * @script{ignore}
+     */
+    static void setCompileOnLoad(bool enabled);
+
     /**
      * Destructor.
      */
@@ -518,6 +544,25 @@ private:
         Property(const char* name, const char* value) : name(name), value(value) { }
     };
 
+    /**
+     * Hash and equality functions for looking up properties by name without copying the name.
+     */
+    struct PropertyNameHash
+    {
+        size_t operator()(const char* name) const;
+    };
+
+    struct PropertyNameEqual
+    {
+        bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+    };
+
+    /**
+     * Maps property names to the first property in the namespace with that name.
+     * Keys point into the names of the properties, which are never modified once added.
+     */
+    typedef std::unordered_map<const char*, Property*, PropertyNameHash, PropertyNameEqual> PropertyIndex;
+
     /**
      * Constructor.
      */
@@ -555,11 +600,33 @@ private:
     // Called after create(); copies info from parents into derived namespaces.
     void resolveInheritance(const char* id = NULL);
 
+    // Appends a property to this namespace, keeping the property index up to date.
+    void addProperty(const char* name, const char* value);
+
+    // Finds the first property in this namespace with the given name.
+    Property* findProperty(const char* name) const;
+
+    // Rebuilds the property index after the list of properties was replaced.
+    void rebuildPropertyIndex();
+
+    // Loads a properties file, from its compiled form if there is an up to date one.
+    static Properties* loadFile(const char* path);
+
+    // Reads the namespace tree of a compiled properties file, returning false if it is malformed.
+    bool readCompiled(Stream* stream);
+
+    // Writes the namespace tree of this object in the compiled form, returning false if a write failed.
+    bool writeCompiled(Stream* stream) const;
+
+    // Writes the compiled form of a properties object loaded from text with the given size and hash.
+    static bool writeCompiledFile(const Properties* properties, const char* path, unsigned int sourceSize, unsigned int sourceHash);
+
     std::string _namespace;
     std::string _id;
     std::string _parentID;
     std::list<Property> _properties;
     std::list<Property>::iterator _propertiesItr;
+    PropertyIndex _propertyIndex;
     std::vector<Properties*> _namespaces;
     std::vector<Properties*>::const_iterator _namespacesItr;
     std::vector<Property>* _variables;
@@ -0,0 +1,326 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Model.h"
+#include "MeshPart.h"
+#include "Material.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Terrain.h"
+#include "Camera.h"
+#include "Node.h"
+
+// Sort key layout, from the most significant bit down:
+//   opaque items:      layer (1) | pass (3) | effect (12) | state (12) | material (12) | depth (24)
+//   transparent items: layer (1) | inverted depth (24) | pass (3) | effect (12) | state (12) | material (12)
+// Ids that do not fit in their field wrap around, which only makes the grouping less effective.
+#define RENDER_QUEUE_LAYER_TRANSPARENT (1ULL << 63)
+#define RENDER_QUEUE_PASS_BITS 3
+#define RENDER_QUEUE_ID_BITS 12
+#define RENDER_QUEUE_DEPTH_BITS 24
+
+// Below this many items a comparison sort is faster than the radix sort.
+#define RENDER_QUEUE_RADIX_SORT_THRESHOLD 64
+
+namespace gameplay
+{
+
+/**
+ * Converts a view depth to an unsigned integer that increases with the depth.
+ */
+static unsigned int getDepthBits(float depth)
+{
+    // The bit pattern of a positive float increases with its value. Items at or
+    // behind the camera are all given a depth of zero.
+    if (!(depth > 0.0f))
+        return 0;
+    unsigned int bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (31 - RENDER_QUEUE_DEPTH_BITS);
+}
+
+RenderQueue::RenderQueue()
+    : _sorted(true)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::add(Node* node, const Camera* camera)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(camera);
+
+    Drawable* drawable = node->getDrawable();
+    if (drawable == NULL)
+        return;
+
+    // Get the depth of the node along the view direction, which is down the negative z axis.
+    Vector3 center = node->getBoundingSphere().center;
+    camera->getViewMatrix().transformPoint(&center);
+    float depth = -center.z;
+
+    Model* model = dynamic_cast<Model*>(drawable);
+    if (model)
+        add(model, depth);
+    else
+        add(drawable, depth, dynamic_cast<Terrain*>(drawable) == NULL);
+}
+
+void RenderQueue::add(Model* model, float depth)
+{
+    GP_ASSERT(model);
+
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (index buffers).
+        Material* material = model->getMaterial();
+        if (material)
+        {
+            Technique* technique = material->getTechnique();
+            GP_ASSERT(technique);
+            for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+            {
+                addPass(model, NULL, technique->getPassByIndex(i), i, depth);
+            }
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            MeshPart* part = mesh->getPart(i);
+            GP_ASSERT(part);
+
+            Material* material = model->getMaterial(i);
+            if (material)
+            {
+                Technique* technique = material->getTechnique();
+                GP_ASSERT(technique);
+                for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+                {
+                    addPass(model, part, technique->getPassByIndex(j), j, depth);
+                }
+            }
+        }
+    }
+}
+
+void RenderQueue::add(Drawable* drawable, float depth, bool transparent)
+{
+    GP_ASSERT(drawable);
+
+    // Other drawables use effect, state and material id zero, so they are not grouped with models.
+    Item item = { drawable, NULL, NULL, NULL };
+    unsigned long long depthBits = getDepthBits(depth);
+    unsigned long long key;
+    if (transparent)
+        key = RENDER_QUEUE_LAYER_TRANSPARENT | (((~depthBits) & ((1ULL << RENDER_QUEUE_DEPTH_BITS) - 1)) << (RENDER_QUEUE_PASS_BITS + 3 * RENDER_QUEUE_ID_BITS));
+    else
+        key = depthBits;
+    addItem(item, key);
+}
+
+void RenderQueue::addPass(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, float depth)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(pass);
+    GP_ASSERT(pass->getEffect());
+
+    // The material is the root of the render state hierarchy of the pass.
+    RenderState* material = pass;
+    while (material->_parent)
+        material = material->_parent;
+
+    bool transparent;
+    unsigned long long stateHash = pass->getStateHash(&transparent);
+
+    const unsigned long long idMask = (1ULL << RENDER_QUEUE_ID_BITS) - 1;
+    unsigned long long ids =
+        ((getSortId(_effectIds, (unsigned long long)(size_t)pass->getEffect()) & idMask) << (2 * RENDER_QUEUE_ID_BITS)) |
+        ((getSortId(_stateIds, stateHash) & idMask) << RENDER_QUEUE_ID_BITS) |
+        (getSortId(_materialIds, (unsigned long long)(size_t)material) & idMask);
+    unsigned long long passBits = std::min(passIndex, (1u << RENDER_QUEUE_PASS_BITS) - 1);
+    unsigned long long depthBits = getDepthBits(depth);
+
+    unsigned long long key;
+    if (transparent)
+    {
+        // Back-to-front, keeping the passes of an item in order.
+        key = RENDER_QUEUE_LAYER_TRANSPARENT |
+              (((~depthBits) & ((1ULL << RENDER_QUEUE_DEPTH_BITS) - 1)) << (RENDER_QUEUE_PASS_BITS + 3 * RENDER_QUEUE_ID_BITS)) |
+              (passBits << (3 * RENDER_QUEUE_ID_BITS)) |
+              ids;
+    }
+    else
+    {
+        // Grouped by pass, effect, state and material, then front-to-back.
+        key = (passBits << (3 * RENDER_QUEUE_ID_BITS + RENDER_QUEUE_DEPTH_BITS)) |
+              (ids << RENDER_QUEUE_DEPTH_BITS) |
+              depthBits;
+    }
+
+    Item item = { model, model, part, pass };
+    addItem(item, key);
+}
+
+void RenderQueue::addItem(const Item& item, unsigned long long key)
+{
+    SortEntry entry = { key, (unsigned int)_items.size() };
+    _items.push_back(item);
+    _entries.push_back(entry);
+    _sorted = false;
+}
+
+unsigned int RenderQueue::getSortId(std::unordered_map<unsigned long long, unsigned int>& ids, unsigned long long value)
+{
+    // Ids start at one, since zero is used for drawables that are not models.
+    return ids.insert(std::make_pair(value, (unsigned int)ids.size() + 1)).first->second;
+}
+
+unsigned int RenderQueue::getItemCount() const
+{
+    return (unsigned int)_items.size();
+}
+
+void RenderQueue::sort()
+{
+    size_t count = _entries.size();
+    if (count < RENDER_QUEUE_RADIX_SORT_THRESHOLD)
+    {
+        std::stable_sort(_entries.begin(), _entries.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+        _sorted = true;
+        return;
+    }
+
+    // Least significant digit radix sort on bytes, computing the histograms of all digits in one pass.
+    unsigned int histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; ++i)
+    {
+        unsigned long long key = _entries[i].key;
+        for (unsigned int digit = 0; digit < 8; ++digit)
+        {
+            ++histograms[digit][(key >> (digit * 8)) & 0xFF];
+        }
+    }
+
+    _scratch.resize(count);
+    SortEntry* src = &_entries[0];
+    SortEntry* dst = &_scratch[0];
+    for (unsigned int digit = 0; digit < 8; ++digit)
+    {
+        unsigned int* histogram = histograms[digit];
+        unsigned int shift = digit * 8;
+
+        // Skip digits that are the same for every key, such as unused id bits.
+        if (histogram[(src[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            unsigned int bucketCount = histogram[i];
+            histogram[i] = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != &_entries[0])
+        _entries.swap(_scratch);
+
+    _sorted = true;
+}
+
+unsigned int RenderQueue::draw(bool wireframe)
+{
+    if (!_sorted)
+        sort();
+
+    unsigned int drawCalls = 0;
+    Effect* currentEffect = NULL;
+    VertexAttributeBinding* currentBinding = NULL;
+    IndexBufferHandle currentIndexBuffer = 0;
+    bool indexBufferBound = false;
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        const Item& item = _items[_entries[i].index];
+        if (item.pass == NULL)
+        {
+            // Other drawables bind their own state, so anything bound for models must be rebound after them.
+            if (currentBinding)
+            {
+                currentBinding->unbind();
+                currentBinding = NULL;
+            }
+            drawCalls += item.drawable->draw(wireframe);
+            currentEffect = NULL;
+            indexBufferBound = false;
+            continue;
+        }
+
+        Pass* pass = item.pass;
+        Effect* effect = pass->getEffect();
+        if (effect != currentEffect)
+        {
+            effect->bind();
+            currentEffect = effect;
+        }
+
+        // Material parameters are per item, and the renderer state is only changed where it differs.
+        static_cast<RenderState*>(pass)->bind(pass);
+
+        VertexAttributeBinding* binding = pass->getVertexAttributeBinding();
+        if (binding != currentBinding)
+        {
+            // Unbind first so that software bindings do not leave unused attribute arrays enabled.
+            if (currentBinding)
+                currentBinding->unbind();
+            if (binding)
+                binding->bind();
+            currentBinding = binding;
+
+            // The element array buffer is part of the vertex array state.
+            indexBufferBound = false;
+        }
+
+        IndexBufferHandle indexBuffer = item.part ? item.part->getIndexBuffer() : 0;
+        if (!indexBufferBound || indexBuffer != currentIndexBuffer)
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer) );
+            currentIndexBuffer = indexBuffer;
+            indexBufferBound = true;
+        }
+
+        item.model->drawPart(item.part, wireframe);
+        ++drawCalls;
+    }
+
+    if (currentBinding)
+        currentBinding->unbind();
+
+    return drawCalls;
+}
+
+void RenderQueue::clear()
+{
+    _items.clear();
+    _entries.clear();
+    _effectIds.clear();
+    _stateIds.clear();
+    _materialIds.clear();
+    _sorted = true;
+}
+
+}
@@ -0,0 +1,160 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+namespace gameplay
+{
+
+class Drawable;
+class Model;
+class MeshPart;
+class Pass;
+class Node;
+class Camera;
+
+/**
+ * Defines a queue of draw items that are sorted to minimize state changes before they are drawn.
+ *
+ * Models are split into one item per mesh part and technique pass. Every item is given a 64-bit
+ * sort key and the items are ordered with a radix sort. Opaque items are drawn first, grouped by
+ * effect and render state and then front-to-back within each group, to reduce program switches
+ * and overdraw. Transparent items, whose passes enable blending, are drawn last, back-to-front.
+ * Other drawables are queued as a single item each and are drawn with Drawable::draw.
+ *
+ * While drawing, programs and vertex attribute bindings are only bound when they differ from
+ * the previous item, rather than being bound and unbound for every mesh part.
+ *
+ * A queue is typically filled every frame by visiting the visible nodes of a scene, then drawn
+ * and cleared. The storage of the queue is kept between frames.
+ *
+ * @script{ignore}
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Adds the drawable of a node to the queue, using the distance of the center of its
+     * bounding sphere along the view direction of the camera as its depth.
+     *
+     * Models are drawn per mesh part and pass. Other drawables, except terrain, are drawn in
+     * the transparent layer since they are typically blended (sprites, text and particles).
+     *
+     * @param node The node to add.
+     * @param camera The camera the scene is drawn with.
+     */
+    void add(Node* node, const Camera* camera);
+
+    /**
+     * Adds every mesh part and pass of a model to the queue.
+     *
+     * @param model The model to add.
+     * @param depth The view depth of the model.
+     */
+    void add(Model* model, float depth);
+
+    /**
+     * Adds a drawable to the queue, to be drawn with Drawable::draw.
+     *
+     * @param drawable The drawable to add.
+     * @param depth The view depth of the drawable.
+     * @param transparent true to draw the drawable in the transparent layer, false to draw it in the opaque layer.
+     */
+    void add(Drawable* drawable, float depth, bool transparent);
+
+    /**
+     * Gets the number of items in the queue.
+     *
+     * @return The number of items.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Sorts the items of the queue.
+     *
+     * This is called by draw() if the queue was modified since it was last sorted.
+     */
+    void sort();
+
+    /**
+     * Draws the items of the queue in sorted order.
+     *
+     * @param wireframe true to draw the wireframe only.
+     *
+     * @return The number of graphics draw calls made.
+     */
+    unsigned int draw(bool wireframe = false);
+
+    /**
+     * Removes all of the items from the queue.
+     */
+    void clear();
+
+private:
+
+    /**
+     * An item to draw.
+     */
+    struct Item
+    {
+        Drawable* drawable;
+        Model* model;
+        MeshPart* part;
+        Pass* pass;
+    };
+
+    /**
+     * The sort key of an item, and the index of the item.
+     */
+    struct SortEntry
+    {
+        unsigned long long key;
+        unsigned int index;
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    /**
+     * Adds an item with the given key.
+     */
+    void addItem(const Item& item, unsigned long long key);
+
+    /**
+     * Adds an item for a pass of a model.
+     */
+    void addPass(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, float depth);
+
+    /**
+     * Gets a small id for a value, unique within the queue until it is cleared.
+     */
+    static unsigned int getSortId(std::unordered_map<unsigned long long, unsigned int>& ids, unsigned long long value);
+
+    std::vector<Item> _items;
+    std::vector<SortEntry> _entries;
+    std::vector<SortEntry> _scratch;
+    std::unordered_map<unsigned long long, unsigned int> _effectIds;
+    std::unordered_map<unsigned long long, unsigned int> _stateIds;
+    std::unordered_map<unsigned long long, unsigned int> _materialIds;
+    bool _sorted;
+};
+
+}
+
+#endif
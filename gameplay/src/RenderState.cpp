@@ -438,6 +438,47 @@ void RenderState::bind(Pass* pass)
     }
 }
 
+unsigned long long RenderState::getStateHash(bool* blendEnabled)
+{
+    GP_ASSERT(blendEnabled);
+
+    // Fold the state blocks of the hierarchy top-down, in the order bind() applies them.
+    unsigned long long hash = 14695981039346656037ULL;
+    *blendEnabled = false;
+    RenderState* rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
+        StateBlock* state = rs->_state;
+        if (state == NULL)
+            continue;
+
+        if (state->_bits & RS_BLEND)
+            *blendEnabled = state->_blendEnabled;
+
+        const unsigned long long values[] =
+        {
+            (unsigned long long)state->_bits,
+            (unsigned long long)state->_cullFaceEnabled | ((unsigned long long)state->_depthTestEnabled << 1) |
+            ((unsigned long long)state->_depthWriteEnabled << 2) | ((unsigned long long)state->_blendEnabled << 3) |
+            ((unsigned long long)state->_stencilTestEnabled << 4),
+            (unsigned long long)state->_depthFunction,
+            (unsigned long long)state->_blendSrc | ((unsigned long long)state->_blendDst << 32),
+            (unsigned long long)state->_cullFaceSide | ((unsigned long long)state->_frontFace << 32),
+            (unsigned long long)state->_stencilWrite | ((unsigned long long)state->_stencilFunction << 32),
+            (unsigned long long)(unsigned int)state->_stencilFunctionRef | ((unsigned long long)state->_stencilFunctionMask << 32),
+            (unsigned long long)state->_stencilOpSfail | ((unsigned long long)state->_stencilOpDpfail << 16) |
+            ((unsigned long long)state->_stencilOpDppass << 32)
+        };
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+        {
+            hash ^= values[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    return hash;
+}
+
 RenderState* RenderState::getTopmost(RenderState* below)
 {
     RenderState* rs = this;
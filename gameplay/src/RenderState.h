@@ -23,6 +23,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
 
 public:
 
@@ -607,6 +608,16 @@ protected:
      */
     void bind(Pass* pass);
 
+    /**
+     * Computes a hash of the renderer state applied by bind() for this RenderState and any of
+     * its parents, so that passes with the same renderer state can be drawn together.
+     *
+     * @param blendEnabled Set to whether the renderer state enables blending.
+     *
+     * @return The hash of the renderer state.
+     */
+    unsigned long long getStateHash(bool* blendEnabled);
+
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
      */
@@ -6,6 +6,7 @@
 #include "Joint.h"
 #include "Terrain.h"
 #include "Bundle.h"
+#include "Game.h"
 
 namespace gameplay
 {
@@ -61,7 +62,7 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 Scene::Scene()
     : _id(""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true), 
-      _nextItr(NULL), _nextReset(true)
+      _nextItr(NULL), _nextReset(true), _flatTransforms(false), _flatTransformsDirty(true), _spatialIndex(NULL)
 {
     __sceneList.push_back(this);
 }
@@ -82,6 +83,7 @@ Scene::~Scene()
 
     // Remove all nodes from the scene
     removeAllNodes();
+    SAFE_DELETE(_spatialIndex);
 
     // Remove the scene from global list
     std::vector<Scene*>::iterator itr = std::find(__sceneList.begin(), __sceneList.end(), this);
@@ -273,6 +275,9 @@ void Scene::addNode(Node* node)
 
     ++_nodeCount;
 
+    transformHierarchyChanged();
+    addToSpatialIndex(node);
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -306,6 +311,8 @@ void Scene::removeNode(Node* node)
     SAFE_RELEASE(node);
 
     --_nodeCount;
+
+    transformHierarchyChanged();
 }
 
 void Scene::removeAllNodes()
@@ -388,6 +395,10 @@ void Scene::setAmbientColor(float red, float green, float blue)
 
 void Scene::update(float elapsedTime)
 {
+    // Resolve the transforms changed since the last frame (i.e. by animations) before updating components.
+    if (_flatTransforms)
+        updateTransforms();
+
     for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
     {
         if (node->isEnabled())
@@ -395,6 +406,210 @@ void Scene::update(float elapsedTime)
     }
 }
 
+void Scene::parallelVisitRoots(const std::function<void(Node*)>& visitor)
+{
+    if (_nodeCount == 0)
+        return;
+
+    std::vector<Node*> roots;
+    roots.reserve(_nodeCount);
+    for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+    {
+        roots.push_back(node);
+    }
+
+    JobScheduler* scheduler = Game::getInstance()->getJobScheduler();
+    if (scheduler == NULL)
+    {
+        for (size_t i = 0, count = roots.size(); i < count; ++i)
+            visitor(roots[i]);
+        return;
+    }
+
+    // Hand out several batches of subtrees per thread so that uneven subtrees still balance out.
+    unsigned int count = (unsigned int)roots.size();
+    unsigned int grainSize = std::max(1u, count / ((scheduler->getWorkerCount() + 1) * 8));
+    scheduler->parallelFor(count, [&roots, &visitor](unsigned int i)
+    {
+        visitor(roots[i]);
+    }, grainSize);
+}
+
+void Scene::setFlatTransformsEnabled(bool enabled)
+{
+    _flatTransforms = enabled;
+    if (!enabled)
+    {
+        _transformNodes.clear();
+        _flatTransformsDirty = true;
+    }
+}
+
+bool Scene::isFlatTransformsEnabled() const
+{
+    return _flatTransforms;
+}
+
+void Scene::transformHierarchyChanged()
+{
+    _flatTransformsDirty = true;
+}
+
+void Scene::buildTransformHierarchy()
+{
+    _transformNodes.clear();
+    _transformNodes.reserve(_nodeCount);
+
+    // Flatten the hierarchy in pre-order so that every parent is stored before its children.
+    std::vector<Node*> stack;
+    for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+    {
+        stack.push_back(node);
+        while (!stack.empty())
+        {
+            Node* n = stack.back();
+            stack.pop_back();
+            _transformNodes.push_back(n);
+
+            // Push children in reverse so they are emitted in sibling order.
+            Node* child = n->_firstChild;
+            if (child)
+            {
+                while (child->_nextSibling)
+                    child = child->_nextSibling;
+                for (; child != NULL; child = child->_prevSibling)
+                {
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+    _flatTransformsDirty = false;
+}
+
+void Scene::updateTransforms()
+{
+    if (_flatTransformsDirty)
+        buildTransformHierarchy();
+
+    // Parents always precede their children in the array, so each parent world
+    // matrix is resolved by the time its children are visited.
+    for (size_t i = 0, count = _transformNodes.size(); i < count; ++i)
+    {
+        _transformNodes[i]->resolveWorldMatrix();
+    }
+}
+
+SpatialIndex* Scene::getSpatialIndex()
+{
+    if (_spatialIndex == NULL)
+    {
+        _spatialIndex = new SpatialIndex();
+        for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+        {
+            addToSpatialIndex(node);
+        }
+        return _spatialIndex;
+    }
+
+    // Proxies of nodes that were removed may have been reused by other nodes, which are
+    // only updated if they are queued themselves.
+    for (size_t i = 0, count = _spatialIndexChanges.size(); i < count; ++i)
+    {
+        int proxy = _spatialIndexChanges[i];
+        Node* node = _spatialIndex->getNode(proxy);
+        if (node && node->_spatialIndexProxy == proxy && node->_spatialIndexDirty)
+        {
+            node->_spatialIndexDirty = false;
+            _spatialIndex->update(proxy);
+        }
+    }
+    _spatialIndexChanges.clear();
+
+    return _spatialIndex;
+}
+
+void Scene::addToSpatialIndex(Node* node)
+{
+    if (_spatialIndex == NULL)
+        return;
+
+    if ((node->_drawable || node->_light) && node->_spatialIndexProxy < 0)
+        node->_spatialIndexProxy = _spatialIndex->add(node);
+
+    for (Node* child = node->_firstChild; child != NULL; child = child->_nextSibling)
+    {
+        addToSpatialIndex(child);
+    }
+}
+
+void Scene::removeFromSpatialIndex(Node* node)
+{
+    if (_spatialIndex == NULL)
+        return;
+
+    if (node->_spatialIndexProxy >= 0)
+    {
+        _spatialIndex->remove(node->_spatialIndexProxy);
+        node->_spatialIndexProxy = -1;
+        node->_spatialIndexDirty = false;
+    }
+
+    for (Node* child = node->_firstChild; child != NULL; child = child->_nextSibling)
+    {
+        removeFromSpatialIndex(child);
+    }
+}
+
+void Scene::updateSpatialIndex(Node* node)
+{
+    if (_spatialIndex == NULL)
+        return;
+
+    bool indexed = node->_drawable || node->_light;
+    if (indexed && node->_spatialIndexProxy < 0)
+    {
+        node->_spatialIndexProxy = _spatialIndex->add(node);
+    }
+    else if (!indexed && node->_spatialIndexProxy >= 0)
+    {
+        _spatialIndex->remove(node->_spatialIndexProxy);
+        node->_spatialIndexProxy = -1;
+        node->_spatialIndexDirty = false;
+    }
+}
+
+void Scene::spatialIndexChanged(Node* node)
+{
+    // Nodes may be moved from visitors running on several threads.
+    std::lock_guard<std::mutex> lock(_spatialIndexMutex);
+    if (!node->_spatialIndexDirty)
+    {
+        node->_spatialIndexDirty = true;
+        _spatialIndexChanges.push_back(node->_spatialIndexProxy);
+    }
+}
+
+unsigned int Scene::findNodes(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    return getSpatialIndex()->findNodes(frustum, nodes);
+}
+
+unsigned int Scene::findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    return getSpatialIndex()->findNodes(sphere, nodes);
+}
+
+unsigned int Scene::findNodes(const BoundingBox& box, std::vector<Node*>& nodes)
+{
+    return getSpatialIndex()->findNodes(box, nodes);
+}
+
+Node* Scene::pickNode(const Ray& ray, float* distance)
+{
+    return getSpatialIndex()->pickNode(ray, distance);
+}
+
 void Scene::reset()
 {
     _nextItr = NULL;
@@ -6,6 +6,7 @@
 #include "ScriptController.h"
 #include "Light.h"
 #include "Model.h"
+#include "SpatialIndex.h"
 
 namespace gameplay
 {
@@ -17,6 +18,8 @@ namespace gameplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+
 public:
 
     /**
@@ -90,6 +93,57 @@ public:
      */
     unsigned int findNodes(const char* id, std::vector<Node*>& nodes, bool recursive = true, bool exactMatch = true) const;
 
+    /**
+     * Finds the enabled nodes in the scene whose bounding spheres intersect the given frustum.
+     *
+     * Nodes that have a drawable or a light are kept in a spatial index, which is built on
+     * the first query and then updated incrementally as nodes move, so the cost of a query
+     * depends on the number of nodes found rather than the number of nodes in the scene.
+     * Nodes are tested with Node::getBoundingSphere().
+     *
+     * @param frustum The frustum to test against, such as the frustum of a camera.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     * @script{ignore}
+     */
+    unsigned int findNodes(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the enabled nodes in the scene whose bounding spheres intersect the given sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     * @see findNodes(const Frustum&, std::vector<Node*>&)
+     * @script{ignore}
+     */
+    unsigned int findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the enabled nodes in the scene whose bounding spheres intersect the given box.
+     *
+     * @param box The box to test against.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     * @see findNodes(const Frustum&, std::vector<Node*>&)
+     * @script{ignore}
+     */
+    unsigned int findNodes(const BoundingBox& box, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the nearest enabled node in the scene whose bounding sphere is intersected by the given ray.
+     *
+     * @param ray The ray to test, such as a ray picked from a camera.
+     * @param distance Set to the distance along the ray to the bounding sphere of the node, if not NULL.
+     *
+     * @return The node found, or NULL if the ray does not intersect any node.
+     * @see findNodes(const Frustum&, std::vector<Node*>&)
+     */
+    Node* pickNode(const Ray& ray, float* distance = NULL);
+
     /**
      * Creates and adds a new node to the scene.
      *
@@ -188,6 +242,37 @@ public:
      */
     void update(float elapsedTime);
 
+    /**
+     * Enables or disables the flat world transform update pass for this scene.
+     *
+     * When enabled, the scene keeps its node hierarchy flattened into a contiguous array
+     * in topological (parent before child) order and resolves all dirty world matrices
+     * in a single linear pass from update(float), instead of resolving them lazily and
+     * recursively through Node::getWorldMatrix(). This is useful for scenes with a large
+     * number of animated nodes. Disabled by default.
+     *
+     * @param enabled true to enable the flat transform pass, false to disable it.
+     */
+    void setFlatTransformsEnabled(bool enabled);
+
+    /**
+     * Determines if the flat world transform update pass is enabled for this scene.
+     *
+     * @return true if the flat transform pass is enabled, false otherwise.
+     *
+     * @see setFlatTransformsEnabled(bool)
+     */
+    bool isFlatTransformsEnabled() const;
+
+    /**
+     * Resolves the world matrices of all nodes in the scene with dirty transforms.
+     *
+     * This is called automatically from update(float) when flat transforms are enabled,
+     * but may also be called directly after modifying transforms outside of the update.
+     * Node::getWorldMatrix() remains valid regardless of whether this is called.
+     */
+    void updateTransforms();
+
     /**
      * Visits each node in the scene and calls the specified method pointer.
      *
@@ -228,6 +313,41 @@ public:
     template <class T, class C>
     void visit(T* instance, bool (T::*visitMethod)(Node*,C), C cookie);
 
+    /**
+     * Visits each node in the scene in parallel and calls the specified method pointer.
+     *
+     * This behaves like visit(T*, bool (T::*)(Node*)), except that the top-level nodes
+     * of the scene are distributed across the worker threads of the Game's JobScheduler.
+     * Each top-level subtree is still traversed depth-first by a single thread, but the
+     * order in which different subtrees are visited is undefined.
+     *
+     * This is intended for read-only passes such as culling, gathering bounds or building
+     * draw lists. The visit method is called concurrently, so it must be thread safe and
+     * must not modify the scene hierarchy. Methods that return shared static storage
+     * (such as Node::getWorldViewMatrix()) must not be used from the visit method, and
+     * world transforms should be resolved beforehand (see updateTransforms()).
+     *
+     * @param instance The pointer to an instance of the object that contains visitMethod.
+     * @param visitMethod The pointer to the class method to call for each node in the scene.
+     * @script{ignore}
+     */
+    template <class T>
+    void parallelVisit(T* instance, bool (T::*visitMethod)(Node*));
+
+    /**
+     * Visits each node in the scene in parallel and calls the specified method pointer,
+     * passing the Node and the specified cookie value.
+     *
+     * @param instance The pointer to an instance of the object that contains visitMethod.
+     * @param visitMethod The pointer to the class method to call for each node in the scene.
+     * @param cookie A user-defined parameter that will be passed to each invocation of visitMethod.
+     *
+     * @see parallelVisit(T*, bool (T::*)(Node*))
+     * @script{ignore}
+     */
+    template <class T, class C>
+    void parallelVisit(T* instance, bool (T::*visitMethod)(Node*,C), C cookie);
+
     /**
      * Visits each node in the scene and calls the specified Lua function.
      *
@@ -295,6 +415,46 @@ private:
      */
     void visitNode(Node* node, const char* visitMethod);
 
+    /**
+     * Calls the visitor for every top-level node of the scene using the game's job scheduler.
+     */
+    void parallelVisitRoots(const std::function<void(Node*)>& visitor);
+
+    /**
+     * Flags the flattened transform hierarchy for rebuilding.
+     */
+    void transformHierarchyChanged();
+
+    /**
+     * Rebuilds the flattened transform hierarchy from the scene graph.
+     */
+    void buildTransformHierarchy();
+
+    /**
+     * Gets the spatial index of the scene, building it or applying the pending node changes to it.
+     */
+    SpatialIndex* getSpatialIndex();
+
+    /**
+     * Adds the nodes of a subtree that have a drawable or a light to the spatial index, if it has been built.
+     */
+    void addToSpatialIndex(Node* node);
+
+    /**
+     * Removes the nodes of a subtree from the spatial index.
+     */
+    void removeFromSpatialIndex(Node* node);
+
+    /**
+     * Adds or removes a node from the spatial index after its drawable or light has changed.
+     */
+    void updateSpatialIndex(Node* node);
+
+    /**
+     * Queues an indexed node to have its bounds updated before the next query.
+     */
+    void spatialIndexChanged(Node* node);
+
     Node* findNextVisibleSibling(Node* node);
 
     bool isNodeVisible(Node* node);
@@ -308,6 +468,12 @@ private:
     bool _bindAudioListenerToCamera;
     Node* _nextItr;
     bool _nextReset;
+    bool _flatTransforms;
+    bool _flatTransformsDirty;
+    std::vector<Node*> _transformNodes;
+    SpatialIndex* _spatialIndex;
+    std::vector<int> _spatialIndexChanges;
+    std::mutex _spatialIndexMutex;
 };
 
 template <class T>
@@ -328,6 +494,24 @@ void Scene::visit(T* instance, bool (T::*visitMethod)(Node*,C), C cookie)
     }
 }
 
+template <class T>
+void Scene::parallelVisit(T* instance, bool (T::*visitMethod)(Node*))
+{
+    parallelVisitRoots([this, instance, visitMethod](Node* node)
+    {
+        visitNode(node, instance, visitMethod);
+    });
+}
+
+template <class T, class C>
+void Scene::parallelVisit(T* instance, bool (T::*visitMethod)(Node*,C), C cookie)
+{
+    parallelVisitRoots([this, instance, visitMethod, cookie](Node* node)
+    {
+        visitNode(node, instance, visitMethod, cookie);
+    });
+}
+
 inline void Scene::visit(const char* visitMethod)
 {
     for (Node* node = getFirstNode(); node != NULL; node = node->getNextSibling())
@@ -17,17 +17,32 @@ namespace gameplay
 extern void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath);
 extern Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
-SceneLoader::SceneLoader() : _scene(NULL)
+SceneLoader::SceneLoader() : _sceneFile(NULL), _sceneProperties(NULL), _scene(NULL)
 {
 }
 
+SceneLoader::~SceneLoader()
+{
+    // Clean up all loaded properties objects.
+    std::map<std::string, Properties*>::iterator iter = _propertiesFromFile.begin();
+    for (; iter != _propertiesFromFile.end(); ++iter)
+    {
+        SAFE_DELETE(iter->second);
+    }
+
+    // Clean up the .scene file's properties object.
+    SAFE_DELETE(_sceneFile);
+}
+
 Scene* SceneLoader::load(const char* url)
 {
     SceneLoader loader;
-    return loader.loadInternal(url);
+    if (!loader.prepare(url))
+        return NULL;
+    return loader.build();
 }
 
-Scene* SceneLoader::loadInternal(const char* url)
+bool SceneLoader::prepare(const char* url)
 {
     // Get the file part of the url that we are loading the scene from.
     std::string urlStr = url ? url : "";
@@ -35,32 +50,38 @@ Scene* SceneLoader::loadInternal(const char* url)
     splitURL(urlStr, &_path, &id);
 
     // Load the scene properties from file.
-    Properties* properties = Properties::create(url);
-    if (properties == NULL)
+    _sceneFile = Properties::create(url);
+    if (_sceneFile == NULL)
     {
         GP_ERROR("Failed to load scene file '%s'.", url);
-        return NULL;
+        return false;
     }
 
     // Check if the properties object is valid and has a valid namespace.
-    Properties* sceneProperties = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
-    if (!sceneProperties || !(strcmp(sceneProperties->getNamespace(), "scene") == 0))
+    _sceneProperties = (strlen(_sceneFile->getNamespace()) > 0) ? _sceneFile : _sceneFile->getNextNamespace();
+    if (!_sceneProperties || !(strcmp(_sceneProperties->getNamespace(), "scene") == 0))
     {
         GP_ERROR("Failed to load scene from properties object: must be non-null object and have namespace equal to 'scene'.");
-        SAFE_DELETE(properties);
-        return NULL;
+        return false;
     }
 
     // Get the path to the main GPB.
     std::string path;
-    if (sceneProperties->getPath("path", &path))
+    if (_sceneProperties->getPath("path", &path))
     {
         _gpbPath = path;
     }
 
     // Build the node URL/property and animation reference tables and load the referenced files/store the inline properties objects.
-    buildReferenceTables(sceneProperties);
+    buildReferenceTables(_sceneProperties);
     loadReferencedFiles();
+    return true;
+}
+
+Scene* SceneLoader::build()
+{
+    Properties* sceneProperties = _sceneProperties;
+    GP_ASSERT(sceneProperties);
 
     // Load the main scene data from GPB and apply the global scene properties.
     if (!_gpbPath.empty())
@@ -70,7 +91,6 @@ Scene* SceneLoader::loadInternal(const char* url)
         if (!_scene)
         {
             GP_WARN("Failed to load main scene from bundle.");
-            SAFE_DELETE(properties);
             return NULL;
         }
     }
@@ -143,16 +163,6 @@ Scene* SceneLoader::loadInternal(const char* url)
     if (physics)
         loadPhysics(physics);
 
-    // Clean up all loaded properties objects.
-    std::map<std::string, Properties*>::iterator iter = _propertiesFromFile.begin();
-    for (; iter != _propertiesFromFile.end(); ++iter)
-    {
-        SAFE_DELETE(iter->second);
-    }
-
-    // Clean up the .scene file's properties object.
-    SAFE_DELETE(properties);
-
     return _scene;
 }
 
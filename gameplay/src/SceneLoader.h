@@ -18,6 +18,7 @@ namespace gameplay
 class SceneLoader
 {
     friend class Scene;
+    friend class AssetLoader;
 
 private:
 
@@ -88,7 +89,25 @@ private:
 
     SceneLoader();
 
-    Scene* loadInternal(const char* url);
+    ~SceneLoader();
+
+    /**
+     * Reads the scene file and the properties files it references. This does not create any
+     * objects of the scene, so it may run on a worker thread.
+     *
+     * @param url The URL pointing to the Properties object defining the scene.
+     *
+     * @return true if the scene file was read, false otherwise.
+     */
+    bool prepare(const char* url);
+
+    /**
+     * Builds the scene from the prepared scene file, which loads its bundle and creates its
+     * objects. Must run on the main thread.
+     *
+     * @return The scene, or NULL if it failed to load.
+     */
+    Scene* build();
 
     void applyTags(SceneNode& sceneNode);
 
@@ -134,6 +153,8 @@ private:
     std::vector<SceneNode> _sceneNodes;                     // Holds all the nodes+properties declared in the .scene file.
     std::string _gpbPath;                                   // The path of the main GPB for the scene being loaded.
     std::string _path;                                      // The path of the scene file being loaded.
+    Properties* _sceneFile;                                 // The properties of the scene file being loaded.
+    Properties* _sceneProperties;                           // The 'scene' namespace of the scene file.
     Scene* _scene;                                          // The scene being loaded
 };
 
@@ -0,0 +1,511 @@
+#include "Base.h"
+#include "SpatialIndex.h"
+#include "Node.h"
+
+#define SPATIAL_INDEX_NULL -1
+
+// Leaf boxes are enlarged by this fraction of the radius of their node, so small movements do not reinsert the node.
+#define SPATIAL_INDEX_MARGIN 0.1f
+
+namespace gameplay
+{
+
+static float getSurfaceArea(const BoundingBox& box)
+{
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void combine(const BoundingBox& a, const BoundingBox& b, BoundingBox* dst)
+{
+    dst->min.set(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+    dst->max.set(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+}
+
+static bool contains(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+static void getBounds(const BoundingSphere& sphere, float margin, BoundingBox* box)
+{
+    float radius = sphere.radius * (1.0f + margin);
+    box->min.set(sphere.center.x - radius, sphere.center.y - radius, sphere.center.z - radius);
+    box->max.set(sphere.center.x + radius, sphere.center.y + radius, sphere.center.z + radius);
+}
+
+SpatialIndex::SpatialIndex()
+    : _root(SPATIAL_INDEX_NULL), _freeList(SPATIAL_INDEX_NULL), _nodeCount(0)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+unsigned int SpatialIndex::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+unsigned int SpatialIndex::getHeight() const
+{
+    return _root == SPATIAL_INDEX_NULL ? 0 : (unsigned int)_entries[_root].height;
+}
+
+int SpatialIndex::allocateEntry()
+{
+    int index;
+    if (_freeList == SPATIAL_INDEX_NULL)
+    {
+        index = (int)_entries.size();
+        _entries.push_back(Entry());
+    }
+    else
+    {
+        index = _freeList;
+        _freeList = _entries[index].parent;
+    }
+
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.parent = SPATIAL_INDEX_NULL;
+    entry.child1 = SPATIAL_INDEX_NULL;
+    entry.child2 = SPATIAL_INDEX_NULL;
+    entry.height = 0;
+    return index;
+}
+
+void SpatialIndex::freeEntry(int index)
+{
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.parent = _freeList;
+    entry.height = -1;
+    _freeList = index;
+}
+
+Node* SpatialIndex::getNode(int proxy) const
+{
+    if (proxy < 0 || proxy >= (int)_entries.size())
+        return NULL;
+    return _entries[proxy].node;
+}
+
+int SpatialIndex::add(Node* node)
+{
+    GP_ASSERT(node);
+
+    int proxy = allocateEntry();
+    _entries[proxy].node = node;
+    getBounds(node->getBoundingSphere(), SPATIAL_INDEX_MARGIN, &_entries[proxy].box);
+    insertLeaf(proxy);
+    ++_nodeCount;
+
+    return proxy;
+}
+
+void SpatialIndex::remove(int proxy)
+{
+    GP_ASSERT(getNode(proxy));
+
+    removeLeaf(proxy);
+    freeEntry(proxy);
+    --_nodeCount;
+}
+
+void SpatialIndex::update(int proxy)
+{
+    GP_ASSERT(getNode(proxy));
+
+    const BoundingSphere& sphere = _entries[proxy].node->getBoundingSphere();
+    BoundingBox box;
+    getBounds(sphere, 0.0f, &box);
+    if (contains(_entries[proxy].box, box))
+        return;
+
+    removeLeaf(proxy);
+    getBounds(sphere, SPATIAL_INDEX_MARGIN, &_entries[proxy].box);
+    insertLeaf(proxy);
+}
+
+void SpatialIndex::insertLeaf(int leaf)
+{
+    if (_root == SPATIAL_INDEX_NULL)
+    {
+        _root = leaf;
+        _entries[leaf].parent = SPATIAL_INDEX_NULL;
+        return;
+    }
+
+    // Find the sibling for the leaf that adds the least surface area to the tree. Descending
+    // into a branch costs the area it gains, which is paid by all of the entries above it.
+    BoundingBox leafBox = _entries[leaf].box;
+    BoundingBox combined;
+    int index = _root;
+    while (_entries[index].child1 != SPATIAL_INDEX_NULL)
+    {
+        const Entry& entry = _entries[index];
+        float area = getSurfaceArea(entry.box);
+        combine(entry.box, leafBox, &combined);
+        float combinedArea = getSurfaceArea(combined);
+
+        // Cost of making a new parent for this entry and the leaf.
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree.
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        const int children[2] = { entry.child1, entry.child2 };
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            const Entry& child = _entries[children[i]];
+            combine(child.box, leafBox, &combined);
+            if (child.child1 == SPATIAL_INDEX_NULL)
+                childCosts[i] = getSurfaceArea(combined) + inheritanceCost;
+            else
+                childCosts[i] = getSurfaceArea(combined) - getSurfaceArea(child.box) + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    // Create a new parent for the sibling and the leaf.
+    int sibling = index;
+    int oldParent = _entries[sibling].parent;
+    int newParent = allocateEntry();
+    Entry& parent = _entries[newParent];
+    parent.parent = oldParent;
+    combine(leafBox, _entries[sibling].box, &parent.box);
+    parent.height = _entries[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    _entries[sibling].parent = newParent;
+    _entries[leaf].parent = newParent;
+
+    if (oldParent == SPATIAL_INDEX_NULL)
+    {
+        _root = newParent;
+    }
+    else if (_entries[oldParent].child1 == sibling)
+    {
+        _entries[oldParent].child1 = newParent;
+    }
+    else
+    {
+        _entries[oldParent].child2 = newParent;
+    }
+
+    refit(newParent);
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = SPATIAL_INDEX_NULL;
+        return;
+    }
+
+    // Replace the parent of the leaf with the sibling of the leaf.
+    int parent = _entries[leaf].parent;
+    int grandParent = _entries[parent].parent;
+    int sibling = _entries[parent].child1 == leaf ? _entries[parent].child2 : _entries[parent].child1;
+    freeEntry(parent);
+
+    _entries[sibling].parent = grandParent;
+    if (grandParent == SPATIAL_INDEX_NULL)
+    {
+        _root = sibling;
+    }
+    else
+    {
+        if (_entries[grandParent].child1 == parent)
+            _entries[grandParent].child1 = sibling;
+        else
+            _entries[grandParent].child2 = sibling;
+        refit(grandParent);
+    }
+}
+
+void SpatialIndex::refit(int index)
+{
+    while (index != SPATIAL_INDEX_NULL)
+    {
+        index = balance(index);
+
+        Entry& entry = _entries[index];
+        const Entry& child1 = _entries[entry.child1];
+        const Entry& child2 = _entries[entry.child2];
+        entry.height = 1 + std::max(child1.height, child2.height);
+        combine(child1.box, child2.box, &entry.box);
+
+        index = entry.parent;
+    }
+}
+
+int SpatialIndex::balance(int iA)
+{
+    Entry* a = &_entries[iA];
+    if (a->child1 == SPATIAL_INDEX_NULL || a->height < 2)
+        return iA;
+
+    int iB = a->child1;
+    int iC = a->child2;
+    Entry* b = &_entries[iB];
+    Entry* c = &_entries[iC];
+    int difference = c->height - b->height;
+
+    if (difference > 1)
+    {
+        // Rotate C up, moving A below it.
+        int iF = c->child1;
+        int iG = c->child2;
+        Entry* f = &_entries[iF];
+        Entry* g = &_entries[iG];
+
+        c->child1 = iA;
+        c->parent = a->parent;
+        a->parent = iC;
+        if (c->parent == SPATIAL_INDEX_NULL)
+            _root = iC;
+        else if (_entries[c->parent].child1 == iA)
+            _entries[c->parent].child1 = iC;
+        else
+            _entries[c->parent].child2 = iC;
+
+        // Keep the taller grandchild below C and give the other one to A.
+        if (f->height > g->height)
+        {
+            c->child2 = iF;
+            a->child2 = iG;
+            g->parent = iA;
+            combine(b->box, g->box, &a->box);
+            combine(a->box, f->box, &c->box);
+            a->height = 1 + std::max(b->height, g->height);
+            c->height = 1 + std::max(a->height, f->height);
+        }
+        else
+        {
+            c->child2 = iG;
+            a->child2 = iF;
+            f->parent = iA;
+            combine(b->box, f->box, &a->box);
+            combine(a->box, g->box, &c->box);
+            a->height = 1 + std::max(b->height, f->height);
+            c->height = 1 + std::max(a->height, g->height);
+        }
+        return iC;
+    }
+
+    if (difference < -1)
+    {
+        // Rotate B up, moving A below it.
+        int iD = b->child1;
+        int iE = b->child2;
+        Entry* d = &_entries[iD];
+        Entry* e = &_entries[iE];
+
+        b->child1 = iA;
+        b->parent = a->parent;
+        a->parent = iB;
+        if (b->parent == SPATIAL_INDEX_NULL)
+            _root = iB;
+        else if (_entries[b->parent].child1 == iA)
+            _entries[b->parent].child1 = iB;
+        else
+            _entries[b->parent].child2 = iB;
+
+        if (d->height > e->height)
+        {
+            b->child2 = iD;
+            a->child1 = iE;
+            e->parent = iA;
+            combine(c->box, e->box, &a->box);
+            combine(a->box, d->box, &b->box);
+            a->height = 1 + std::max(c->height, e->height);
+            b->height = 1 + std::max(a->height, d->height);
+        }
+        else
+        {
+            b->child2 = iE;
+            a->child1 = iD;
+            d->parent = iA;
+            combine(c->box, d->box, &a->box);
+            combine(a->box, e->box, &b->box);
+            a->height = 1 + std::max(c->height, d->height);
+            b->height = 1 + std::max(a->height, e->height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void SpatialIndex::addLeaves(int index, std::vector<Node*>& nodes) const
+{
+    std::vector<int> stack;
+    stack.push_back(index);
+    while (!stack.empty())
+    {
+        const Entry& entry = _entries[stack.back()];
+        stack.pop_back();
+        if (entry.child1 == SPATIAL_INDEX_NULL)
+        {
+            if (entry.node->isEnabledInHierarchy())
+                nodes.push_back(entry.node);
+        }
+        else
+        {
+            stack.push_back(entry.child1);
+            stack.push_back(entry.child2);
+        }
+    }
+}
+
+unsigned int SpatialIndex::findNodes(const Frustum& frustum, std::vector<Node*>& nodes) const
+{
+    if (_root == SPATIAL_INDEX_NULL)
+        return 0;
+
+    // Each branch is only tested against the planes its parent intersects, and branches
+    // that are in front of all of the planes are added without any further tests.
+    size_t start = nodes.size();
+    std::vector<std::pair<int, unsigned int> > stack;
+    stack.push_back(std::make_pair(_root, 0x3Fu));
+    while (!stack.empty())
+    {
+        int index = stack.back().first;
+        unsigned int planeMask = stack.back().second;
+        stack.pop_back();
+
+        const Entry& entry = _entries[index];
+        if (!frustum.intersects(entry.box, &planeMask))
+            continue;
+
+        if (planeMask == 0)
+        {
+            addLeaves(index, nodes);
+        }
+        else if (entry.child1 == SPATIAL_INDEX_NULL)
+        {
+            if (entry.node->isEnabledInHierarchy() && entry.node->getBoundingSphere().intersects(frustum))
+                nodes.push_back(entry.node);
+        }
+        else
+        {
+            stack.push_back(std::make_pair(entry.child1, planeMask));
+            stack.push_back(std::make_pair(entry.child2, planeMask));
+        }
+    }
+    return (unsigned int)(nodes.size() - start);
+}
+
+unsigned int SpatialIndex::findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes) const
+{
+    if (_root == SPATIAL_INDEX_NULL)
+        return 0;
+
+    size_t start = nodes.size();
+    std::vector<int> stack;
+    stack.push_back(_root);
+    while (!stack.empty())
+    {
+        const Entry& entry = _entries[stack.back()];
+        stack.pop_back();
+        if (!sphere.intersects(entry.box))
+            continue;
+
+        if (entry.child1 == SPATIAL_INDEX_NULL)
+        {
+            if (entry.node->isEnabledInHierarchy() && entry.node->getBoundingSphere().intersects(sphere))
+                nodes.push_back(entry.node);
+        }
+        else
+        {
+            stack.push_back(entry.child1);
+            stack.push_back(entry.child2);
+        }
+    }
+    return (unsigned int)(nodes.size() - start);
+}
+
+unsigned int SpatialIndex::findNodes(const BoundingBox& box, std::vector<Node*>& nodes) const
+{
+    if (_root == SPATIAL_INDEX_NULL)
+        return 0;
+
+    size_t start = nodes.size();
+    std::vector<int> stack;
+    stack.push_back(_root);
+    while (!stack.empty())
+    {
+        const Entry& entry = _entries[stack.back()];
+        stack.pop_back();
+        if (!box.intersects(entry.box))
+            continue;
+
+        if (entry.child1 == SPATIAL_INDEX_NULL)
+        {
+            if (entry.node->isEnabledInHierarchy() && entry.node->getBoundingSphere().intersects(box))
+                nodes.push_back(entry.node);
+        }
+        else
+        {
+            stack.push_back(entry.child1);
+            stack.push_back(entry.child2);
+        }
+    }
+    return (unsigned int)(nodes.size() - start);
+}
+
+Node* SpatialIndex::pickNode(const Ray& ray, float* distance) const
+{
+    if (_root == SPATIAL_INDEX_NULL)
+        return NULL;
+
+    Node* nearest = NULL;
+    float nearestDistance = FLT_MAX;
+    std::vector<int> stack;
+    stack.push_back(_root);
+    while (!stack.empty())
+    {
+        const Entry& entry = _entries[stack.back()];
+        stack.pop_back();
+
+        // Skip branches that are hit no closer than the nearest node found so far.
+        float d = entry.box.intersects(ray);
+        if (d == Ray::INTERSECTS_NONE || d >= nearestDistance)
+            continue;
+
+        if (entry.child1 == SPATIAL_INDEX_NULL)
+        {
+            if (!entry.node->isEnabledInHierarchy())
+                continue;
+            d = entry.node->getBoundingSphere().intersects(ray);
+            if (d != Ray::INTERSECTS_NONE && d < nearestDistance)
+            {
+                nearest = entry.node;
+                nearestDistance = d;
+            }
+        }
+        else
+        {
+            stack.push_back(entry.child1);
+            stack.push_back(entry.child2);
+        }
+    }
+
+    if (nearest && distance)
+        *distance = nearestDistance;
+    return nearest;
+}
+
+}
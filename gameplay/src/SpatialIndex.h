@@ -0,0 +1,187 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+class Node;
+
+/**
+ * Defines a dynamic bounding volume hierarchy of scene nodes.
+ *
+ * Every node is stored in a leaf with an axis-aligned box that is slightly larger than
+ * its bounding sphere, so that nodes that move by small amounts do not need to be
+ * reinserted. Leaves are inserted next to the sibling that least increases the surface
+ * area of the tree, and the tree is kept balanced with rotations, so queries only visit
+ * the branches that overlap the query volume.
+ *
+ * The index is owned and kept up to date by a Scene, which queues the nodes whose bounds
+ * have changed and updates their leaves before each query.
+ *
+ * @see Scene::findNodes(const Frustum&, std::vector<Node*>&)
+ * @script{ignore}
+ */
+class SpatialIndex
+{
+    friend class Scene;
+
+public:
+
+    /**
+     * Gets the number of nodes in the index.
+     *
+     * @return The node count.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Gets the height of the tree, which is zero for an empty or single node tree.
+     *
+     * @return The height of the tree.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Finds the enabled nodes whose bounding spheres intersect the given frustum.
+     *
+     * Branches that are entirely inside the frustum are added without testing their nodes.
+     *
+     * @param frustum The frustum to test against.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const Frustum& frustum, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the enabled nodes whose bounding spheres intersect the given sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the enabled nodes whose bounding spheres intersect the given box.
+     *
+     * @param box The box to test against.
+     * @param nodes The vector the nodes found are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const BoundingBox& box, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the nearest enabled node whose bounding sphere is intersected by the given ray.
+     *
+     * @param ray The ray to test.
+     * @param distance Set to the distance along the ray to the bounding sphere of the node, if not NULL.
+     *
+     * @return The node found, or NULL if the ray does not intersect any node.
+     */
+    Node* pickNode(const Ray& ray, float* distance = NULL) const;
+
+private:
+
+    /**
+     * An entry of the tree, which is either a leaf holding a node or a branch with two children.
+     */
+    struct Entry
+    {
+        BoundingBox box;
+        Node* node;
+        // The parent of the entry, or the next free entry if the entry is not used.
+        int parent;
+        int child1;
+        int child2;
+        // The height of the entry above the leaves, or -1 if the entry is not used.
+        int height;
+    };
+
+    /**
+     * Constructor.
+     */
+    SpatialIndex();
+
+    /**
+     * Destructor.
+     */
+    ~SpatialIndex();
+
+    /**
+     * Hidden copy constructor.
+     */
+    SpatialIndex(const SpatialIndex& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    SpatialIndex& operator=(const SpatialIndex&);
+
+    /**
+     * Adds a node to the index with its current bounds.
+     *
+     * @param node The node to add.
+     *
+     * @return The proxy of the node in the index.
+     */
+    int add(Node* node);
+
+    /**
+     * Removes a node from the index.
+     *
+     * @param proxy The proxy of the node returned from add.
+     */
+    void remove(int proxy);
+
+    /**
+     * Updates the bounds of a node, reinserting it if it has moved outside of its leaf box.
+     *
+     * @param proxy The proxy of the node returned from add.
+     */
+    void update(int proxy);
+
+    /**
+     * Gets the node of a proxy, or NULL if the proxy is not a leaf.
+     */
+    Node* getNode(int proxy) const;
+
+    int allocateEntry();
+
+    void freeEntry(int index);
+
+    void insertLeaf(int leaf);
+
+    void removeLeaf(int leaf);
+
+    /**
+     * Recomputes the boxes and heights of an entry and its ancestors, balancing them on the way up.
+     */
+    void refit(int index);
+
+    /**
+     * Rotates the taller child of an entry up if the entry is unbalanced, and returns the root of the subtree.
+     */
+    int balance(int index);
+
+    /**
+     * Appends the enabled nodes of all of the leaves below an entry.
+     */
+    void addLeaves(int index, std::vector<Node*>& nodes) const;
+
+    std::vector<Entry> _entries;
+    int _root;
+    int _freeList;
+    unsigned int _nodeCount;
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "SpriteBatch.h"
 #include "Game.h"
 #include "Material.h"
+#include "TextureAtlas.h"
 
 // Default size of a newly created sprite batch
 #define SPRITE_BATCH_DEFAULT_SIZE 128
@@ -9,10 +10,10 @@
 // Factor to grow a sprite batch by when its size is exceeded
 #define SPRITE_BATCH_GROW_FACTOR 2.0f
 
-// Macro for adding a sprite to the batch
+// Macro for adding a sprite to the batch, mapping its texture coordinates to the atlas page of the batch
 #define SPRITE_ADD_VERTEX(vtx, vx, vy, vz, vu, vv, vr, vg, vb, va) \
     vtx.x = vx; vtx.y = vy; vtx.z = vz; \
-    vtx.u = vu; vtx.v = vv; \
+    vtx.u = _uvOffset.x + (vu) * _uvScale.x; vtx.v = _uvOffset.y + (vv) * _uvScale.y; \
     vtx.r = vr; vtx.g = vg; vtx.b = vb; vtx.a = va
 
 // Default sprite shaders
@@ -25,14 +26,21 @@ namespace gameplay
 static Effect* __spriteEffect = NULL;
 
 SpriteBatch::SpriteBatch()
-    : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
+    : _batch(NULL), _sampler(NULL), _customEffect(false), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f),
+    _atlas(NULL), _atlasBatch(NULL), _uvScale(Vector2::one()), _uvOffset(Vector2::zero())
 {
 }
 
 SpriteBatch::~SpriteBatch()
 {
-    SAFE_DELETE(_batch);
     SAFE_RELEASE(_sampler);
+    if (_atlas)
+    {
+        // The mesh batch and effect belong to the batch of the atlas page.
+        SAFE_RELEASE(_atlas);
+        return;
+    }
+    SAFE_DELETE(_batch);
     if (!_customEffect)
     {
         if (__spriteEffect && __spriteEffect->getRefCount() == 1)
@@ -142,6 +150,9 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
 
 void SpriteBatch::start()
 {
+    // Keep the sprites of the other batches of an atlas page that has already been started.
+    if (_atlasBatch && _batch->isStarted())
+        return;
     _batch->start();
 }
 
@@ -402,11 +413,17 @@ Material* SpriteBatch::getMaterial() const
 
 void SpriteBatch::setProjectionMatrix(const Matrix& matrix)
 {
-    _projectionMatrix = matrix;
+    // The material of an atlas page is bound to the projection of the batch of the page.
+    if (_atlasBatch)
+        _atlasBatch->setProjectionMatrix(matrix);
+    else
+        _projectionMatrix = matrix;
 }
 
 const Matrix& SpriteBatch::getProjectionMatrix() const
 {
+    if (_atlasBatch)
+        return _atlasBatch->getProjectionMatrix();
     return _projectionMatrix;
 }
 
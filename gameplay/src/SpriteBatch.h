@@ -12,6 +12,8 @@
 namespace gameplay
 {
 
+class TextureAtlas;
+
 /**
  * Defines a class for drawing groups of sprites.
  *
@@ -21,12 +23,20 @@ namespace gameplay
  * implicit sorting to minimize state changes. Therefore, it is highly
  * recommended to combine multiple small textures into larger texture atlases
  * where possible when drawing sprites.
+ *
+ * Sprite batches created by a TextureAtlas draw into the shared batch of the
+ * atlas page that holds their image, with texture coordinates relative to the
+ * image, which are mapped to the page as sprites are added. Such batches share
+ * their sprites, material and sampler with the other batches of their page, and
+ * starting a batch whose page has already been started keeps the sprites added
+ * by the other batches, so that all of them are drawn with a single draw call.
  */
 class SpriteBatch
 {
     friend class Bundle;
     friend class Font;
     friend class Text;
+    friend class TextureAtlas;
 
 public:
 
@@ -408,6 +418,10 @@ private:
     float _textureWidthRatio;
     float _textureHeightRatio;
     mutable Matrix _projectionMatrix;
+    TextureAtlas* _atlas;
+    SpriteBatch* _atlasBatch;
+    Vector2 _uvScale;
+    Vector2 _uvOffset;
 };
 
 }
@@ -155,6 +155,22 @@ public:
      */
     virtual bool rewind() = 0;
 
+    /**
+     * Borrows a pointer to the next <code>size</code> bytes of the stream without copying them,
+     * and advances the position of the stream past them.
+     *
+     * Only streams that are backed by memory, such as memory mapped files, support borrowing.
+     * The returned pointer remains valid until the stream is closed or destroyed, and must not
+     * be written to. If borrowing is not supported, or there are fewer than <code>size</code>
+     * bytes remaining, NULL is returned and the position of the stream is unchanged, in which
+     * case the data should be read with read() instead.
+     *
+     * @param size The number of bytes to borrow.
+     *
+     * @return A pointer to the data, or NULL if the data cannot be borrowed.
+     */
+    virtual const void* borrow(size_t size) { return NULL; }
+
 protected:
     Stream() {};
 private:
@@ -104,6 +104,43 @@ static bool isWhitespace(char c)
     }
 }
 
+static unsigned int findNextCharacter(const std::string& text, unsigned int from, bool backwards)
+{
+    // Step over a whole UTF-8 sequence, whose following bytes are 10xxxxxx.
+    int pos = (int)from;
+    const int len = (int)text.length();
+    do
+    {
+        pos += backwards ? -1 : 1;
+    } while (pos > 0 && pos < len && (text[pos] & 0xC0) == 0x80);
+    return (unsigned int)MATH_CLAMP(pos, 0, len);
+}
+
+static unsigned int toDisplayedIndex(const std::string& text, unsigned int offset, bool password)
+{
+    // Password text displays one character per code point, so count the
+    // lead bytes before the byte offset.
+    if (!password)
+        return offset;
+    unsigned int index = 0;
+    for (unsigned int i = 0; i < offset && i < text.length(); ++i)
+    {
+        if ((text[i] & 0xC0) != 0x80)
+            ++index;
+    }
+    return index;
+}
+
+static unsigned int fromDisplayedIndex(const std::string& text, unsigned int index, bool password)
+{
+    if (!password)
+        return index;
+    unsigned int offset = 0;
+    for (; index > 0 && offset < text.length(); --index)
+        offset = findNextCharacter(text, offset, false);
+    return offset;
+}
+
 static unsigned int findNextWord(const std::string& text, unsigned int from, bool backwards)
 {
     int pos = (int)from;
@@ -137,6 +174,13 @@ static unsigned int findNextWord(const std::string& text, unsigned int from, boo
     return (unsigned int)pos;
 }
 
+static unsigned int findNextDisplayedWord(const std::string& text, const std::string& displayedText, unsigned int from, bool backwards, bool password)
+{
+    // Word boundaries come from the displayed text; map the caret into it and back.
+    unsigned int index = findNextWord(displayedText, toDisplayedIndex(text, from, password), backwards);
+    return fromDisplayedIndex(text, index, password);
+}
+
 bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
 {
     switch (evt)
@@ -172,11 +216,11 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                         int newCaretLocation;
                         if (_ctrlPressed)
                         {
-                            newCaretLocation = findNextWord(getDisplayedText(), _caretLocation, false);
+                            newCaretLocation = findNextDisplayedWord(_text, getDisplayedText(), _caretLocation, false, _inputMode == PASSWORD);
                         }
                         else
                         {
-                            newCaretLocation = _caretLocation + 1;
+                            newCaretLocation = findNextCharacter(_text, _caretLocation, false);
                         }
                         _text.erase(_caretLocation, newCaretLocation - _caretLocation);
                         notifyListeners(Control::Listener::TEXT_CHANGED);
@@ -194,11 +238,11 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     {
                         if (_ctrlPressed)
                         {
-                            _caretLocation = findNextWord(getDisplayedText(), _caretLocation, true);
+                            _caretLocation = findNextDisplayedWord(_text, getDisplayedText(), _caretLocation, true, _inputMode == PASSWORD);
                         }
                         else
                         {
-                            --_caretLocation;
+                            _caretLocation = findNextCharacter(_text, _caretLocation, true);
                         }
                     }
                     break;
@@ -209,11 +253,11 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     {
                         if (_ctrlPressed)
                         {
-                            _caretLocation = findNextWord(getDisplayedText(), _caretLocation, false);
+                            _caretLocation = findNextDisplayedWord(_text, getDisplayedText(), _caretLocation, false, _inputMode == PASSWORD);
                         }
                         else
                         {
-                            ++_caretLocation;
+                            _caretLocation = findNextCharacter(_text, _caretLocation, false);
                         }
                     }
                     break;
@@ -235,11 +279,11 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                         int newCaretLocation;
                         if (_ctrlPressed)
                         {
-                            newCaretLocation = findNextWord(getDisplayedText(), _caretLocation, true);
+                            newCaretLocation = findNextDisplayedWord(_text, getDisplayedText(), _caretLocation, true, _inputMode == PASSWORD);
                         }
                         else
                         {
-                            newCaretLocation = _caretLocation - 1;
+                            newCaretLocation = findNextCharacter(_text, _caretLocation, true);
                         }
                         _text.erase(newCaretLocation, _caretLocation - newCaretLocation);
                         _caretLocation = newCaretLocation;
@@ -269,7 +313,7 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                 default:
                 {
                     // Insert character into string, only if our font supports this character
-                    if (_shiftPressed && islower(key))
+                    if (_shiftPressed && key < 128 && islower(key))
                     {
                         key = toupper(key);
                     }
@@ -278,8 +322,10 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     {
                         if (_caretLocation <= _text.length())
                         {
-                            _text.insert(_caretLocation, 1, (char)key);
-                            ++_caretLocation;
+                            char utf8[4];
+                            unsigned int length = Font::encodeUTF8((unsigned int)key, utf8);
+                            _text.insert(_caretLocation, utf8, length);
+                            _caretLocation += length;
                         }
 
                         notifyListeners(Control::Listener::TEXT_CHANGED);
@@ -357,7 +403,7 @@ unsigned int TextBox::drawImages(Form* form, const Rectangle& clip)
             Font* font = getFont(state);
             unsigned int fontSize = getFontSize(state);
             Vector2 point;
-            font->getLocationAtIndex(getDisplayedText().c_str(), _textBounds, fontSize, &point, _caretLocation, 
+            font->getLocationAtIndex(getDisplayedText().c_str(), _textBounds, fontSize, &point, toDisplayedIndex(_text, _caretLocation, _inputMode == PASSWORD), 
                  getTextAlignment(state), true, getTextRightToLeft(state));
 
             SpriteBatch* batch = _style->getTheme()->getSpriteBatch();
@@ -430,7 +476,7 @@ void TextBox::setCaretLocation(int x, int y)
         if (point.x > textBounds.x + textBounds.width &&
             point.y > textBounds.y + textBounds.height)
         {
-            font->getLocationAtIndex(displayedText.c_str(), _textBounds, fontSize, &point, (unsigned int)_text.length(),
+            font->getLocationAtIndex(displayedText.c_str(), _textBounds, fontSize, &point, (unsigned int)displayedText.length(),
                 textAlignment, true, rightToLeft);
             return;
         }
@@ -462,7 +508,7 @@ void TextBox::setCaretLocation(int x, int y)
 
     if (index != -1)
     {
-        _caretLocation = index;
+        _caretLocation = fromDisplayedIndex(_text, (unsigned int)index, _inputMode == PASSWORD);
     }
     else
     {
@@ -475,7 +521,7 @@ void TextBox::getCaretLocation(Vector2* p)
     GP_ASSERT(p);
 
     State state = getState();
-    getFont(state)->getLocationAtIndex(getDisplayedText().c_str(), _textBounds, getFontSize(state), p, _caretLocation, getTextAlignment(state), true, getTextRightToLeft(state));
+    getFont(state)->getLocationAtIndex(getDisplayedText().c_str(), _textBounds, getFontSize(state), p, toDisplayedIndex(_text, _caretLocation, _inputMode == PASSWORD), getTextAlignment(state), true, getTextRightToLeft(state));
 }
 
 void TextBox::setPasswordChar(char character)
@@ -527,7 +573,7 @@ std::string TextBox::getDisplayedText() const
     std::string displayedText;
     switch (_inputMode) {
         case PASSWORD:
-            displayedText.insert((size_t)0, _text.length(), _passwordChar);
+            displayedText.insert((size_t)0, toDisplayedIndex(_text, (unsigned int)_text.length(), true), _passwordChar);
             break;
 
         case TEXT:
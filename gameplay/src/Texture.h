@@ -15,6 +15,7 @@ class Image;
 class Texture : public Ref
 {
     friend class Sampler;
+    friend class AssetLoader;
 
 public:
 
@@ -241,6 +242,17 @@ public:
      */
     void setData(const unsigned char* data);
 
+    /**
+     * Replaces a region of a 2D texture image, regenerating the mipmaps of mipmapped textures.
+     *
+     * @param x The left edge of the region in pixels.
+     * @param y The bottom edge of the region in pixels.
+     * @param width The width of the region in pixels.
+     * @param height The height of the region in pixels.
+     * @param data Raw texture data for the region, in the format of the texture (expected to be tightly packed).
+     */
+    void setData(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* data);
+
     /**
      * Returns the path that the texture was originally loaded from (if applicable).
      *
@@ -322,6 +334,24 @@ private:
      */
     Texture& operator=(const Texture&);
 
+    /**
+     * Finds a texture loaded from the given path in the texture cache.
+     *
+     * @param path The path the texture was loaded from.
+     * @param generateMipmaps true to generate the mipmap chain of the cached texture if it has none.
+     *
+     * @return The cached texture with its reference count incremented, or NULL if it is not cached.
+     */
+    static Texture* findCached(const char* path, bool generateMipmaps);
+
+    /**
+     * Adds a texture loaded from the given path to the texture cache.
+     *
+     * @param texture The texture to cache.
+     * @param path The path the texture was loaded from.
+     */
+    static void addToCache(Texture* texture, const char* path);
+
     static Texture* createCompressedPVRTC(const char* path);
 
     static Texture* createCompressedDDS(const char* path);
@@ -0,0 +1,332 @@
+#include "Base.h"
+#include "TextureAtlas.h"
+#include "SpriteBatch.h"
+#include "Image.h"
+#include "Game.h"
+
+// Default size of the pages of the default atlas
+#define TEXTURE_ATLAS_DEFAULT_PAGE_SIZE 1024
+
+// Number of edge pixels repeated around each image
+#define TEXTURE_ATLAS_PADDING 2
+
+namespace gameplay
+{
+
+static TextureAtlas* __defaultAtlas = NULL;
+static bool __defaultAtlasCreated = false;
+
+TextureAtlas::TextureAtlas(unsigned int pageSize, unsigned int maxImageSize)
+    : _pageSize(pageSize), _maxImageSize(std::min(maxImageSize, pageSize - 2 * TEXTURE_ATLAS_PADDING))
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_pages[i]->batch);
+        SAFE_RELEASE(_pages[i]->texture);
+        SAFE_DELETE(_pages[i]);
+    }
+}
+
+TextureAtlas* TextureAtlas::getDefault()
+{
+    if (!__defaultAtlasCreated)
+    {
+        __defaultAtlasCreated = true;
+
+        // Check game.config for the page size of the default atlas, where zero disables atlasing.
+        unsigned int pageSize = TEXTURE_ATLAS_DEFAULT_PAGE_SIZE;
+        Properties* config = Game::getInstance()->getConfig()->getNamespace("ui", true);
+        if (config && config->exists("atlasPageSize"))
+            pageSize = (unsigned int)std::max(config->getInt("atlasPageSize"), 0);
+
+        if (pageSize > 2 * TEXTURE_ATLAS_PADDING)
+            __defaultAtlas = create(pageSize, pageSize / 2);
+    }
+
+    return __defaultAtlas;
+}
+
+void TextureAtlas::finalize()
+{
+    SAFE_RELEASE(__defaultAtlas);
+    __defaultAtlasCreated = false;
+}
+
+TextureAtlas* TextureAtlas::create(unsigned int pageSize, unsigned int maxImageSize)
+{
+    GP_ASSERT(pageSize > 2 * TEXTURE_ATLAS_PADDING);
+
+    return new TextureAtlas(pageSize, maxImageSize);
+}
+
+unsigned int TextureAtlas::getPageSize() const
+{
+    return _pageSize;
+}
+
+unsigned int TextureAtlas::getPageCount() const
+{
+    return (unsigned int)_pages.size();
+}
+
+Texture* TextureAtlas::getPage(unsigned int index) const
+{
+    GP_ASSERT(index < _pages.size());
+    return _pages[index]->texture;
+}
+
+SpriteBatch* TextureAtlas::createSpriteBatch(const char* path, unsigned int* width, unsigned int* height)
+{
+    GP_ASSERT(path);
+
+    std::map<std::string, Region>::const_iterator itr = _regions.find(path);
+    if (itr == _regions.end())
+    {
+        // Only uncompressed images can be copied into a page.
+        const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+        if (ext == NULL || strlen(ext) != 4 || tolower(ext[1]) != 'p' || tolower(ext[2]) != 'n' || tolower(ext[3]) != 'g')
+            return NULL;
+
+        Image* image = Image::create(path);
+        if (image == NULL)
+            return NULL;
+
+        SpriteBatch* batch = createSpriteBatch(path, image->getFormat() == Image::RGBA ? Texture::RGBA : Texture::RGB,
+            image->getWidth(), image->getHeight(), image->getData());
+        if (batch)
+        {
+            if (width)
+                *width = image->getWidth();
+            if (height)
+                *height = image->getHeight();
+        }
+        SAFE_RELEASE(image);
+        return batch;
+    }
+
+    if (width)
+        *width = itr->second.width;
+    if (height)
+        *height = itr->second.height;
+    return createSpriteBatch(itr->second);
+}
+
+SpriteBatch* TextureAtlas::createSpriteBatch(const char* id, Texture::Format format, unsigned int width, unsigned int height, const unsigned char* data)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(data);
+
+    std::map<std::string, Region>::const_iterator itr = _regions.find(id);
+    if (itr != _regions.end())
+        return createSpriteBatch(itr->second);
+
+    unsigned int bpp;
+    switch (format)
+    {
+    case Texture::RGBA:
+        bpp = 4;
+        break;
+    case Texture::RGB:
+        bpp = 3;
+        break;
+    case Texture::ALPHA:
+        bpp = 1;
+        break;
+    default:
+        return NULL;
+    }
+    if (width == 0 || height == 0 || width > _maxImageSize || height > _maxImageSize)
+        return NULL;
+
+    Region region;
+    unsigned int blockWidth = width + 2 * TEXTURE_ATLAS_PADDING;
+    unsigned int blockHeight = height + 2 * TEXTURE_ATLAS_PADDING;
+    if (!pack(blockWidth, blockHeight, &region.page, &region.x, &region.y))
+        return NULL;
+
+    // Convert the image to RGBA, repeating its edge pixels over the border of the block.
+    std::vector<unsigned char> block(blockWidth * blockHeight * 4);
+    unsigned char* dst = &block[0];
+    for (unsigned int by = 0; by < blockHeight; ++by)
+    {
+        unsigned int sy = (unsigned int)MATH_CLAMP((int)by - TEXTURE_ATLAS_PADDING, 0, (int)height - 1);
+        for (unsigned int bx = 0; bx < blockWidth; ++bx, dst += 4)
+        {
+            unsigned int sx = (unsigned int)MATH_CLAMP((int)bx - TEXTURE_ATLAS_PADDING, 0, (int)width - 1);
+            const unsigned char* src = data + (sy * width + sx) * bpp;
+            switch (format)
+            {
+            case Texture::RGBA:
+                dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = src[3];
+                break;
+            case Texture::RGB:
+                dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255;
+                break;
+            default:
+                dst[0] = 255; dst[1] = 255; dst[2] = 255; dst[3] = src[0];
+                break;
+            }
+        }
+    }
+    _pages[region.page]->texture->setData(region.x, region.y, blockWidth, blockHeight, &block[0]);
+
+    region.x += TEXTURE_ATLAS_PADDING;
+    region.y += TEXTURE_ATLAS_PADDING;
+    region.width = width;
+    region.height = height;
+    _regions[id] = region;
+
+    return createSpriteBatch(region);
+}
+
+SpriteBatch* TextureAtlas::createSpriteBatch(const Region& region)
+{
+    Page* page = _pages[region.page];
+    GP_ASSERT(page->batch);
+
+    SpriteBatch* batch = new SpriteBatch();
+    batch->_batch = page->batch->_batch;
+    batch->_sampler = page->batch->_sampler;
+    batch->_sampler->addRef();
+    batch->_customEffect = page->batch->_customEffect;
+    batch->_atlas = this;
+    addRef();
+    batch->_atlasBatch = page->batch;
+
+    // Texture coordinates are relative to the image, and are mapped to its region of the page.
+    float pageScale = 1.0f / (float)_pageSize;
+    batch->_textureWidthRatio = 1.0f / (float)region.width;
+    batch->_textureHeightRatio = 1.0f / (float)region.height;
+    batch->_uvScale.set(region.width * pageScale, region.height * pageScale);
+    batch->_uvOffset.set(region.x * pageScale, region.y * pageScale);
+
+    return batch;
+}
+
+TextureAtlas::Page* TextureAtlas::createPage()
+{
+    // Clear the page so that mipmaps do not filter in uninitialized memory around the images.
+    std::vector<unsigned char> data(_pageSize * _pageSize * 4, 0);
+    Texture* texture = Texture::create(Texture::RGBA, _pageSize, _pageSize, &data[0], true);
+    if (texture == NULL)
+        return NULL;
+
+    SpriteBatch* batch = SpriteBatch::create(texture);
+    if (batch == NULL)
+    {
+        SAFE_RELEASE(texture);
+        return NULL;
+    }
+    batch->getSampler()->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+    batch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+
+    Page* page = new Page();
+    page->texture = texture;
+    page->batch = batch;
+    SkylineNode node = { 0, 0, _pageSize };
+    page->skyline.push_back(node);
+    _pages.push_back(page);
+
+    return page;
+}
+
+bool TextureAtlas::pack(unsigned int width, unsigned int height, unsigned int* page, unsigned int* x, unsigned int* y)
+{
+    size_t node;
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        if (findPosition(_pages[i], width, height, x, y, &node))
+        {
+            addSkylineLevel(_pages[i], node, *x, *y, width, height);
+            *page = (unsigned int)i;
+            return true;
+        }
+    }
+
+    Page* newPage = createPage();
+    if (newPage == NULL || !findPosition(newPage, width, height, x, y, &node))
+        return false;
+    addSkylineLevel(newPage, node, *x, *y, width, height);
+    *page = (unsigned int)_pages.size() - 1;
+    return true;
+}
+
+bool TextureAtlas::findPosition(const Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y, size_t* node) const
+{
+    // Place the block as low as possible, preferring the narrowest segment to leave less space under it.
+    const std::vector<SkylineNode>& skyline = page->skyline;
+    unsigned int bestTop = UINT_MAX;
+    unsigned int bestWidth = UINT_MAX;
+    for (size_t i = 0, count = skyline.size(); i < count; ++i)
+    {
+        if (skyline[i].x + width > _pageSize)
+            break;
+
+        // The block rests on the highest of the segments it spans.
+        unsigned int top = skyline[i].y;
+        unsigned int widthLeft = width;
+        for (size_t j = i; widthLeft > 0; ++j)
+        {
+            GP_ASSERT(j < count);
+            top = std::max(top, skyline[j].y);
+            widthLeft -= std::min(widthLeft, skyline[j].width);
+        }
+        if (top + height > _pageSize)
+            continue;
+
+        if (top + height < bestTop || (top + height == bestTop && skyline[i].width < bestWidth))
+        {
+            bestTop = top + height;
+            bestWidth = skyline[i].width;
+            *x = skyline[i].x;
+            *y = top;
+            *node = i;
+        }
+    }
+    return bestTop != UINT_MAX;
+}
+
+void TextureAtlas::addSkylineLevel(Page* page, size_t node, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    std::vector<SkylineNode>& skyline = page->skyline;
+    SkylineNode level = { x, y + height, width };
+    skyline.insert(skyline.begin() + node, level);
+
+    // Remove the parts of the following segments that are now under the block.
+    for (size_t i = node + 1; i < skyline.size(); )
+    {
+        unsigned int previousRight = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= previousRight)
+            break;
+
+        unsigned int shrink = previousRight - skyline[i].x;
+        if (skyline[i].width <= shrink)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        break;
+    }
+
+    // Merge neighbouring segments at the same height.
+    for (size_t i = 0; i + 1 < skyline.size(); )
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+}
@@ -0,0 +1,195 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include "Ref.h"
+#include "Texture.h"
+
+namespace gameplay
+{
+
+class SpriteBatch;
+
+/**
+ * Defines a set of texture pages that small images are packed into at runtime.
+ *
+ * Each image added to the atlas is copied into a free region of a page, surrounded by a
+ * border of its edge pixels so that filtering does not sample its neighbours, and is
+ * drawn with a SpriteBatch that maps the texture coordinates of the image to its region.
+ * The sprite batches of all images on a page share a single batch, so that content from
+ * several images, such as the themes and fonts of a form, is drawn with one draw call.
+ *
+ * Pages are RGBA textures with mipmaps. Images with an alpha format are stored as white
+ * with their alpha, which draws the same as the font shader with the sprite shader.
+ *
+ * The default atlas is used by themes and bitmap fonts. Its page size is set in the 'ui'
+ * section of the game config, where a size of zero disables atlasing:
+ *
+ * @code
+ * ui
+ * {
+ *     atlasPageSize = 2048
+ * }
+ * @endcode
+ *
+ * @script{ignore}
+ */
+class TextureAtlas : public Ref
+{
+public:
+
+    /**
+     * Gets the default atlas, which is created on first use.
+     *
+     * @return The default atlas, or NULL if atlasing is disabled in the game config.
+     */
+    static TextureAtlas* getDefault();
+
+    /**
+     * Releases the default atlas when the game shuts down.
+     */
+    static void finalize();
+
+    /**
+     * Creates a new atlas.
+     *
+     * @param pageSize The width and height of the pages in pixels.
+     * @param maxImageSize The largest width or height of the images that are packed.
+     *
+     * @return The new atlas.
+     */
+    static TextureAtlas* create(unsigned int pageSize, unsigned int maxImageSize);
+
+    /**
+     * Creates a sprite batch that draws a PNG image from the atlas, packing the image
+     * into a page the first time it is used.
+     *
+     * @param path The path of the image, which also identifies it in the atlas.
+     * @param width Set to the width of the image in pixels, if not NULL.
+     * @param height Set to the height of the image in pixels, if not NULL.
+     *
+     * @return The new sprite batch, or NULL if the image is not a PNG or does not fit in a page.
+     */
+    SpriteBatch* createSpriteBatch(const char* path, unsigned int* width = NULL, unsigned int* height = NULL);
+
+    /**
+     * Creates a sprite batch that draws an image from the atlas, packing the image into a
+     * page the first time it is used.
+     *
+     * @param id The identifier of the image in the atlas.
+     * @param format The format of the image, which must be RGB, RGBA or ALPHA.
+     * @param width The width of the image in pixels.
+     * @param height The height of the image in pixels.
+     * @param data The image data, in rows from the bottom of the image.
+     *
+     * @return The new sprite batch, or NULL if the image does not fit in a page.
+     */
+    SpriteBatch* createSpriteBatch(const char* id, Texture::Format format, unsigned int width, unsigned int height, const unsigned char* data);
+
+    /**
+     * Gets the width and height of the pages.
+     *
+     * @return The page size in pixels.
+     */
+    unsigned int getPageSize() const;
+
+    /**
+     * Gets the number of pages in the atlas.
+     *
+     * @return The page count.
+     */
+    unsigned int getPageCount() const;
+
+    /**
+     * Gets a page of the atlas.
+     *
+     * @param index The index of the page.
+     *
+     * @return The texture of the page.
+     */
+    Texture* getPage(unsigned int index) const;
+
+private:
+
+    /**
+     * The region of a page an image is stored in, without its border.
+     */
+    struct Region
+    {
+        unsigned int page;
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    /**
+     * A segment of the top edge of the packed regions of a page.
+     */
+    struct SkylineNode
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    /**
+     * A page texture, its shared sprite batch and the skyline of its packed regions.
+     */
+    struct Page
+    {
+        Texture* texture;
+        SpriteBatch* batch;
+        std::vector<SkylineNode> skyline;
+    };
+
+    /**
+     * Constructor.
+     */
+    TextureAtlas(unsigned int pageSize, unsigned int maxImageSize);
+
+    /**
+     * Destructor.
+     */
+    ~TextureAtlas();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextureAtlas(const TextureAtlas& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextureAtlas& operator=(const TextureAtlas&);
+
+    /**
+     * Finds the lowest position a block fits at on the skyline of a page, returning false if it does not fit.
+     */
+    bool findPosition(const Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y, size_t* node) const;
+
+    /**
+     * Raises the skyline of a page over a block placed at the given node.
+     */
+    void addSkylineLevel(Page* page, size_t node, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+    /**
+     * Packs a block into the first page it fits in, adding a page if needed.
+     */
+    bool pack(unsigned int width, unsigned int height, unsigned int* page, unsigned int* x, unsigned int* y);
+
+    Page* createPage();
+
+    /**
+     * Creates a sprite batch that draws a region of a page.
+     */
+    SpriteBatch* createSpriteBatch(const Region& region);
+
+    unsigned int _pageSize;
+    unsigned int _maxImageSize;
+    std::vector<Page*> _pages;
+    std::map<std::string, Region> _regions;
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "ThemeStyle.h"
 #include "Game.h"
 #include "FileSystem.h"
+#include "TextureAtlas.h"
 
 namespace gameplay
 {
@@ -10,7 +11,7 @@ namespace gameplay
 static std::vector<Theme*> __themeCache;
 static Theme* __defaultTheme = NULL;
 
-Theme::Theme() : _texture(NULL), _spriteBatch(NULL), _emptyImage(NULL)
+Theme::Theme() : _texture(NULL), _spriteBatch(NULL), _tw(1.0f), _th(1.0f), _emptyImage(NULL)
 {
 }
 
@@ -136,15 +137,29 @@ Theme* Theme::create(const char* url)
     // Parse the Properties object and set up the theme.
     std::string textureFile;
     themeProperties->getPath("texture", &textureFile);
-    theme->_texture = Texture::create(textureFile.c_str(), true);
-    GP_ASSERT(theme->_texture);
-    theme->_spriteBatch = SpriteBatch::create(theme->_texture);
+
+    // Draw from the default texture atlas when the theme image fits in it, so that the
+    // themes and fonts of a form are batched together.
+    unsigned int textureWidth, textureHeight;
+    TextureAtlas* atlas = TextureAtlas::getDefault();
+    if (atlas)
+        theme->_spriteBatch = atlas->createSpriteBatch(textureFile.c_str(), &textureWidth, &textureHeight);
+    if (theme->_spriteBatch == NULL)
+    {
+        theme->_texture = Texture::create(textureFile.c_str(), true);
+        GP_ASSERT(theme->_texture);
+        theme->_spriteBatch = SpriteBatch::create(theme->_texture);
+        textureWidth = theme->_texture->getWidth();
+        textureHeight = theme->_texture->getHeight();
+    }
     GP_ASSERT(theme->_spriteBatch);
     theme->_spriteBatch->getSampler()->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
     theme->_spriteBatch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
 
-    float tw = 1.0f / theme->_texture->getWidth();
-    float th = 1.0f / theme->_texture->getHeight();
+    float tw = 1.0f / textureWidth;
+    float th = 1.0f / textureHeight;
+    theme->_tw = tw;
+    theme->_th = th;
 
     theme->_emptyImage = new Theme::ThemeImage(tw, th, Rectangle::empty(), Vector4::zero());
 
@@ -527,7 +542,7 @@ Theme::Style* Theme::getEmptyStyle()
         Theme::Style::Overlay* overlay = Theme::Style::Overlay::create();
         overlay->addRef();
         overlay->addRef();
-        emptyStyle = new Theme::Style(const_cast<Theme*>(this), "EMPTY_STYLE", 1.0f / _texture->getWidth(), 1.0f / _texture->getHeight(),
+        emptyStyle = new Theme::Style(const_cast<Theme*>(this), "EMPTY_STYLE", _tw, _th,
             Theme::Margin::empty(), Theme::Border::empty(), overlay, overlay, NULL, overlay, NULL);
 
         _styles.push_back(emptyStyle);
@@ -829,89 +829,112 @@ void Transform::getAnimationPropertyValue(int propertyId, AnimationValue* value)
 
 void Transform::setAnimationPropertyValue(int propertyId, AnimationValue* value, float blendWeight)
 {
-    GP_ASSERT(value);
+    setAnimationPropertyValues(1, &propertyId, &value, blendWeight);
+}
+
+void Transform::setAnimationPropertyValues(unsigned int count, const int* propertyIds, AnimationValue* const* values, float blendWeight)
+{
+    GP_ASSERT(count == 0 || (propertyIds && values));
     GP_ASSERT(blendWeight >= 0.0f && blendWeight <= 1.0f);
 
+    if (isStatic())
+        return;
+
+    // Blend every property before marking the transform dirty once.
+    char matrixDirtyBits = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        matrixDirtyBits |= applyAnimationValue(propertyIds[i], values[i], blendWeight, &_scale, &_rotation, &_translation);
+    }
+    if (matrixDirtyBits)
+        dirty(matrixDirtyBits);
+}
+
+char Transform::applyAnimationValue(int propertyId, AnimationValue* value, float blendWeight, Vector3* scale, Quaternion* rotation, Vector3* translation)
+{
+    GP_ASSERT(value);
+    GP_ASSERT(scale && rotation && translation);
+
     switch (propertyId)
     {
         case ANIMATE_SCALE_UNIT:
         {
-            float scale = Curve::lerp(blendWeight, _scale.x, value->getFloat(0));
-            setScale(scale);
-            break;
+            float s = Curve::lerp(blendWeight, scale->x, value->getFloat(0));
+            scale->set(s, s, s);
+            return DIRTY_SCALE;
         }   
         case ANIMATE_SCALE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            break;
+            applyAnimationValueScale(value, 0, blendWeight, scale);
+            return DIRTY_SCALE;
         }
         case ANIMATE_SCALE_X:
         {
-            setScaleX(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)));
-            break;
+            scale->x = Curve::lerp(blendWeight, scale->x, value->getFloat(0));
+            return DIRTY_SCALE;
         }
         case ANIMATE_SCALE_Y:
         {
-            setScaleY(Curve::lerp(blendWeight, _scale.y, value->getFloat(0)));
-            break;
+            scale->y = Curve::lerp(blendWeight, scale->y, value->getFloat(0));
+            return DIRTY_SCALE;
         }
         case ANIMATE_SCALE_Z:
         {
-            setScaleZ(Curve::lerp(blendWeight, _scale.z, value->getFloat(0)));
-            break;
+            scale->z = Curve::lerp(blendWeight, scale->z, value->getFloat(0));
+            return DIRTY_SCALE;
         }
         case ANIMATE_ROTATE:
         {
-            applyAnimationValueRotation(value, 0, blendWeight);
-            break;
+            applyAnimationValueRotation(value, 0, blendWeight, rotation);
+            return DIRTY_ROTATION;
         }
         case ANIMATE_TRANSLATE:
         {
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(0)), Curve::lerp(blendWeight, _translation.y, value->getFloat(1)), Curve::lerp(blendWeight, _translation.z, value->getFloat(2)));
-            break;
+            applyAnimationValueTranslation(value, 0, blendWeight, translation);
+            return DIRTY_TRANSLATION;
         }
         case ANIMATE_TRANSLATE_X:
         {
-            setTranslationX(Curve::lerp(blendWeight, _translation.x, value->getFloat(0)));
-            break;
+            translation->x = Curve::lerp(blendWeight, translation->x, value->getFloat(0));
+            return DIRTY_TRANSLATION;
         }
         case ANIMATE_TRANSLATE_Y:
         {
-            setTranslationY(Curve::lerp(blendWeight, _translation.y, value->getFloat(0)));
-            break;
+            translation->y = Curve::lerp(blendWeight, translation->y, value->getFloat(0));
+            return DIRTY_TRANSLATION;
         }
         case ANIMATE_TRANSLATE_Z:
         {
-            setTranslationZ(Curve::lerp(blendWeight, _translation.z, value->getFloat(0)));
-            break;
+            translation->z = Curve::lerp(blendWeight, translation->z, value->getFloat(0));
+            return DIRTY_TRANSLATION;
         }
         case ANIMATE_ROTATE_TRANSLATE:
         {
-            applyAnimationValueRotation(value, 0, blendWeight);
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(4)), Curve::lerp(blendWeight, _translation.y, value->getFloat(5)), Curve::lerp(blendWeight, _translation.z, value->getFloat(6)));
-            break;
+            applyAnimationValueRotation(value, 0, blendWeight, rotation);
+            applyAnimationValueTranslation(value, 4, blendWeight, translation);
+            return DIRTY_ROTATION | DIRTY_TRANSLATION;
         }
         case ANIMATE_SCALE_ROTATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            applyAnimationValueRotation(value, 3, blendWeight);
-            break;
+            applyAnimationValueScale(value, 0, blendWeight, scale);
+            applyAnimationValueRotation(value, 3, blendWeight, rotation);
+            return DIRTY_SCALE | DIRTY_ROTATION;
         }
         case ANIMATE_SCALE_TRANSLATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(3)), Curve::lerp(blendWeight, _translation.y, value->getFloat(4)), Curve::lerp(blendWeight, _translation.z, value->getFloat(5)));
-            break;
+            applyAnimationValueScale(value, 0, blendWeight, scale);
+            applyAnimationValueTranslation(value, 3, blendWeight, translation);
+            return DIRTY_SCALE | DIRTY_TRANSLATION;
         }
         case ANIMATE_SCALE_ROTATE_TRANSLATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            applyAnimationValueRotation(value, 3, blendWeight);
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(7)), Curve::lerp(blendWeight, _translation.y, value->getFloat(8)), Curve::lerp(blendWeight, _translation.z, value->getFloat(9)));
-            break;
+            applyAnimationValueScale(value, 0, blendWeight, scale);
+            applyAnimationValueRotation(value, 3, blendWeight, rotation);
+            applyAnimationValueTranslation(value, 7, blendWeight, translation);
+            return DIRTY_SCALE | DIRTY_ROTATION | DIRTY_TRANSLATION;
         }
         default:
-            break;
+            return 0;
     }
 }
 
@@ -998,15 +1021,25 @@ void Transform::cloneInto(Transform* transform, NodeCloneContext &context) const
     transform->dirty(DIRTY_TRANSLATION | DIRTY_ROTATION | DIRTY_SCALE);
 }
 
-void Transform::applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight)
+void Transform::applyAnimationValueScale(AnimationValue* value, unsigned int index, float blendWeight, Vector3* scale)
 {
-    if (isStatic())
-        return;
+    GP_ASSERT(value && scale);
+    scale->set(Curve::lerp(blendWeight, scale->x, value->getFloat(index)), Curve::lerp(blendWeight, scale->y, value->getFloat(index + 1)),
+        Curve::lerp(blendWeight, scale->z, value->getFloat(index + 2)));
+}
 
-    GP_ASSERT(value);
-    Quaternion::slerp(_rotation.x, _rotation.y, _rotation.z, _rotation.w, value->getFloat(index), value->getFloat(index + 1), value->getFloat(index + 2), value->getFloat(index + 3), blendWeight, 
-        &_rotation.x, &_rotation.y, &_rotation.z, &_rotation.w);
-    dirty(DIRTY_ROTATION);
+void Transform::applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight, Quaternion* rotation)
+{
+    GP_ASSERT(value && rotation);
+    Quaternion::slerp(rotation->x, rotation->y, rotation->z, rotation->w, value->getFloat(index), value->getFloat(index + 1), value->getFloat(index + 2), value->getFloat(index + 3), blendWeight, 
+        &rotation->x, &rotation->y, &rotation->z, &rotation->w);
+}
+
+void Transform::applyAnimationValueTranslation(AnimationValue* value, unsigned int index, float blendWeight, Vector3* translation)
+{
+    GP_ASSERT(value && translation);
+    translation->set(Curve::lerp(blendWeight, translation->x, value->getFloat(index)), Curve::lerp(blendWeight, translation->y, value->getFloat(index + 1)),
+        Curve::lerp(blendWeight, translation->z, value->getFloat(index + 2)));
 }
 
 }
@@ -30,6 +30,8 @@ class ScriptListener;
  */
 class Transform : public AnimationTarget, public ScriptTarget
 {
+    friend class AnimationBlendTree;
+
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(transformChanged, "<Transform>");
     GP_SCRIPT_EVENTS_END();
@@ -798,6 +800,15 @@ public:
      */
     void setAnimationPropertyValue(int propertyId, AnimationValue* value, float blendWeight = 1.0f);
 
+    /**
+     * Blends all the properties into the scale, rotation and translation before marking
+     * the transform dirty once.
+     *
+     * @see AnimationTarget::setAnimationPropertyValues
+     * @script{ignore}
+     */
+    void setAnimationPropertyValues(unsigned int count, const int* propertyIds, AnimationValue* const* values, float blendWeight = 1.0f);
+
 protected:
 
     /**
@@ -892,7 +903,16 @@ protected:
 
 private:
    
-    void applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight);
+    /**
+     * Blends an animation value into a scale, rotation and translation, returning the dirty bits of the components it changed.
+     */
+    static char applyAnimationValue(int propertyId, AnimationValue* value, float blendWeight, Vector3* scale, Quaternion* rotation, Vector3* translation);
+
+    static void applyAnimationValueScale(AnimationValue* value, unsigned int index, float blendWeight, Vector3* scale);
+
+    static void applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight, Quaternion* rotation);
+
+    static void applyAnimationValueTranslation(AnimationValue* value, unsigned int index, float blendWeight, Vector3* translation);
 
     static int _suspendTransformChanged;
     static std::vector<Transform*> _transformsChanged;
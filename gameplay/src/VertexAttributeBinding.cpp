@@ -10,7 +10,7 @@ static GLuint __maxVertexAttribs = 0;
 static std::vector<VertexAttributeBinding*> __vertexAttributeBindingCache;
 
 VertexAttributeBinding::VertexAttributeBinding() :
-    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL)
+    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL), _instanceBuffer(0)
 {
 }
 
@@ -35,6 +35,11 @@ VertexAttributeBinding::~VertexAttributeBinding()
 }
 
 VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effect)
+{
+    return create(mesh, effect, 0);
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effect, VertexBufferHandle instanceBuffer)
 {
     GP_ASSERT(mesh);
 
@@ -44,7 +49,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
     {
         b = __vertexAttributeBindingCache[i];
         GP_ASSERT(b);
-        if (b->_mesh == mesh && b->_effect == effect)
+        if (b->_mesh == mesh && b->_effect == effect && b->_instanceBuffer == instanceBuffer)
         {
             // Found a match!
             b->addRef();
@@ -52,7 +57,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
         }
     }
 
-    b = create(mesh, mesh->getVertexFormat(), 0, effect);
+    b = create(mesh, mesh->getVertexFormat(), 0, effect, instanceBuffer);
 
     // Add the new vertex attribute binding to the cache.
     if (b)
@@ -65,10 +70,22 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
 
 VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
 {
-    return create(NULL, vertexFormat, vertexPointer, effect);
+    return create(NULL, vertexFormat, vertexPointer, effect, 0);
+}
+
+bool VertexAttributeBinding::isInstancingSupported()
+{
+#if defined(GP_USE_NULL_GL)
+    return true;
+#elif defined(GP_USE_INSTANCING)
+    // The entry points are only loaded when the driver supports GL 3.3 or ARB_instanced_arrays.
+    return glVertexAttribDivisor != NULL && glDrawElementsInstanced != NULL && glDrawArraysInstanced != NULL;
+#else
+    return false;
+#endif
 }
 
-VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, VertexBufferHandle instanceBuffer)
 {
     GP_ASSERT(effect);
 
@@ -125,6 +142,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
             attribs[i].type = GL_FLOAT;
             attribs[i].normalized = GL_FALSE;
             attribs[i].pointer = 0;
+            attribs[i].divisor = 0;
         }
         b->_attributes = attribs;
     }
@@ -204,6 +222,30 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         offset += e.size * sizeof(float);
     }
 
+    // Bind the per-instance world matrix, one column per attribute location.
+    if (instanceBuffer)
+    {
+        GP_ASSERT(isInstancingSupported());
+        b->_instanceBuffer = instanceBuffer;
+
+        gameplay::VertexAttribute attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+        if (attrib == -1)
+        {
+            GP_WARN("Effect '%s' has no '%s' attribute for instanced drawing.", effect->getId(), VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+        }
+        else
+        {
+            if (b->_handle)
+            {
+                GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer) );
+            }
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                b->setVertexAttribPointer(attrib + column, 4, GL_FLOAT, GL_FALSE, (GLsizei)(sizeof(float) * 16), (void*)(sizeof(float) * 4 * column), 1);
+            }
+        }
+    }
+
     if (b->_handle)
     {
         GL_ASSERT( glBindVertexArray(0) );
@@ -212,7 +254,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     return b;
 }
 
-void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer)
+void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, GLuint divisor)
 {
     GP_ASSERT(indx < (GLuint)__maxVertexAttribs);
 
@@ -221,6 +263,12 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         // Hardware mode.
         GL_ASSERT( glVertexAttribPointer(indx, size, type, normalize, stride, pointer) );
         GL_ASSERT( glEnableVertexAttribArray(indx) );
+#ifdef GP_USE_INSTANCING
+        if (divisor)
+        {
+            GL_ASSERT( glVertexAttribDivisor(indx, divisor) );
+        }
+#endif
     }
     else
     {
@@ -232,6 +280,7 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         _attributes[indx].normalized = normalize;
         _attributes[indx].stride = stride;
         _attributes[indx].pointer = pointer;
+        _attributes[indx].divisor = divisor;
     }
 }
 
@@ -258,12 +307,30 @@ void VertexAttributeBinding::bind()
         for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
         {
             VertexAttribute& a = _attributes[i];
-            if (a.enabled)
+            if (a.enabled && a.divisor == 0)
             {
                 GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
                 GL_ASSERT( glEnableVertexAttribArray(i) );
             }
         }
+
+#ifdef GP_USE_INSTANCING
+        // Per-instance attributes are sourced from the instance buffer.
+        if (_instanceBuffer)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+            for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
+            {
+                VertexAttribute& a = _attributes[i];
+                if (a.enabled && a.divisor != 0)
+                {
+                    GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
+                    GL_ASSERT( glVertexAttribDivisor(i, a.divisor) );
+                    GL_ASSERT( glEnableVertexAttribArray(i) );
+                }
+            }
+        }
+#endif
     }
 }
 
@@ -288,6 +355,12 @@ void VertexAttributeBinding::unbind()
             if (_attributes[i].enabled)
             {
                 GL_ASSERT( glDisableVertexAttribArray(i) );
+#ifdef GP_USE_INSTANCING
+                if (_attributes[i].divisor)
+                {
+                    GL_ASSERT( glVertexAttribDivisor(i, 0) );
+                }
+#endif
             }
         }
     }
@@ -68,6 +68,32 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Creates a new VertexAttributeBinding between the given Mesh and Effect that also
+     * sources per-instance world matrices from the given vertex buffer.
+     *
+     * The instance buffer holds one column-major 4x4 float matrix per instance, which is
+     * bound to the 'a_instanceMatrix' attribute of the effect and advances once per instance
+     * rather than once per vertex. Bindings are cached per mesh, effect and instance buffer.
+     *
+     * @param mesh The mesh.
+     * @param effect The effect.
+     * @param instanceBuffer The vertex buffer holding the per-instance matrices.
+     *
+     * @return A VertexAttributeBinding for the requested parameters.
+     * @script{ignore}
+     */
+    static VertexAttributeBinding* create(Mesh* mesh, Effect* effect, VertexBufferHandle instanceBuffer);
+
+    /**
+     * Determines if hardware instancing (instanced draw calls and per-instance
+     * vertex attributes) is supported by the current device.
+     *
+     * @return true if hardware instancing is supported, false otherwise.
+     * @script{ignore}
+     */
+    static bool isInstancingSupported();
+
     /**
      * Binds this vertex array object.
      */
@@ -89,6 +115,7 @@ private:
         bool normalized;
         unsigned int stride;
         void* pointer;
+        unsigned int divisor;
     };
 
     /**
@@ -106,14 +133,15 @@ private:
      */
     VertexAttributeBinding& operator=(const VertexAttributeBinding&);
 
-    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
+    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, VertexBufferHandle instanceBuffer);
 
-    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer);
+    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, GLuint divisor = 0);
 
     GLuint _handle;
     VertexAttribute* _attributes;
     Mesh* _mesh;
     Effect* _effect;
+    VertexBufferHandle _instanceBuffer;
 };
 
 }
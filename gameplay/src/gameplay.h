@@ -44,8 +44,12 @@
 #include "Node.h"
 #include "Joint.h"
 #include "Scene.h"
+#include "SpatialIndex.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
 #include "Font.h"
 #include "SpriteBatch.h"
+#include "TextureAtlas.h"
 #include "Sprite.h"
 #include "Text.h"
 #include "TileSet.h"
@@ -70,6 +74,7 @@
 #include "AnimationValue.h"
 #include "Animation.h"
 #include "AnimationClip.h"
+#include "AnimationBlendTree.h"
 
 // Physics
 #include "PhysicsController.h"
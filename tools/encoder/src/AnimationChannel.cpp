@@ -1,10 +1,76 @@
 #include "Base.h"
 #include "AnimationChannel.h"
 #include "Transform.h"
+#include "EncoderArguments.h"
+
+// Encodings of animation channels
+#define ANIMATION_ENCODING_KEYS         0
+#define ANIMATION_ENCODING_COMPRESSED   1
+
+// Rotation offset of a compressed animation channel without a rotation
+#define ANIMATION_NO_ROTATION           0xFFFFFFFF
+
+// Largest range of a component that is considered constant
+#define ANIMATION_CONSTANT_EPSILON      1.0e-6f
+
+// Largest distance from an evenly spaced time that a normalized key time may have without being written
+#define ANIMATION_TIME_EPSILON          1.0e-6f
+
+// Largest quantized value of a component, and of a component of a rotation without its sign bit
+#define ANIMATION_QUANTIZED_MAX             65535.0f
+#define ANIMATION_QUATERNION_QUANTIZED_MAX  32767.0f
 
 namespace gameplay
 {
 
+/**
+ * Quantizes a unit quaternion to its three smallest components, matching Curve::compress() in the runtime.
+ */
+static void packQuaternion(const float* q, unsigned short* dst)
+{
+    const float sqrt2 = 1.41421356237309504880f;
+
+    float length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    float scale = length > 0.0f ? 1.0f / length : 1.0f;
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        if (fabs(q[i]) > fabs(q[largest]))
+            largest = i;
+    }
+    if (q[largest] < 0.0f)
+        scale = -scale;
+
+    for (unsigned int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float v = (q[i] * scale * sqrt2 * 0.5f + 0.5f) * ANIMATION_QUATERNION_QUANTIZED_MAX + 0.5f;
+        dst[j++] = (unsigned short)std::max(0.0f, std::min(v, ANIMATION_QUATERNION_QUANTIZED_MAX));
+    }
+    dst[0] |= (unsigned short)((largest & 1) << 15);
+    dst[1] |= (unsigned short)((largest >> 1) << 15);
+}
+
+/**
+ * Gets the offset of the rotation in the values of an animated transform property.
+ */
+static unsigned int getRotationOffset(unsigned int attrib)
+{
+    switch (attrib)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        return 0;
+    case Transform::ANIMATE_SCALE_ROTATE:
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        return 3;
+    default:
+        return ANIMATION_NO_ROTATION;
+    }
+}
+
 AnimationChannel::AnimationChannel(void) :
     _targetAttrib(0)
 {
@@ -28,6 +94,13 @@ void AnimationChannel::writeBinary(FILE* file)
     Object::writeBinary(file);
     write(_targetId, file);
     write(_targetAttrib, file);
+    if (EncoderArguments::getInstance()->compressAnimationsEnabled() && isCompressible())
+    {
+        write((unsigned int)ANIMATION_ENCODING_COMPRESSED, file);
+        writeCompressedBinary(file);
+        return;
+    }
+    write((unsigned int)ANIMATION_ENCODING_KEYS, file);
     write((unsigned int)_keytimes.size(), file);
     for (std::vector<float>::const_iterator i = _keytimes.begin(); i != _keytimes.end(); ++i)
     {
@@ -39,6 +112,102 @@ void AnimationChannel::writeBinary(FILE* file)
     write(_interpolations, file);
 }
 
+bool AnimationChannel::isCompressible() const
+{
+    size_t keyCount = _keytimes.size();
+    unsigned int componentCount = Transform::getPropertySize(_targetAttrib);
+    if (keyCount < 2 || componentCount == 0 || _keyValues.size() != keyCount * componentCount)
+        return false;
+    if ((unsigned int)_keytimes[keyCount - 1] <= (unsigned int)_keytimes[0])
+        return false;
+    for (std::vector<unsigned int>::const_iterator i = _interpolations.begin(); i != _interpolations.end(); ++i)
+    {
+        if (*i != LINEAR)
+            return false;
+    }
+    return true;
+}
+
+void AnimationChannel::writeCompressedBinary(FILE* file)
+{
+    unsigned int keyCount = (unsigned int)_keytimes.size();
+    unsigned int componentCount = Transform::getPropertySize(_targetAttrib);
+    unsigned int rotationOffset = getRotationOffset(_targetAttrib);
+
+    // Normalize the key times the same way as the runtime, and only keep them if they are not evenly spaced.
+    unsigned int start = (unsigned int)_keytimes[0];
+    unsigned int duration = (unsigned int)_keytimes[keyCount - 1] - start;
+    std::vector<float> times(keyCount);
+    bool evenlySpaced = true;
+    for (unsigned int i = 0; i < keyCount; ++i)
+    {
+        times[i] = i == keyCount - 1 ? 1.0f : (float)((unsigned int)_keytimes[i] - start) / (float)duration;
+        if (fabs(times[i] - (float)i / (float)(keyCount - 1)) > ANIMATION_TIME_EPSILON)
+            evenlySpaced = false;
+    }
+    if (evenlySpaced)
+        times.clear();
+
+    // Find the range of each component. A rotation is written whole if it is constant,
+    // and is otherwise packed and marked by an extent of one on its first component.
+    std::vector<float> minimums(componentCount);
+    std::vector<float> extents(componentCount);
+    for (unsigned int c = 0; c < componentCount; ++c)
+    {
+        float minimum = _keyValues[c];
+        float maximum = minimum;
+        for (unsigned int i = 1; i < keyCount; ++i)
+        {
+            minimum = std::min(minimum, _keyValues[i * componentCount + c]);
+            maximum = std::max(maximum, _keyValues[i * componentCount + c]);
+        }
+        minimums[c] = minimum;
+        extents[c] = maximum - minimum > ANIMATION_CONSTANT_EPSILON ? maximum - minimum : 0.0f;
+    }
+    bool rotationAnimated = false;
+    if (rotationOffset != ANIMATION_NO_ROTATION)
+    {
+        for (unsigned int c = rotationOffset; c < rotationOffset + 4; ++c)
+        {
+            rotationAnimated |= extents[c] != 0.0f;
+            minimums[c] = _keyValues[c];
+            extents[c] = 0.0f;
+        }
+        extents[rotationOffset] = rotationAnimated ? 1.0f : 0.0f;
+    }
+
+    // Each row holds the packed rotation first, followed by the animated scalar components.
+    std::vector<unsigned short> values;
+    for (unsigned int i = 0; i < keyCount; ++i)
+    {
+        const float* key = &_keyValues[i * componentCount];
+        if (rotationAnimated)
+        {
+            unsigned short packed[3];
+            packQuaternion(key + rotationOffset, packed);
+            values.insert(values.end(), packed, packed + 3);
+        }
+        for (unsigned int c = 0; c < componentCount; ++c)
+        {
+            if (rotationOffset != ANIMATION_NO_ROTATION && c >= rotationOffset && c < rotationOffset + 4)
+                continue;
+            if (extents[c] == 0.0f)
+                continue;
+            float q = (key[c] - minimums[c]) / extents[c] * ANIMATION_QUANTIZED_MAX + 0.5f;
+            values.push_back((unsigned short)std::max(0.0f, std::min(q, ANIMATION_QUANTIZED_MAX)));
+        }
+    }
+
+    write(keyCount, file);
+    write(duration, file);
+    write(componentCount, file);
+    write(rotationOffset, file);
+    write(times, file);
+    write(minimums, file);
+    write(extents, file);
+    write(values, file);
+}
+
 void AnimationChannel::writeText(FILE* file)
 {
     fprintElementStart(file);
@@ -86,6 +86,21 @@ private:
      */
     void deleteRange(size_t begin, size_t end, size_t propSize);
 
+    /**
+     * Returns true if the channel can be written as a compressed curve.
+     * Only linear channels with two or more key frames are compressed.
+     */
+    bool isCompressible() const;
+
+    /**
+     * Writes the key frames as a compressed curve, which quantizes each animated component
+     * to 16 bits over its range, packs rotations into their three smallest components,
+     * stores constant components once and omits the key times if they are evenly spaced.
+     * 
+     * @param file The binary file stream.
+     */
+    void writeCompressedBinary(FILE* file);
+
 private:
 
     std::string _targetId;
@@ -27,6 +27,7 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontFormat(Font::BITMAP),
     _textOutput(false),
     _optimizeAnimations(false),
+    _compressAnimations(false),
     _animationGrouping(ANIMATIONGROUP_PROMPT),
     _outputMaterial(false),
     _generateTextureGutter(false)
@@ -276,6 +277,10 @@ void EncoderArguments::printUsage() const
         "\t\tremoving any channels that contain default/identity values\n" \
         "\t\tand removing any duplicate contiguous keyframes, which are \n" \
         "\t\tcommon when exporting baked animation data.\n" \
+    "  -ca\n" \
+        "\t\tCompresses linear animation channels by quantizing their keys\n" \
+        "\t\tto 16 bits, packing rotations into three components, storing\n" \
+        "\t\tconstant components once and omitting evenly spaced key times.\n" \
     "  -h <size> \"<node ids>\" <filename>\n" \
         "\t\tGenerates a single heightmap image using meshes from the \n" \
         "\t\tspecified nodes. \n" \
@@ -334,6 +339,11 @@ bool EncoderArguments::optimizeAnimationsEnabled() const
     return _optimizeAnimations;
 }
 
+bool EncoderArguments::compressAnimationsEnabled() const
+{
+    return _compressAnimations;
+}
+
 bool EncoderArguments::outputMaterialEnabled() const
 {
     return _outputMaterial;
@@ -416,6 +426,13 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     }
     switch (str[1])
     {
+    case 'c':
+        if (str.compare("-ca") == 0)
+        {
+            // Compress animations
+            _compressAnimations = true;
+        }
+        break;
     case 'f':
         if (str.compare("-f:b") == 0)
         {
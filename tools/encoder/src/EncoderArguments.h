@@ -174,6 +174,8 @@ public:
 
     bool optimizeAnimationsEnabled() const;
 
+    bool compressAnimationsEnabled() const;
+
     bool outputMaterialEnabled() const;
 
     bool generateTextureGutter() const;
@@ -222,6 +224,7 @@ private:
     Font::FontFormat _fontFormat;
     bool _textOutput;
     bool _optimizeAnimations;
+    bool _compressAnimations;
     AnimationGroupOption _animationGrouping;
     bool _outputMaterial;
     bool _generateTextureGutter;